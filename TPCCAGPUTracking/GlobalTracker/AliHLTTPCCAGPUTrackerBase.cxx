@@ -710,6 +710,7 @@ int AliHLTTPCCAGPUTrackerBase::ExitGPU()
 
 int AliHLTTPCCAGPUTrackerBase::Reconstruct_Base_FinishSlices(AliHLTTPCCASliceOutput** pOutput, int& iSlice, int& firstSlice)
 {
+	if (fSlaveTrackers[firstSlice + iSlice].Param().GetDeterministicOutput()) fSlaveTrackers[firstSlice + iSlice].SortTracksDeterministic();
 	fSlaveTrackers[firstSlice + iSlice].CommonMemory()->fNLocalTracks = fSlaveTrackers[firstSlice + iSlice].CommonMemory()->fNTracks;
 	fSlaveTrackers[firstSlice + iSlice].CommonMemory()->fNLocalTrackHits = fSlaveTrackers[firstSlice + iSlice].CommonMemory()->fNTrackHits;
 	if (fUseGlobalTracking) fSlaveTrackers[firstSlice + iSlice].CommonMemory()->fNTracklets = 1;
@@ -0,0 +1,350 @@
+#ifndef OUTPUTTRACKFILE_H
+#define OUTPUTTRACKFILE_H
+
+//Random-access container for the binary track output (output.bin of the standalone, writeBinary option).
+//
+//Layout (all values little endian, 32 bit unless noted):
+//  Header:  char magic[8] = "HLTTRKv1", unsigned int version, unsigned int flags
+//  Blocks:  one per event and slice with tracks (the slice of the first cluster of the track), each
+//           int nTracks, int nClusters, OutputTrack tracks[nTracks], unsigned int clusterIds[nClusters]
+//           The clusters of track i follow those of tracks 0 .. i-1. A block is optionally zlib compressed.
+//           Every block is padded to a multiple of 8 bytes, so that the index and the trailer, which contain
+//           64 bit offsets, are 8 byte aligned in the mapped file.
+//  Index:   OutputTrackFileIndexEntry entries[nEntries], sorted by event and slice
+//  Trailer: OutputTrackFileTrailer, at the very end of the file
+//
+//The reader maps the file into memory, uncompressed blocks are accessed in place without copying.
+//Compression requires HLTCA_BUILD_ZLIB (BUILD_ZLIB = 1 in config_options.mak) and linking with -lz.
+
+#include "outputtrack.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HLTCA_BUILD_ZLIB
+#include <zlib.h>
+#endif
+
+#define OUTPUTTRACKFILE_MAGIC "HLTTRKv1"
+#define OUTPUTTRACKFILE_TRAILER_MAGIC "HLTTRKIX"
+#define OUTPUTTRACKFILE_VERSION 2
+#define OUTPUTTRACKFILE_ALIGNMENT 8
+
+struct OutputTrackFileHeader
+{
+	char fMagic[8];
+	unsigned int fVersion;
+	unsigned int fFlags;
+};
+
+struct OutputTrackFileIndexEntry
+{
+	unsigned long long int fOffset;	//File offset of the block
+	unsigned int fStoredSize;		//Size of the block in the file
+	unsigned int fSize;				//Size of the uncompressed block
+	int fEvent;
+	int fSlice;
+	int fNTracks;
+	unsigned int fCompressed;		//0 = none, 1 = zlib
+};
+
+struct OutputTrackFileTrailer
+{
+	unsigned long long int fIndexOffset;
+	unsigned int fNEntries;
+	unsigned int fNEvents;
+	char fMagic[8];
+};
+
+class OutputTrackFileWriter
+{
+public:
+	OutputTrackFileWriter() : fFile(NULL), fCompress(false), fNEvents(0), fIndex(), fBuffer() {}
+	~OutputTrackFileWriter() {Close();}
+
+	int Open(const char* filename, bool compress = false)
+	{
+#ifndef HLTCA_BUILD_ZLIB
+		if (compress)
+		{
+			printf("Output compression not available, need BUILD_ZLIB\n");
+			return(1);
+		}
+#endif
+		if ((fFile = fopen(filename, "w+b")) == NULL) return(1);
+		fCompress = compress;
+		fNEvents = 0;
+		fIndex.clear();
+		OutputTrackFileHeader header;
+		memcpy(header.fMagic, OUTPUTTRACKFILE_MAGIC, 8);
+		header.fVersion = OUTPUTTRACKFILE_VERSION;
+		header.fFlags = 0;
+		return(fwrite(&header, sizeof(header), 1, fFile) != 1);
+	}
+
+	//Write the tracks of one slice of event NEvents(), slices in ascending order, clusterIds holds the cluster ids of all tracks in track order
+	int WriteBlock(int slice, const OutputTrack* tracks, int nTracks, const unsigned int* clusterIds)
+	{
+		if (fFile == NULL || nTracks == 0) return(0);
+		int nClusters = 0;
+		for (int i = 0;i < nTracks;i++) nClusters += tracks[i].NClusters;
+		const unsigned int size = 2 * sizeof(int) + nTracks * sizeof(OutputTrack) + nClusters * sizeof(unsigned int);
+		fBuffer.resize(size);
+		memcpy(&fBuffer[0], &nTracks, sizeof(int));
+		memcpy(&fBuffer[sizeof(int)], &nClusters, sizeof(int));
+		memcpy(&fBuffer[2 * sizeof(int)], tracks, nTracks * sizeof(OutputTrack));
+		if (nClusters) memcpy(&fBuffer[2 * sizeof(int) + nTracks * sizeof(OutputTrack)], clusterIds, nClusters * sizeof(unsigned int));
+
+		OutputTrackFileIndexEntry entry;
+		entry.fOffset = ftell(fFile);
+		entry.fSize = size;
+		entry.fEvent = fNEvents;
+		entry.fSlice = slice;
+		entry.fNTracks = nTracks;
+		entry.fCompressed = 0;
+		const char* out = &fBuffer[0];
+		unsigned int outSize = size;
+#ifdef HLTCA_BUILD_ZLIB
+		std::vector<char> compressed;
+		if (fCompress)
+		{
+			uLongf compressedSize = compressBound(size);
+			compressed.resize(compressedSize);
+			if (compress2((Bytef*) &compressed[0], &compressedSize, (const Bytef*) &fBuffer[0], size, Z_BEST_SPEED) == Z_OK && compressedSize < size)
+			{
+				out = &compressed[0];
+				outSize = compressedSize;
+				entry.fCompressed = 1;
+			}
+		}
+#endif
+		entry.fStoredSize = outSize;
+		if (fwrite(out, 1, outSize, fFile) != outSize) return(1);
+		if (outSize % OUTPUTTRACKFILE_ALIGNMENT) //Keep all blocks, the index and the trailer 8 byte aligned for the in-place access
+		{
+			const char pad[OUTPUTTRACKFILE_ALIGNMENT] = {};
+			const unsigned int padSize = OUTPUTTRACKFILE_ALIGNMENT - outSize % OUTPUTTRACKFILE_ALIGNMENT;
+			if (fwrite(pad, 1, padSize, fFile) != padSize) return(1);
+		}
+		fIndex.push_back(entry);
+		return(0);
+	}
+
+	void EndEvent() {fNEvents++;}
+	int NEvents() const {return(fNEvents);}
+
+	int Close()
+	{
+		if (fFile == NULL) return(0);
+		OutputTrackFileTrailer trailer;
+		trailer.fIndexOffset = ftell(fFile);
+		trailer.fNEntries = fIndex.size();
+		trailer.fNEvents = fNEvents;
+		memcpy(trailer.fMagic, OUTPUTTRACKFILE_TRAILER_MAGIC, 8);
+		int retVal = 0;
+		if (fIndex.size() && fwrite(&fIndex[0], sizeof(fIndex[0]), fIndex.size(), fFile) != fIndex.size()) retVal = 1;
+		if (fwrite(&trailer, sizeof(trailer), 1, fFile) != 1) retVal = 1;
+		fclose(fFile);
+		fFile = NULL;
+		return(retVal);
+	}
+
+private:
+	OutputTrackFileWriter(const OutputTrackFileWriter&);
+	OutputTrackFileWriter& operator=(const OutputTrackFileWriter&);
+
+	FILE* fFile;
+	bool fCompress;
+	int fNEvents;
+	std::vector<OutputTrackFileIndexEntry> fIndex;
+	std::vector<char> fBuffer;
+};
+
+//Tracks of one block, points into the mapped file or into the decompression buffer
+class OutputTrackBlock
+{
+public:
+	OutputTrackBlock() : fNTracks(0), fTracks(NULL), fClusters(NULL), fFirstCluster(), fBuffer() {}
+
+	int NTracks() const {return(fNTracks);}
+	const OutputTrack& Track(int i) const {return(fTracks[i]);}
+	const unsigned int* TrackClusters(int i) const {return(fClusters + fFirstCluster[i]);}
+
+	struct TrackRef
+	{
+		const OutputTrack& fTrack;
+		const unsigned int* fClusters;
+	};
+	class iterator
+	{
+	public:
+		iterator(const OutputTrackBlock& block, int i) : fBlock(block), fI(i) {}
+		TrackRef operator*() const {TrackRef r = {fBlock.Track(fI), fBlock.TrackClusters(fI)};return(r);}
+		iterator& operator++() {fI++;return(*this);}
+		bool operator!=(const iterator& o) const {return(fI != o.fI);}
+	private:
+		const OutputTrackBlock& fBlock;
+		int fI;
+	};
+	iterator begin() const {return(iterator(*this, 0));}
+	iterator end() const {return(iterator(*this, fNTracks));}
+
+private:
+	OutputTrackBlock(const OutputTrackBlock&); //fTracks and fClusters may point into fBuffer
+	OutputTrackBlock& operator=(const OutputTrackBlock&);
+
+	friend class OutputTrackFileReader;
+	int Set(const char* data, unsigned int size)
+	{
+		if (size < 2 * sizeof(int)) return(1);
+		int nClusters;
+		memcpy(&fNTracks, data, sizeof(int));
+		memcpy(&nClusters, data + sizeof(int), sizeof(int));
+		if (size != 2 * sizeof(int) + fNTracks * sizeof(OutputTrack) + nClusters * sizeof(unsigned int)) return(1);
+		fTracks = (const OutputTrack*) (data + 2 * sizeof(int));
+		fClusters = (const unsigned int*) (data + 2 * sizeof(int) + fNTracks * sizeof(OutputTrack));
+		fFirstCluster.resize(fNTracks);
+		int n = 0;
+		for (int i = 0;i < fNTracks;i++)
+		{
+			fFirstCluster[i] = n;
+			n += fTracks[i].NClusters;
+		}
+		return(n != nClusters);
+	}
+
+	int fNTracks;
+	const OutputTrack* fTracks;
+	const unsigned int* fClusters;
+	std::vector<int> fFirstCluster;
+	std::vector<char> fBuffer;
+};
+
+class OutputTrackFileReader
+{
+public:
+	OutputTrackFileReader() : fData(NULL), fSize(0), fNEvents(0), fNEntries(0), fIndex(NULL) {}
+	~OutputTrackFileReader() {Close();}
+
+	int Open(const char* filename)
+	{
+		Close();
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return(1);
+		struct stat st;
+		if (fstat(fd, &st) || st.st_size < (off_t) (sizeof(OutputTrackFileHeader) + sizeof(OutputTrackFileTrailer)))
+		{
+			close(fd);
+			return(1);
+		}
+		fSize = st.st_size;
+		void* map = mmap(NULL, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (map == MAP_FAILED) return(1);
+		fData = (const char*) map;
+
+		const OutputTrackFileHeader* header = (const OutputTrackFileHeader*) fData;
+		const OutputTrackFileTrailer* trailer = (const OutputTrackFileTrailer*) (fData + fSize - sizeof(OutputTrackFileTrailer));
+		if (fSize % OUTPUTTRACKFILE_ALIGNMENT || memcmp(header->fMagic, OUTPUTTRACKFILE_MAGIC, 8) || header->fVersion != OUTPUTTRACKFILE_VERSION || memcmp(trailer->fMagic, OUTPUTTRACKFILE_TRAILER_MAGIC, 8) ||
+			trailer->fIndexOffset % OUTPUTTRACKFILE_ALIGNMENT ||
+			trailer->fIndexOffset + trailer->fNEntries * sizeof(OutputTrackFileIndexEntry) + sizeof(OutputTrackFileTrailer) != fSize)
+		{
+			printf("Invalid track output file\n");
+			Close();
+			return(1);
+		}
+		fNEvents = trailer->fNEvents;
+		fNEntries = trailer->fNEntries;
+		fIndex = (const OutputTrackFileIndexEntry*) (fData + trailer->fIndexOffset);
+		return(0);
+	}
+
+	void Close()
+	{
+		if (fData) munmap((void*) fData, fSize);
+		fData = NULL;
+		fSize = 0;
+		fNEvents = fNEntries = 0;
+		fIndex = NULL;
+	}
+
+	int NEvents() const {return(fNEvents);}
+	int NBlocks() const {return(fNEntries);}
+	const OutputTrackFileIndexEntry& Block(int i) const {return(fIndex[i]);}
+
+	//Index range [first, last) of the blocks of an event
+	void EventBlocks(int event, int& first, int& last) const
+	{
+		first = LowerBound(event, -1);
+		last = LowerBound(event + 1, -1);
+	}
+
+	//Number of tracks of an event, without touching the track data
+	int EventNTracks(int event) const
+	{
+		int first, last, n = 0;
+		EventBlocks(event, first, last);
+		for (int i = first;i < last;i++) n += fIndex[i].fNTracks;
+		return(n);
+	}
+
+	//Load block i, returns 1 on error
+	int GetBlock(int i, OutputTrackBlock& block) const
+	{
+		const OutputTrackFileIndexEntry& entry = fIndex[i];
+		if (entry.fOffset + entry.fStoredSize > fSize) return(1);
+		const char* data = fData + entry.fOffset;
+		if (entry.fCompressed)
+		{
+#ifdef HLTCA_BUILD_ZLIB
+			block.fBuffer.resize(entry.fSize);
+			uLongf size = entry.fSize;
+			if (uncompress((Bytef*) &block.fBuffer[0], &size, (const Bytef*) data, entry.fStoredSize) != Z_OK || size != entry.fSize) return(1);
+			data = &block.fBuffer[0];
+#else
+			printf("Compressed track output requires BUILD_ZLIB\n");
+			return(1);
+#endif
+		}
+		return(block.Set(data, entry.fSize));
+	}
+
+	//Load the block of one event and slice, an empty block if the slice has no tracks
+	int GetBlock(int event, int slice, OutputTrackBlock& block) const
+	{
+		const int i = LowerBound(event, slice);
+		if (i == (int) fNEntries || fIndex[i].fEvent != event || fIndex[i].fSlice != slice)
+		{
+			block.fNTracks = 0;
+			return(0);
+		}
+		return(GetBlock(i, block));
+	}
+
+private:
+	OutputTrackFileReader(const OutputTrackFileReader&);
+	OutputTrackFileReader& operator=(const OutputTrackFileReader&);
+
+	int LowerBound(int event, int slice) const
+	{
+		int l = 0, r = fNEntries;
+		while (l < r)
+		{
+			const int m = (l + r) / 2;
+			if (fIndex[m].fEvent < event || (fIndex[m].fEvent == event && fIndex[m].fSlice < slice)) l = m + 1;
+			else r = m;
+		}
+		return(l);
+	}
+
+	const char* fData;
+	size_t fSize;
+	unsigned int fNEvents;
+	unsigned int fNEntries;
+	const OutputTrackFileIndexEntry* fIndex;
+};
+
+#endif
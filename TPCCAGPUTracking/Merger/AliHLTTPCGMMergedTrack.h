@@ -35,6 +35,10 @@ class AliHLTTPCGMMergedTrack
   GPUd() bool OK()                               const { return fOK;              }
   GPUd() char CSide()                            const { return fCSide;           }
   GPUd() bool Looper()                           const { return fLooper;          }
+  GPUd() int LooperLeader()                      const { return fLooperLeader;    }
+  GPUd() unsigned char FitTermination()          const { return fFitTermination;  }
+  GPUd() const AliHLTTPCGMMergedTrackdEdx& dEdxInfo() const { return fdEdxInfo; }
+  GPUd() AliHLTTPCGMMergedTrackdEdx& dEdxInfo()        { return fdEdxInfo;       }
 
   GPUd() void SetNClusters      ( int v )                { fNClusters = v;       }
   GPUd() void SetNClustersFitted( int v )                { fNClustersFitted = v; }
@@ -46,6 +50,8 @@ class AliHLTTPCGMMergedTrack
   GPUd() void SetLastZ( float v )                        { fLastZ = v; }
   GPUd() void SetOK( bool v ) {fOK = v;}
   GPUd() void SetLooper( bool v ) {fLooper = v;}
+  GPUd() void SetLooperLeader( int v ) {fLooperLeader = v;}
+  GPUd() void SetFitTermination( unsigned char v ) {fFitTermination = v;}
   GPUd() void SetCSide( char v ) {fCSide = v;}
   
   GPUd() const AliHLTTPCGMTrackParam::AliHLTTPCCAOuterParam& OuterParam() const {return fOuterParam;}
@@ -55,6 +61,7 @@ class AliHLTTPCGMMergedTrack
 
   AliHLTTPCGMTrackParam fParam; //* fitted track parameters 
   AliHLTTPCGMTrackParam::AliHLTTPCCAOuterParam fOuterParam; //* outer param
+  AliHLTTPCGMMergedTrackdEdx fdEdxInfo; //* truncated mean dE/dx, filled by the refit if enabled
 
   float fAlpha;                 //* alpha angle 
   float fLastX; //* outer X
@@ -63,9 +70,11 @@ class AliHLTTPCGMMergedTrack
   int fFirstClusterRef;         //* index of the first track cluster in corresponding cluster arrays
   int fNClusters;               //* number of track clusters
   int fNClustersFitted;         //* number of clusters used in fit
+  int fLooperLeader;            //* for redundant looper legs: index of the merged track of the leg that is kept, -1 otherwise
   bool fOK;
   bool fLooper;
   char fCSide;
+  unsigned char fFitTermination; //* why the refit ended, AliHLTTPCGMTrackParam::FitTermination
 };
 
 #endif 
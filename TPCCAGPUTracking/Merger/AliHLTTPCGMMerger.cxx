@@ -38,6 +38,7 @@
 
 #include "AliHLTTPCGMTrackParam.h"
 #include "AliHLTTPCGMSliceTrack.h"
+#include "AliHLTTPCGMSliceTrackBatch.h"
 #include "AliHLTTPCGMBorderTrack.h"
 #include <cmath>
 
@@ -84,6 +85,10 @@ AliHLTTPCGMMerger::AliHLTTPCGMMerger()
   fGPUTracker(NULL),
   fSliceTrackers(NULL),
   fDebugLevel(0),
+  fResidualCollector(NULL),
+#ifdef HLTCA_STANDALONE
+  fRefitPerfCounters(),
+#endif
   fNClusters(0)
 {
   //* constructor
@@ -98,6 +103,7 @@ AliHLTTPCGMMerger::AliHLTTPCGMMerger()
   fPrevSliceInd[ 0 ] = mid;
   fNextSliceInd[ last ] = fgkNSlices / 2;
   fPrevSliceInd[ fgkNSlices/2 ] = last;
+  for (int i = 0;i < AliHLTTPCGMTrackParam::kNFitTerminations;i++) fNFitTerminations[i] = 0;
 
   fField.Reset(); // set very wrong initial value in order to see if the field was not properly initialised    
   
@@ -177,12 +183,17 @@ bool AliHLTTPCGMMerger::Reconstruct(bool resetTimers)
   int nIter = 1;
 #ifdef HLTCA_STANDALONE
   HighResTimer timer;
-  static double times[8] = {};
+  static double times[9] = {};
   static int nCount = 0;
+  PerfCounters counter;
+  static PerfCounters counters[9];
+  static double nClusters = 0;
   if (resetTimers || !HLTCA_TIMING_SUM)
   {
     for (unsigned int k = 0;k < sizeof(times) / sizeof(times[0]);k++) times[k] = 0;
+    for (unsigned int k = 0;k < sizeof(counters) / sizeof(counters[0]);k++) counters[k].Reset();
     nCount = 0;
+    nClusters = 0;
   }
 #endif
   //cout<<"Merger..."<<endl;
@@ -190,40 +201,57 @@ bool AliHLTTPCGMMerger::Reconstruct(bool resetTimers)
     if( !AllocateMemory() ) return false;
 #ifdef HLTCA_STANDALONE
     timer.ResetStart();
+    counter.Start();
 #endif
     UnpackSlices();
 #ifdef HLTCA_STANDALONE
     times[0] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[0]);
 #endif
     MergeWithingSlices();
 #ifdef HLTCA_STANDALONE
     times[1] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[1]);
 #endif
     MergeSlices();
 #ifdef HLTCA_STANDALONE
     times[2] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[2]);
 #endif
     MergeCEInit();
 #ifdef HLTCA_STANDALONE
     times[3] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[3]);
 #endif
     CollectMergedTracks();
 #ifdef HLTCA_STANDALONE
     times[4] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[4]);
 #endif
     MergeCE();
 #ifdef HLTCA_STANDALONE
     times[3] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[3]);
 #endif
-    PrepareClustersForFit();
+    MergeLoopers();
 #ifdef HLTCA_STANDALONE
     times[5] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[5]);
 #endif
-    Refit(resetTimers);
+    PrepareClustersForFit();
 #ifdef HLTCA_STANDALONE
     times[6] += timer.GetCurrentElapsedTime(true);
-    Finalize();
+    counter.AddCurrentTo(counters[6]);
+#endif
+    Refit(resetTimers);
+#ifdef HLTCA_STANDALONE
     times[7] += timer.GetCurrentElapsedTime(true);
+    counter.Reset();
+    counters[7].Add(fRefitPerfCounters);
+    counter.Start();
+    Finalize();
+    times[8] += timer.GetCurrentElapsedTime(true);
+    counter.AddCurrentTo(counters[8], false);
     nCount++;
     if (fDebugLevel > 0)
     {
@@ -232,9 +260,18 @@ bool AliHLTTPCGMMerger::Reconstruct(bool resetTimers)
       printf("\t\tMerge Slices:\t%1.0f us\n", times[2] * 1000000 / nCount);
       printf("\t\tMerge CE:\t%1.0f us\n", times[3] * 1000000 / nCount);
       printf("\t\tCollect:\t%1.0f us\n", times[4] * 1000000 / nCount);
-      printf("\t\tClusters:\t%1.0f us\n", times[5] * 1000000 / nCount);
-      printf("\t\tRefit:\t\t%1.0f us\n", times[6] * 1000000 / nCount);
-      printf("\t\tFinalize:\t%1.0f us\n", times[7] * 1000000 / nCount);
+      printf("\t\tMerge Loopers:\t%1.0f us\n", times[5] * 1000000 / nCount);
+      printf("\t\tClusters:\t%1.0f us\n", times[6] * 1000000 / nCount);
+      printf("\t\tRefit:\t\t%1.0f us\n", times[7] * 1000000 / nCount);
+      printf("\t\t\tcompleted %d, skipped %d, too few clusters %d, bad numerics %d, aborted (rejected clusters) %d, aborted (chi2/NDF) %d\n", fNFitTerminations[AliHLTTPCGMTrackParam::kFitCompleted], fNFitTerminations[AliHLTTPCGMTrackParam::kFitSkipped],
+        fNFitTerminations[AliHLTTPCGMTrackParam::kFitTooFewClusters], fNFitTerminations[AliHLTTPCGMTrackParam::kFitBadNumerics], fNFitTerminations[AliHLTTPCGMTrackParam::kFitAbortRejected], fNFitTerminations[AliHLTTPCGMTrackParam::kFitAbortChi2NDF]);
+      printf("\t\tFinalize:\t%1.0f us\n", times[8] * 1000000 / nCount);
+    }
+    nClusters += fNClusters;
+    if (PerfCounters::IsEnabled())
+    {
+      const char* stepNames[9] = {"Unpack Slices", "Merge Within", "Merge Slices", "Merge CE", "Collect", "Merge Loopers", "Clusters", "Refit", "Finalize"};
+      for (int k = 0;k < 9;k++) counters[k].Print(stepNames[k], nClusters);
     }
 #endif
   }  
@@ -319,6 +356,15 @@ void AliHLTTPCGMMerger::UnpackSlices()
   int* TrackIds = new int[maxSliceTracks * fgkNSlices];
   for (int i = 0;i < maxSliceTracks * fgkNSlices;i++) TrackIds[i] = -1;
 
+  //The local tracks are filtered in batches of AliHLTTPCGMSliceTrackBatch::kLanes tracks, which are set up behind the last accepted track,
+  //and the accepted ones are moved down afterwards. The scalar path uses batches of one track.
+  const bool scalar = fSliceParam.GetMergerScalarSliceTracks();
+  AliHLTTPCGMSliceTrackBatch batch;
+  AliHLTTPCGMSliceTrack* batchTracks[AliHLTTPCGMSliceTrackBatch::kLanes];
+  int batchItr[AliHLTTPCGMSliceTrackBatch::kLanes];
+  bool batchOk[AliHLTTPCGMSliceTrackBatch::kLanes];
+  int nBatch = 0;
+
   for ( int iSlice = 0; iSlice < fgkNSlices; iSlice++ ) {
 
     fSliceTrackInfoIndex[iSlice] = nTracksCurrent;
@@ -328,18 +374,37 @@ void AliHLTTPCGMMerger::UnpackSlices()
     const AliHLTTPCCASliceOutTrack *sliceTr = slice.GetFirstTrack();    
     
     for ( int itr = 0; itr < slice.NLocalTracks(); itr++, sliceTr = sliceTr->GetNextTrack() ) {
-      AliHLTTPCGMSliceTrack &track = fSliceTrackInfos[nTracksCurrent];
+      AliHLTTPCGMSliceTrack &track = fSliceTrackInfos[nTracksCurrent + nBatch];
       track.Set( sliceTr, alpha, iSlice );
-      if( !track.FilterErrors( fSliceParam, HLTCA_MAX_SIN_PHI, 0.1f ) ) continue;
-      if (DEBUG) printf("INPUT Slice %d, Track %d, QPt %f DzDs %f\n", iSlice, itr, track.QPt(), track.DzDs());
-      track.SetPrevNeighbour( -1 );
-      track.SetNextNeighbour( -1 );
-      track.SetNextSegmentNeighbour( -1 );
-      track.SetPrevSegmentNeighbour( -1 );
-      track.SetGlobalTrackId(0, -1);
-      track.SetGlobalTrackId(1, -1);
-      TrackIds[iSlice * maxSliceTracks + sliceTr->LocalTrackId()] = nTracksCurrent;
-      nTracksCurrent++;
+      batchTracks[nBatch] = &track;
+      batchItr[nBatch++] = itr;
+      if (scalar)
+      {
+        batchOk[0] = track.FilterErrors( fSliceParam, HLTCA_MAX_SIN_PHI, 0.1f );
+      }
+      else
+      {
+        if (nBatch < AliHLTTPCGMSliceTrackBatch::kLanes && itr + 1 < slice.NLocalTracks()) continue;
+        batch.Load( batchTracks, nBatch );
+        batch.FilterErrors( fSliceParam, HLTCA_MAX_SIN_PHI, 0.1f, batchOk );
+        batch.Store( batchTracks );
+      }
+      for (int j = 0;j < nBatch;j++)
+      {
+        if (!batchOk[j]) continue;
+        AliHLTTPCGMSliceTrack &trk = fSliceTrackInfos[nTracksCurrent];
+        if (&trk != batchTracks[j]) trk = *batchTracks[j];
+        if (DEBUG) printf("INPUT Slice %d, Track %d, QPt %f DzDs %f\n", iSlice, batchItr[j], trk.QPt(), trk.DzDs());
+        trk.SetPrevNeighbour( -1 );
+        trk.SetNextNeighbour( -1 );
+        trk.SetNextSegmentNeighbour( -1 );
+        trk.SetPrevSegmentNeighbour( -1 );
+        trk.SetGlobalTrackId(0, -1);
+        trk.SetGlobalTrackId(1, -1);
+        TrackIds[iSlice * maxSliceTracks + trk.OrigTrack()->LocalTrackId()] = nTracksCurrent;
+        nTracksCurrent++;
+      }
+      nBatch = 0;
     }
     firstGlobalTracks[iSlice] = sliceTr;
   }
@@ -400,7 +465,13 @@ void AliHLTTPCGMMerger::MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBo
   float cosAlpha = AliHLTTPCCAMath::Cos( dAlpha );
   float sinAlpha = AliHLTTPCCAMath::Sin( dAlpha );
 
-  AliHLTTPCGMSliceTrack trackTmp;
+  const bool scalar = fSliceParam.GetMergerScalarSliceTracks();
+  AliHLTTPCGMSliceTrackBatch batch;
+  const AliHLTTPCGMSliceTrack* batchTracks[AliHLTTPCGMSliceTrackBatch::kLanes];
+  int batchIds[AliHLTTPCGMSliceTrackBatch::kLanes];
+  int nBatch = 0;
+
+  AliHLTTPCGMSliceTrack trackTmp[AliHLTTPCGMSliceTrackBatch::kLanes];
   for ( int itr = SliceTrackInfoFirst(iSlice); itr < SliceTrackInfoLast(iSlice); itr++ ) {
 
     const AliHLTTPCGMSliceTrack *track = &fSliceTrackInfos[itr];
@@ -415,9 +486,9 @@ void AliHLTTPCGMMerger::MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBo
             track = &fSliceTrackInfos[track->NextSegmentNeighbour()];
             if (track->OrigTrack()->Param().X() < trackMin->OrigTrack()->Param().X()) trackMin = track;
         }
-        trackTmp = *trackMin;
-        track = &trackTmp;
-        trackTmp.Set(trackMin->OrigTrack(), trackMin->Alpha(), trackMin->Slice());
+        trackTmp[nBatch] = *trackMin;
+        track = &trackTmp[nBatch];
+        trackTmp[nBatch].Set(trackMin->OrigTrack(), trackMin->Alpha(), trackMin->Slice());
     }
     else
     {
@@ -427,6 +498,18 @@ void AliHLTTPCGMMerger::MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBo
             if (iBorder == 1 && track->PrevNeighbour() >= 0) continue;
         }
     }
+    if (!scalar)
+    {
+      batchTracks[nBatch] = track;
+      batchIds[nBatch++] = itr;
+      if (nBatch == AliHLTTPCGMSliceTrackBatch::kLanes)
+      {
+        MakeBorderTracksBatch( batch, batchTracks, batchIds, nBatch, x0, sinAlpha, cosAlpha, maxSin, B, nB );
+        nBatch = 0;
+      }
+      continue;
+    }
+
     AliHLTTPCGMBorderTrack &b = B[nB];
 
     if(  track->TransportToXAlpha( x0, sinAlpha, cosAlpha, fieldBz, b, maxSin)){
@@ -437,6 +520,24 @@ void AliHLTTPCGMMerger::MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBo
       nB++; 
     }
   }
+  if (nBatch) MakeBorderTracksBatch( batch, batchTracks, batchIds, nBatch, x0, sinAlpha, cosAlpha, maxSin, B, nB );
+}
+
+void AliHLTTPCGMMerger::MakeBorderTracksBatch( AliHLTTPCGMSliceTrackBatch &batch, const AliHLTTPCGMSliceTrack* const* tracks, const int* ids, int n, float x0, float sinAlpha, float cosAlpha, float maxSin, AliHLTTPCGMBorderTrack B[], int &nB )
+{
+  //* batched transport of MakeBorderTracks, the border tracks are appended to B in the same order as by the scalar path
+  int lane[AliHLTTPCGMSliceTrackBatch::kLanes];
+  batch.Load( tracks, n );
+  const int nOk = batch.TransportToXAlpha( x0, sinAlpha, cosAlpha, fSliceParam.ConstBz(), B + nB, lane, maxSin );
+  for (int j = 0;j < nOk;j++)
+  {
+    AliHLTTPCGMBorderTrack &b = B[nB + j];
+    b.SetTrackID( ids[lane[j]] );
+    b.SetNClusters( tracks[lane[j]]->NClusters() );
+    for (int i = 0;i < 4;i++) if (fabs(b.Cov()[i]) >= 5.0) b.SetCov(i, 5.0);
+    if (fabs(b.Cov()[4]) >= 0.5) b.SetCov(4, 0.5);
+  }
+  nB += nOk;
 }
 
 void AliHLTTPCGMMerger::MergeBorderTracks ( int iSlice1, AliHLTTPCGMBorderTrack B1[], int N1, int iSlice2, AliHLTTPCGMBorderTrack B2[], int N2, int crossCE )
@@ -548,10 +649,29 @@ void AliHLTTPCGMMerger::MergeWithingSlices()
   float x0 = fSliceParam.RowX( 63 );  
   const float maxSin = CAMath::Sin( 60. / 180.*CAMath::Pi() );
 
+  const bool scalar = fSliceParam.GetMergerScalarSliceTracks();
+  AliHLTTPCGMSliceTrackBatch batch;
+  const AliHLTTPCGMSliceTrack* batchTracks[AliHLTTPCGMSliceTrackBatch::kLanes];
+  int lane[AliHLTTPCGMSliceTrackBatch::kLanes];
+
   ClearTrackLinks(SliceTrackInfoLocalTotal());
   for ( int iSlice = 0; iSlice < fgkNSlices; iSlice++ ) {
     int nBord = 0;
-    for ( int itr = SliceTrackInfoFirst(iSlice); itr < SliceTrackInfoLast(iSlice); itr++ ) {
+    for ( int itr = SliceTrackInfoFirst(iSlice); !scalar && itr < SliceTrackInfoLast(iSlice); itr += AliHLTTPCGMSliceTrackBatch::kLanes ) {
+      const int n = CAMath::Min(SliceTrackInfoLast(iSlice) - itr, (int) AliHLTTPCGMSliceTrackBatch::kLanes);
+      for (int j = 0;j < n;j++) batchTracks[j] = &fSliceTrackInfos[itr + j];
+      batch.Load( batchTracks, n );
+      const int nOk = batch.TransportToX( x0, fSliceParam.ConstBz(), &fBorder[iSlice][nBord], lane, maxSin );
+      for (int j = 0;j < nOk;j++)
+      {
+        AliHLTTPCGMBorderTrack &b = fBorder[iSlice][nBord + j];
+        b.SetTrackID( itr + lane[j] );
+        if (DEBUG) {printf("WITHIN SLICE %d Track %d - ", iSlice, itr + lane[j]);for (int i = 0;i < 5;i++) {printf("%8.3f ", b.Par()[i]);} printf(" - ");for (int i = 0;i < 5;i++) {printf("%8.3f ", b.Cov()[i]);} printf("\n");}
+        b.SetNClusters( batchTracks[lane[j]]->NClusters() );
+      }
+      nBord += nOk;
+    }
+    for ( int itr = SliceTrackInfoFirst(iSlice); scalar && itr < SliceTrackInfoLast(iSlice); itr++ ) {
       AliHLTTPCGMSliceTrack &track = fSliceTrackInfos[itr];
       
       AliHLTTPCGMBorderTrack &b = fBorder[iSlice][nBord];
@@ -871,6 +991,151 @@ void AliHLTTPCGMMerger::MergeCE()
     //for (int i = 0;i < fNOutputTracks;i++) {if (fOutputTracks[i].NeighborTrack() == -1) {fOutputTracks[i].SetNClusters(0);fOutputTracks[i].SetOK(false);}} //Remove all non-CE tracks
 }
 
+struct AliHLTTPCGMMerger_LooperLeg
+{
+  float fXc, fYc;    // helix center, global coordinates
+  float fR;          // helix radius
+  float fZRef;       // z of the helix at phase 0 around the center
+  float fPitch;      // z advance per turn
+  float fAbsDzDs;
+  int fTrack;        // merged track index
+  int fBin;          // (phi, z) hash bin
+};
+
+void AliHLTTPCGMMerger::MergeLoopers()
+{
+  //* Link the legs of low-pt loopers, which are otherwise reconstructed and refitted as independent merged tracks.
+  //* All legs of a looper lie on the same helix: same center and radius in the bending plane, same dz/ds,
+  //* and the same z at a fixed phase around the center modulo the pitch 2*pi*R*|dz/ds|.
+  //* Legs are hashed by the azimuth of the helix center and the reference z, compatible legs are grouped,
+  //* the leg with most clusters is kept and the others are marked redundant and skipped by the refit.
+  if (!fSliceParam.GetMergeLoopers()) return;
+
+  const float kCenterTol = 0.05f, kCenterTolAbs = 1.f;    // relative to R, cm
+  const float kDzDsTol = 0.05f;
+  const float kZTol = 0.05f, kZTolAbs = 2.f;              // relative to pitch, cm
+  const int kNPhiBins = 64, kNZBins = 30;
+  const float kZBinMin = -300.f, kZBinSize = 600.f / kNZBins;
+  const float kPi = CAMath::Pi();
+  const float bz = fSliceParam.ConstBz();
+
+  AliHLTTPCGMMerger_LooperLeg* legs = new AliHLTTPCGMMerger_LooperLeg[fNOutputTracks];
+  int nLegs = 0;
+  for (int itr = 0;itr < fNOutputTracks;itr++)
+  {
+    const AliHLTTPCGMMergedTrack &trk = fOutputTracks[itr];
+    if (!trk.OK() || trk.NClusters() == 0) continue;
+    const AliHLTTPCGMTrackParam &p = trk.GetParam();
+    if (fabs(p.GetQPt()) < MERGE_LOOPER_QPT_LIMIT) continue;
+    const float k = -p.GetQPt() * bz;
+    if (fabs(k) < 1e-6f) continue;
+
+    const float cA = CAMath::Cos(trk.GetAlpha()), sA = CAMath::Sin(trk.GetAlpha());
+    const float cosPhi = CAMath::Sqrt(1.f - p.GetSinPhi() * p.GetSinPhi());
+    const float x = p.GetX() * cA - p.GetY() * sA;
+    const float y = p.GetX() * sA + p.GetY() * cA;
+    const float ex = cosPhi * cA - p.GetSinPhi() * sA;
+    const float ey = cosPhi * sA + p.GetSinPhi() * cA;
+
+    AliHLTTPCGMMerger_LooperLeg &l = legs[nLegs];
+    l.fXc = x - ey / k;
+    l.fYc = y + ex / k;
+    l.fR = 1.f / fabs(k);
+    const float phase = CAMath::ATan2(y - l.fYc, x - l.fXc);
+    l.fZRef = p.GetZ() - phase * l.fR * p.GetDzDs() * (k > 0 ? 1.f : -1.f); // dz / dphase is invariant under reversing the leg direction
+    l.fAbsDzDs = fabs(p.GetDzDs());
+    l.fPitch = 2.f * kPi * l.fR * l.fAbsDzDs;
+    l.fTrack = itr;
+    int phiBin = (int) ((CAMath::ATan2(l.fYc, l.fXc) + kPi) / (2.f * kPi) * kNPhiBins);
+    int zBin = (int) ((l.fZRef - kZBinMin) / kZBinSize);
+    phiBin = CAMath::Max(0, CAMath::Min(kNPhiBins - 1, phiBin));
+    zBin = CAMath::Max(0, CAMath::Min(kNZBins - 1, zBin));
+    l.fBin = phiBin * kNZBins + zBin;
+    nLegs++;
+  }
+
+  if (nLegs > 1)
+  {
+    // Counting sort of the legs by hash bin
+    int* binStart = new int[kNPhiBins * kNZBins + 1];
+    int* sorted = new int[nLegs];
+    for (int i = 0;i <= kNPhiBins * kNZBins;i++) binStart[i] = 0;
+    for (int i = 0;i < nLegs;i++) binStart[legs[i].fBin + 1]++;
+    for (int i = 0;i < kNPhiBins * kNZBins;i++) binStart[i + 1] += binStart[i];
+    for (int i = 0;i < nLegs;i++) sorted[binStart[legs[i].fBin]++] = i;
+    for (int i = kNPhiBins * kNZBins;i > 0;i--) binStart[i] = binStart[i - 1];
+    binStart[0] = 0;
+
+    // Group compatible legs (union-find)
+    int* group = new int[nLegs];
+    for (int i = 0;i < nLegs;i++) group[i] = i;
+    for (int i = 0;i < nLegs;i++)
+    {
+      const AliHLTTPCGMMerger_LooperLeg &a = legs[i];
+      const int phiBin = a.fBin / kNZBins;
+      const float dzMax = MERGE_LOOPER_MAX_TURNS * a.fPitch + kZTolAbs;
+      const int zBinMin = CAMath::Max(0, (int) ((a.fZRef - dzMax - kZBinMin) / kZBinSize));
+      const int zBinMax = CAMath::Min(kNZBins - 1, (int) ((a.fZRef + dzMax - kZBinMin) / kZBinSize));
+      for (int dPhi = -1;dPhi <= 1;dPhi++)
+      {
+        const int iPhi = (phiBin + dPhi + kNPhiBins) % kNPhiBins;
+        for (int iZ = zBinMin;iZ <= zBinMax;iZ++)
+        {
+          const int bin = iPhi * kNZBins + iZ;
+          for (int jj = binStart[bin];jj < binStart[bin + 1];jj++)
+          {
+            const int j = sorted[jj];
+            if (j <= i) continue;
+            const AliHLTTPCGMMerger_LooperLeg &b = legs[j];
+            if (fOutputTracks[a.fTrack].CSide() != fOutputTracks[b.fTrack].CSide()) continue;
+            const float centerTol = kCenterTol * a.fR + kCenterTolAbs;
+            if (fabs(a.fR - b.fR) > centerTol) continue;
+            if ((a.fXc - b.fXc) * (a.fXc - b.fXc) + (a.fYc - b.fYc) * (a.fYc - b.fYc) > centerTol * centerTol) continue;
+            if (fabs(a.fAbsDzDs - b.fAbsDzDs) > kDzDsTol * CAMath::Max(a.fAbsDzDs, b.fAbsDzDs) + 0.01f) continue;
+            const float pitch = 0.5f * (a.fPitch + b.fPitch);
+            const float dz = b.fZRef - a.fZRef;
+            const float nTurns = pitch > 1e-3f ? (float) CAMath::Nint(dz / pitch) : 0.f;
+            if (fabs(nTurns) > MERGE_LOOPER_MAX_TURNS) continue;
+            if (fabs(dz - nTurns * pitch) > kZTol * pitch + kZTolAbs) continue;
+
+            int ga = i, gb = j;
+            while (group[ga] != ga) ga = group[ga];
+            while (group[gb] != gb) gb = group[gb];
+            if (ga != gb) group[CAMath::Max(ga, gb)] = CAMath::Min(ga, gb);
+          }
+        }
+      }
+    }
+
+    // Keep the leg with most clusters of every group
+    int* leader = new int[nLegs];
+    for (int i = 0;i < nLegs;i++) leader[i] = -1;
+    for (int i = 0;i < nLegs;i++)
+    {
+      int g = i;
+      while (group[g] != g) g = group[g];
+      group[i] = g;
+      if (leader[g] == -1 || fOutputTracks[legs[i].fTrack].NClusters() > fOutputTracks[legs[leader[g]].fTrack].NClusters()) leader[g] = i;
+    }
+    for (int i = 0;i < nLegs;i++)
+    {
+      const int l = leader[group[i]];
+      if (l == i) continue;
+      AliHLTTPCGMMergedTrack &trk = fOutputTracks[legs[i].fTrack];
+      trk.SetLooper(true);
+      trk.SetLooperLeader(legs[l].fTrack);
+      trk.SetOK(false);
+      fOutputTracks[legs[l].fTrack].SetLooper(true);
+    }
+
+    delete[] leader;
+    delete[] group;
+    delete[] sorted;
+    delete[] binStart;
+  }
+  delete[] legs;
+}
+
 struct AliHLTTPCGMMerger_CompareClusterIdsLooper
 {
   struct clcomparestruct {int i; float q;};
@@ -909,6 +1174,19 @@ struct AliHLTTPCGMMerger_CompareClusterIds
   }
 };
 
+struct AliHLTTPCGMMerger_CompareClusterIdsDeterministic
+{
+  const AliHLTTPCCASliceOutCluster* const fCmp;
+  AliHLTTPCGMMerger_CompareClusterIdsDeterministic(const AliHLTTPCCASliceOutCluster* cmp) : fCmp(cmp) {}
+  bool operator()(const int aa, const int bb)
+  {
+      const AliHLTTPCCASliceOutCluster& a = fCmp[aa];
+      const AliHLTTPCCASliceOutCluster& b = fCmp[bb];
+      if (a.GetX() != b.GetX()) return(a.GetX() > b.GetX());
+      return(a.GetId() < b.GetId());
+  }
+};
+
 struct AliHLTTPCGMMerger_CompareTracks
 {
   const AliHLTTPCGMMergedTrack* const fCmp;
@@ -921,11 +1199,31 @@ struct AliHLTTPCGMMerger_CompareTracks
   }
 };
 
+struct AliHLTTPCGMMerger_CompareTracksDeterministic
+{
+  const AliHLTTPCGMMergedTrack* const fCmp;
+  AliHLTTPCGMMerger_CompareTracksDeterministic(AliHLTTPCGMMergedTrack* cmp) : fCmp(cmp) {}
+  bool operator()(const int aa, const int bb)
+  {
+    const AliHLTTPCGMMergedTrack& a = fCmp[aa];
+    const AliHLTTPCGMMergedTrack& b = fCmp[bb];
+    if (fabs(a.GetParam().GetQPt()) != fabs(b.GetParam().GetQPt())) return(fabs(a.GetParam().GetQPt()) > fabs(b.GetParam().GetQPt()));
+    return(aa < bb);
+  }
+};
+
 bool AliHLTTPCGMMerger_CompareParts(const AliHLTTPCGMSliceTrack* a, const AliHLTTPCGMSliceTrack* b)
 {
   return(a->X() > b->X());
 }
 
+bool AliHLTTPCGMMerger_ComparePartsDeterministic(const AliHLTTPCGMSliceTrack* a, const AliHLTTPCGMSliceTrack* b)
+{
+  //Parts point into fSliceTrackInfos, which is filled in slice output order
+  if (a->X() != b->X()) return(a->X() > b->X());
+  return(a < b);
+}
+
 void AliHLTTPCGMMerger::CollectMergedTracks()
 {
   //Resolve connections for global tracks first
@@ -990,7 +1288,8 @@ void AliHLTTPCGMMerger::CollectMergedTracks()
       
       if (nParts > 1 && !looper)
       {
-        std::sort(trackParts, trackParts + nParts, AliHLTTPCGMMerger_CompareParts);
+        if (fSliceParam.GetDeterministicOutput()) std::sort(trackParts, trackParts + nParts, AliHLTTPCGMMerger_ComparePartsDeterministic);
+        else std::sort(trackParts, trackParts + nParts, AliHLTTPCGMMerger_CompareParts);
       }
       
       AliHLTTPCCASliceOutCluster trackClusters[kMaxClusters];
@@ -1077,7 +1376,8 @@ void AliHLTTPCGMMerger::CollectMergedTracks()
         }
         else
         {
-            std::sort(clusterIndices, clusterIndices + nHits, AliHLTTPCGMMerger_CompareClusterIds(trackClusters));
+            if (fSliceParam.GetDeterministicOutput()) std::sort(clusterIndices, clusterIndices + nHits, AliHLTTPCGMMerger_CompareClusterIdsDeterministic(trackClusters));
+            else std::sort(clusterIndices, clusterIndices + nHits, AliHLTTPCGMMerger_CompareClusterIds(trackClusters));
         }
         nTmpHits = 0;
         firstTrackIndex = lastTrackIndex = -1;
@@ -1132,6 +1432,9 @@ void AliHLTTPCGMMerger::CollectMergedTracks()
       AliHLTTPCGMMergedTrack &mergedTrack = fOutputTracks[fNOutputTracks];
       mergedTrack.SetOK(1);
       mergedTrack.SetLooper(looper);
+      mergedTrack.SetLooperLeader(-1);
+      mergedTrack.dEdxInfo().fdEdxIROC = mergedTrack.dEdxInfo().fdEdxOROC = 0.f;
+      mergedTrack.dEdxInfo().fNClsIROC = mergedTrack.dEdxInfo().fNClsOROC = 0;
       mergedTrack.SetNClusters( nHits );
       mergedTrack.SetFirstClusterRef( nOutTrackClusters );
       AliHLTTPCGMTrackParam &p1 = mergedTrack.Param();
@@ -1205,7 +1508,8 @@ void AliHLTTPCGMMerger::PrepareClustersForFit()
   fClusterAttachment = new int[maxId];
   fMaxID = maxId;
   for (int i = 0;i < fNOutputTracks;i++) trackSort[i] = i;
-  std::sort(trackSort, trackSort + fNOutputTracks, AliHLTTPCGMMerger_CompareTracks(fOutputTracks));
+  if (fSliceParam.GetDeterministicOutput()) std::sort(trackSort, trackSort + fNOutputTracks, AliHLTTPCGMMerger_CompareTracksDeterministic(fOutputTracks));
+  else std::sort(trackSort, trackSort + fNOutputTracks, AliHLTTPCGMMerger_CompareTracks(fOutputTracks));
   memset(fClusterAttachment, 0, maxId * sizeof(fClusterAttachment[0]));
   for (int i = 0;i < fNOutputTracks;i++) fTrackOrder[trackSort[i]] = i;
   for (int i = 0;i < fNOutputTrackClusters;i++) fClusterAttachment[fClusters[i].fNum] = attachAttached | attachGood;
@@ -1236,7 +1540,12 @@ void AliHLTTPCGMMerger::Refit(bool resetTimers)
 #endif
   {
 #ifdef HLTCA_STANDALONE
-#pragma omp parallel for
+    fRefitPerfCounters.Reset();
+#pragma omp parallel
+    {
+      unsigned long long countersStart[PerfCounters::kNCounters], countersEnd[PerfCounters::kNCounters];
+      PerfCounters::Read(countersStart);
+#pragma omp for nowait
 #endif
     for ( int itr = 0; itr < fNOutputTracks; itr++ )
     {
@@ -1245,7 +1554,14 @@ void AliHLTTPCGMMerger::Refit(bool resetTimers)
       gOfflineFitter.RefitTrack(fOutputTracks[itr], &fField, fClusters);
 #endif
     }
+#ifdef HLTCA_STANDALONE
+      PerfCounters::Read(countersEnd); //Without the wait at the end of the loop, only the work of each thread is counted
+      fRefitPerfCounters.Add(countersStart, countersEnd);
+    }
+#endif
   }
+  for (int i = 0;i < AliHLTTPCGMTrackParam::kNFitTerminations;i++) fNFitTerminations[i] = 0;
+  for (int itr = 0;itr < fNOutputTracks;itr++) fNFitTerminations[fOutputTracks[itr].FitTermination()]++;
 }
 
 void AliHLTTPCGMMerger::Finalize()
@@ -17,6 +17,9 @@
 #include "AliHLTTPCGMPolynomialField.h"
 #include "AliHLTTPCGMMergedTrack.h"
 #include "AliTPCCommonDef.h"
+#ifdef HLTCA_STANDALONE
+#include "../cmodules/perfcounter.h"
+#endif
 
 #if !defined(HLTCA_GPUCODE)
 #include <iostream>
@@ -28,6 +31,8 @@ class AliHLTTPCCASliceOutput;
 class AliHLTTPCGMCluster;
 class AliHLTTPCGMTrackParam;
 class AliHLTTPCCATracker;
+class AliHLTTPCGMResidualCollector;
+class AliHLTTPCGMSliceTrackBatch;
 
 /**
  * @class AliHLTTPCGMMerger
@@ -54,6 +59,8 @@ public:
 
   void SetGPUTracker(AliHLTTPCCAGPUTracker* gpu) {fGPUTracker = gpu;}
   void SetDebugLevel(int debug) {fDebugLevel = debug;}
+  void SetResidualCollector(AliHLTTPCGMResidualCollector* c) {fResidualCollector = c;}
+  GPUhd() AliHLTTPCGMResidualCollector* ResidualCollector() const {return fResidualCollector;}
 
   GPUd() const AliHLTTPCGMPolynomialField& Field() const {return fField;}
   GPUhd() const AliHLTTPCGMPolynomialField* pField() const {return &fField;}
@@ -68,6 +75,7 @@ public:
   int* ClusterAttachment() const {return(fClusterAttachment);}
   int MaxId() const {return(fMaxID);}
   unsigned int* TrackOrder() const {return(fTrackOrder);}
+  const int* NFitTerminations() const {return(fNFitTerminations);} //Number of tracks per AliHLTTPCGMTrackParam::FitTermination in the last refit
   
   enum attachTypes {attachAttached = 0x40000000, attachGood = 0x20000000, attachGoodLeg = 0x10000000, attachTube = 0x08000000, attachTrackMask = 0x07FFFFFF, attachFlagMask = 0xF8000000};
 
@@ -76,6 +84,7 @@ private:
   const AliHLTTPCGMMerger &operator=( const AliHLTTPCGMMerger& ) const CON_DELETE;
 
   void MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBorderTrack B[], int &nB, bool fromOrig = false );
+  void MakeBorderTracksBatch( AliHLTTPCGMSliceTrackBatch &batch, const AliHLTTPCGMSliceTrack* const* tracks, const int* ids, int n, float x0, float sinAlpha, float cosAlpha, float maxSin, AliHLTTPCGMBorderTrack B[], int &nB );
 
   void MergeBorderTracks( int iSlice1, AliHLTTPCGMBorderTrack B1[], int N1, int iSlice2, AliHLTTPCGMBorderTrack B2[], int N2, int crossCE = 0 );
 
@@ -85,6 +94,7 @@ private:
   void MergeCEInit();
   void MergeCEFill(const AliHLTTPCGMSliceTrack* track, const AliHLTTPCGMMergedTrackHit& cls, int itr);
   void MergeCE();
+  void MergeLoopers();
   void MergeWithingSlices();
   void MergeSlices();
   void ResolveMergeSlices(bool fromOrig, bool mergeAll);
@@ -136,8 +146,13 @@ private:
   AliHLTTPCCAGPUTracker* fGPUTracker;
   AliHLTTPCCATracker* fSliceTrackers;
   int fDebugLevel;
+  AliHLTTPCGMResidualCollector* fResidualCollector; //Collects the cluster residuals of the refit if set, host only
+#ifdef HLTCA_STANDALONE
+  PerfCounters fRefitPerfCounters; //Hardware counters of the CPU refit, summed over the threads
+#endif
 
   int fNClusters;			//Total number of incoming clusters
+  int fNFitTerminations[AliHLTTPCGMTrackParam::kNFitTerminations]; //Number of tracks per termination reason of the last refit
 };
 
 #endif //ALIHLTTPCGMMERGER_H
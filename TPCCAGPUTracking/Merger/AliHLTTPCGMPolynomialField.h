@@ -36,6 +36,8 @@ public:
 
   GPUd() float GetFieldBz( float x, float y, float z ) const;
 
+  void GetField( double x, double y, double z, double B[3] ) const; // evaluation in double precision, host only
+
   void Print() const;
 
   static const int fkM = 10; // number of coefficients
@@ -103,4 +105,18 @@ GPUd() inline float AliHLTTPCGMPolynomialField::GetFieldBz( float x, float y, fl
   return bz;
 }
 
+inline void AliHLTTPCGMPolynomialField::GetField( double x, double y, double z, double B[3] ) const
+{
+  const double f[fkM] = { 1., x, y, z, x*x, x*y, x*z, y*y, y*z, z*z };
+  double bx = 0., by = 0., bz = 0.;
+  for( int i=0; i<fkM; i++){
+    bx += fBx[i]*f[i];
+    by += fBy[i]*f[i];
+    bz += fBz[i]*f[i];
+  }
+  B[0] = bx;
+  B[1] = by;
+  B[2] = bz;
+}
+
 #endif 
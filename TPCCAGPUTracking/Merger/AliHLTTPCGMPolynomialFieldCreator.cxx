@@ -139,6 +139,201 @@ int AliHLTTPCGMPolynomialFieldCreator::GetPolynomialField( float nominalFieldkG,
 
 
 
+#if !defined(HLTCA_GPUCODE)
+
+#include <cstdio>
+#include <vector>
+
+int AliHLTTPCGMPolynomialFieldCreator::FitFieldMap( int nPoints, const float *xyz, const float *B, float nominalFieldkG, AliHLTTPCGMPolynomialField &field, float *residuals )
+{
+  //
+  // Fit the TPC region of a tabulated field map with the polynoms, without AliRoot
+  //
+  // the normal equations are accumulated per thread and summed up afterwards,
+  // the points outside of the TPC drift volume are skipped
+  //
+  // returns -1 if there are no points in the TPC region, -2 if the fit fails
+  //
+
+  const double kCLight = 0.000299792458;
+  const double kAlmost0Field = 1.e-13;
+  const int M = AliHLTTPCGMPolynomialField::fkM;
+
+  // TPC region, see AliHLTTPCCAStandaloneFramework::SetSettings()
+  const double rMin = 83.65;
+  const double rMax = 247.7/cos(10./180.*acos(-1.));
+  const double zMax = 249.778;
+
+  field.Reset();
+
+  if( !xyz || !B || nPoints<=0 ) return -1;
+
+  double solenoidBzkGInv = (fabs(nominalFieldkG) > kAlmost0Field ) ?1./nominalFieldkG :0. ;
+
+  double A[M][M], b[3][M];
+  for( int i=0; i<M; i++ ){
+    for( int j=0; j<M; j++ ) A[i][j] = 0.;
+    b[0][i] = b[1][i] = b[2][i] = 0.;
+  }
+  int nUsed = 0;
+
+#pragma omp parallel
+  {
+    double threadA[M][M], threadB[3][M];
+    for( int i=0; i<M; i++ ){
+      for( int j=0; j<M; j++ ) threadA[i][j] = 0.;
+      threadB[0][i] = threadB[1][i] = threadB[2][i] = 0.;
+    }
+    int threadUsed = 0;
+
+#pragma omp for
+    for( int ip=0; ip<nPoints; ip++ ){
+      const float *p = xyz + 3*ip;
+      double r = sqrt( p[0]*p[0] + p[1]*p[1] );
+      if( r<rMin || r>rMax || fabs(p[2])>zMax ) continue;
+      float f[M];
+      AliHLTTPCGMPolynomialField::GetPolynoms( p[0], p[1], p[2], f );
+      for( int i=0; i<M; i++ ){
+	for( int j=i; j<M; j++ ) threadA[i][j] += f[i]*f[j];
+	for( int k=0; k<3; k++ ) threadB[k][i] += f[i]*B[3*ip+k]*solenoidBzkGInv;
+      }
+      threadUsed++;
+    }
+
+#pragma omp critical
+    {
+      for( int i=0; i<M; i++ ){
+	for( int j=i; j<M; j++ ) A[i][j] += threadA[i][j];
+	for( int k=0; k<3; k++ ) b[k][i] += threadB[k][i];
+      }
+      nUsed += threadUsed;
+    }
+  }
+
+  if( nUsed < M ) return -1;
+
+  // solve the normal equations with the Cholesky decomposition A = L*L^T, L is stored in the lower triangle
+
+  for( int i=0; i<M; i++ ){
+    for( int j=0; j<i; j++ ) A[i][j] = A[j][i];
+  }
+  for( int j=0; j<M; j++ ){
+    double d = A[j][j];
+    for( int k=0; k<j; k++ ) d -= A[j][k]*A[j][k];
+    if( !(d > 0.) ) return -2;
+    d = sqrt(d);
+    A[j][j] = d;
+    for( int i=j+1; i<M; i++ ){
+      double s = A[i][j];
+      for( int k=0; k<j; k++ ) s -= A[i][k]*A[j][k];
+      A[i][j] = s/d;
+    }
+  }
+
+  float c[3][M];
+  for( int k=0; k<3; k++ ){
+    double y[M];
+    for( int i=0; i<M; i++ ){
+      double s = b[k][i];
+      for( int j=0; j<i; j++ ) s -= A[i][j]*y[j];
+      y[i] = s/A[i][i];
+    }
+    for( int i=M-1; i>=0; i-- ){
+      double s = y[i];
+      for( int j=i+1; j<M; j++ ) s -= A[j][i]*y[j];
+      y[i] = s/A[i][i];
+    }
+    for( int i=0; i<M; i++ ) c[k][i] = y[i];
+  }
+
+  // check quality
+
+  if( residuals ){
+    AliHLTTPCGMPolynomialField fittedField;
+    fittedField.Set( 1., c[0], c[1], c[2] );
+    double maxD[3] = {0.,0.,0.}, sumD2[3] = {0.,0.,0.};
+
+#pragma omp parallel
+    {
+      double threadMax[3] = {0.,0.,0.}, threadSum[3] = {0.,0.,0.};
+#pragma omp for
+      for( int ip=0; ip<nPoints; ip++ ){
+	const float *p = xyz + 3*ip;
+	double r = sqrt( p[0]*p[0] + p[1]*p[1] );
+	if( r<rMin || r>rMax || fabs(p[2])>zMax ) continue;
+	float approxB[3];
+	fittedField.GetField( p[0], p[1], p[2], approxB );
+	for( int k=0; k<3; k++ ){
+	  double d = fabs( approxB[k] - B[3*ip+k]*solenoidBzkGInv );
+	  if( d > threadMax[k] ) threadMax[k] = d;
+	  threadSum[k] += d*d;
+	}
+      }
+#pragma omp critical
+      {
+	for( int k=0; k<3; k++ ){
+	  if( threadMax[k] > maxD[k] ) maxD[k] = threadMax[k];
+	  sumD2[k] += threadSum[k];
+	}
+      }
+    }
+    for( int k=0; k<3; k++ ){
+      residuals[k] = maxD[k];
+      residuals[3+k] = sqrt( sumD2[k]/nUsed );
+    }
+  }
+
+  // scale result
+
+  double nominalBz = nominalFieldkG * kCLight;
+  for( int k=0; k<3; k++ ){
+    for( int i=0; i<M; i++ ) c[k][i] = nominalBz * c[k][i];
+  }
+  field.Set( nominalBz, c[0], c[1], c[2] );
+
+  return 0;
+}
+
+
+int AliHLTTPCGMPolynomialFieldCreator::FitFieldMap( const char *fileName, AliHLTTPCGMPolynomialField &field, float *residuals )
+{
+  //
+  // Read a tabulated field map from a binary file and fit it
+  // returns -3 if the file can not be read
+  //
+
+  field.Reset();
+
+  FILE *fp = fopen( fileName, "rb" );
+  if( !fp ) return -3;
+
+  int nPoints = 0;
+  float nominalFieldkG = 0.f;
+  if( fread( &nPoints, sizeof(int), 1, fp ) != 1 || fread( &nominalFieldkG, sizeof(float), 1, fp ) != 1 || nPoints <= 0 ){
+    fclose( fp );
+    return -3;
+  }
+
+  std::vector<float> buf( 6*(size_t)nPoints );
+  size_t nRead = fread( &buf[0], sizeof(float), buf.size(), fp );
+  fclose( fp );
+  if( nRead != buf.size() ) return -3;
+
+  std::vector<float> xyz( 3*(size_t)nPoints ), B( 3*(size_t)nPoints );
+  for( int ip=0; ip<nPoints; ip++ ){
+    for( int k=0; k<3; k++ ){
+      xyz[3*ip+k] = buf[6*ip+k];
+      B[3*ip+k] = buf[6*ip+3+k];
+    }
+  }
+
+  return FitFieldMap( nPoints, &xyz[0], &B[0], nominalFieldkG, field, residuals );
+}
+
+#endif
+
+
+
 
 /******************************************************************************************
  *
@@ -46,6 +46,21 @@ public:
   /* Get pre-calculated polynomial field of type "type", scaled with respect to nominalFieldkG
    */
   static int GetPolynomialField( StoredField_t type, float nominalFieldkG, AliHLTTPCGMPolynomialField &field );
+
+#if !defined(HLTCA_GPUCODE)
+
+  /* Fit the field of the TPC region from a tabulated field map, AliRoot is not needed
+   * nPoints points: xyz[3*i] = (x,y,z) [cm], B[3*i] = (Bx,By,Bz) [kG], nominalFieldkG is the solenoid field
+   * When residuals!=0, it is filled with max|dBx|,max|dBy|,max|dBz|,rms(dBx),rms(dBy),rms(dBz) relative to the nominal field
+   */
+  static int FitFieldMap( int nPoints, const float *xyz, const float *B, float nominalFieldkG, AliHLTTPCGMPolynomialField &field, float *residuals = 0 );
+
+  /* Same as above, the field map is read from a plain binary file:
+   * int nPoints, float nominalFieldkG, then nPoints x { float x, y, z, Bx, By, Bz }
+   */
+  static int FitFieldMap( const char *fileName, AliHLTTPCGMPolynomialField &field, float *residuals = 0 );
+
+#endif
  };
 
 #endif
@@ -88,6 +88,7 @@ public:
   
   GPUd() AliHLTTPCGMPhysicalTrackModel& Model() {return fT0;}
   GPUd() void CalculateMaterialCorrection();
+  GPUd() const MaterialCorrection& GetMaterialCorrection() const {return fMaterial;}
   GPUd() void SetStatErrorCurCluster(AliHLTTPCGMMergedTrackHit* c) {fStatErrors.SetCurCluster(c);}
 
 private:
@@ -0,0 +1,409 @@
+// **************************************************************************
+// This file is property of and copyright by the ALICE HLT Project          *
+// ALICE Experiment at CERN, All rights reserved.                           *
+//                                                                          *
+// Permission to use, copy, modify and distribute this software and its     *
+// documentation strictly for non-commercial purposes is hereby granted     *
+// without fee, provided that the above copyright notice appears in all     *
+// copies and that both the copyright notice and this permission notice     *
+// appear in the supporting documentation. The authors make no claims       *
+// about the suitability of this software for any purpose. It is            *
+// provided "as is" without express or implied warranty.                    *
+//                                                                          *
+//***************************************************************************
+
+#include "AliHLTTPCGMReferenceFitter.h"
+#include "AliHLTTPCGMMerger.h"
+#include "AliHLTTPCGMMergedTrack.h"
+#include "AliHLTTPCGMMergedTrackHit.h"
+#include "AliHLTTPCGMPropagator.h"
+#include "AliHLTTPCGMPolynomialField.h"
+#include "AliHLTTPCGMTrackParam.h"
+#include "AliHLTTPCCAParam.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  const float kRho = 1.025e-3f;   // material of AliHLTTPCGMTrackParam::Fit
+  const float kRadLen = 29.532f;
+  const double kMaxSinPhi = HLTCA_MAX_SIN_PHI;
+  const double kMaxStep = 1.;     // max step in X of the Runge-Kutta integration [cm]
+  const int kMinHits = 10;        // min number of (merged) clusters to refit a track
+
+  struct Hit
+  {
+    double fX, fY, fZ;
+    float fAlpha;
+    int fRow;
+    unsigned char fState;
+    const AliHLTTPCGMMergedTrackHit *fCluster; // first cluster, for the statistical errors
+  };
+
+  struct State
+  {
+    double fX, fAlpha;
+    double fP[5];    // Y, Z, SinPhi, DzDs, QPt
+    double fC[5][5]; // full covariance matrix
+  };
+
+  // d(Y, Z, Ux, Uy, Uz, path) / dX for the direction U and q/p in the local frame (cosA, sinA), false if the track does not move along X
+  bool Derivatives( const AliHLTTPCGMPolynomialField &field, double cosA, double sinA, double qp, double x, const double *s, double *d )
+  {
+    const double ux = s[2], uy = s[3], uz = s[4];
+    if ( ux <= 0. ) return false;
+    double bg[3];
+    field.GetField( x * cosA - s[0] * sinA, x * sinA + s[0] * cosA, s[1], bg );
+    const double bx = bg[0] * cosA + bg[1] * sinA, by = -bg[0] * sinA + bg[1] * cosA, bz = bg[2];
+    const double uxi = 1. / ux;
+    d[0] = uy * uxi;
+    d[1] = uz * uxi;
+    d[2] = qp * ( uy * bz - uz * by ) * uxi;
+    d[3] = qp * ( uz * bx - ux * bz ) * uxi;
+    d[4] = qp * ( ux * by - uy * bx ) * uxi;
+    d[5] = sqrt( ux * ux + uy * uy + uz * uz ) * uxi;
+    return true;
+  }
+
+  // Transports the parameters par at x in the frame alpha to x1 in the frame alpha1, path is the length of the trajectory.
+  // The trajectory is integrated for the direction and q/p, which is smooth also for straight tracks and q/Pt changing sign during the fit
+  bool Transport( const AliHLTTPCGMPolynomialField &field, double x, double alpha, const double *par, double x1, double alpha1, double *par1, double &path )
+  {
+    if ( fabs( par[2] ) >= kMaxSinPhi ) return false;
+    const double ut = 1. / sqrt( 1. + par[3] * par[3] ); // Pt / P
+    const double qp = par[4] * ut;
+    const double ux = ut * sqrt( ( 1. - par[2] ) * ( 1. + par[2] ) ), uy = ut * par[2];
+
+    // rotate position and direction to the frame alpha1
+    const double cs = cos( alpha1 - alpha ), sn = sin( alpha1 - alpha );
+    const double x0 = x * cs + par[0] * sn;
+    double s[6] = { -x * sn + par[0] * cs, par[1], ux * cs + uy * sn, -ux * sn + uy * cs, ut * par[3], 0. };
+
+    // 4th order Runge-Kutta in X
+    const double cosA = cos( alpha1 ), sinA = sin( alpha1 );
+    const int nSteps = 1 + (int) ( fabs( x1 - x0 ) / kMaxStep );
+    const double h = ( x1 - x0 ) / nSteps;
+    for ( int i = 0; i < nSteps; i++ ) {
+      const double xx = x0 + i * h;
+      double k1[6], k2[6], k3[6], k4[6], t[6];
+      if ( !Derivatives( field, cosA, sinA, qp, xx, s, k1 ) ) return false;
+      for ( int j = 0; j < 6; j++ ) t[j] = s[j] + 0.5 * h * k1[j];
+      if ( !Derivatives( field, cosA, sinA, qp, xx + 0.5 * h, t, k2 ) ) return false;
+      for ( int j = 0; j < 6; j++ ) t[j] = s[j] + 0.5 * h * k2[j];
+      if ( !Derivatives( field, cosA, sinA, qp, xx + 0.5 * h, t, k3 ) ) return false;
+      for ( int j = 0; j < 6; j++ ) t[j] = s[j] + h * k3[j];
+      if ( !Derivatives( field, cosA, sinA, qp, xx + h, t, k4 ) ) return false;
+      for ( int j = 0; j < 6; j++ ) s[j] += h / 6. * ( k1[j] + 2. * k2[j] + 2. * k3[j] + k4[j] );
+    }
+    if ( s[2] <= 0. ) return false;
+
+    const double ut1 = sqrt( s[2] * s[2] + s[3] * s[3] );
+    const double u1 = sqrt( s[2] * s[2] + s[3] * s[3] + s[4] * s[4] ); // 1 up to the integration error
+    par1[0] = s[0];
+    par1[1] = s[1];
+    par1[2] = s[3] / ut1;
+    par1[3] = s[4] / ut1;
+    par1[4] = qp * u1 / ut1;
+    path = fabs( s[5] );
+    return fabs( par1[2] ) < kMaxSinPhi;
+  }
+
+  // Transports the state including the covariance, the Jacobian is obtained by central differences
+  bool TransportState( const AliHLTTPCGMPolynomialField &field, State &st, double x1, double alpha1, double &path )
+  {
+    double par1[5];
+    if ( !Transport( field, st.fX, st.fAlpha, st.fP, x1, alpha1, par1, path ) ) return false;
+
+    const double eps[5] = { 1.e-4, 1.e-4, 1.e-6, 1.e-6, 1.e-6 * ( 1. + fabs( st.fP[4] ) ) };
+    double j[5][5];
+    for ( int k = 0; k < 5; k++ ) {
+      double parP[5], parM[5], outP[5], outM[5], dummy;
+      for ( int i = 0; i < 5; i++ ) parP[i] = parM[i] = st.fP[i];
+      parP[k] += eps[k];
+      parM[k] -= eps[k];
+      if ( !Transport( field, st.fX, st.fAlpha, parP, x1, alpha1, outP, dummy ) || !Transport( field, st.fX, st.fAlpha, parM, x1, alpha1, outM, dummy ) ) return false;
+      for ( int i = 0; i < 5; i++ ) j[i][k] = ( outP[i] - outM[i] ) / ( 2. * eps[k] );
+    }
+
+    double jc[5][5];
+    for ( int i = 0; i < 5; i++ ) {
+      for ( int k = 0; k < 5; k++ ) {
+        jc[i][k] = 0.;
+        for ( int l = 0; l < 5; l++ ) jc[i][k] += j[i][l] * st.fC[l][k];
+      }
+    }
+    for ( int i = 0; i < 5; i++ ) {
+      for ( int k = 0; k <= i; k++ ) {
+        double c = 0.;
+        for ( int l = 0; l < 5; l++ ) c += jc[i][l] * j[k][l];
+        st.fC[i][k] = st.fC[k][i] = c;
+      }
+    }
+
+    st.fX = x1;
+    st.fAlpha = alpha1;
+    for ( int i = 0; i < 5; i++ ) st.fP[i] = par1[i];
+    return true;
+  }
+
+  // Sets the propagator to the current state, such that the material correction and the cluster errors are computed for it
+  void SetPropagatorTrack( AliHLTTPCGMPropagator &prop, AliHLTTPCGMTrackParam &t, const State &st )
+  {
+    t.SetX( st.fX );
+    for ( int i = 0; i < 5; i++ ) t.SetPar( i, st.fP[i] );
+    prop.SetTrack( &t, st.fAlpha );
+  }
+
+  // Energy loss and multiple scattering on the path dL (negative in flight direction), same model as AliHLTTPCGMPropagator::PropagateToXAlpha
+  void MaterialCorrection( const AliHLTTPCGMPropagator &prop, State &st, double dL, bool toyMC )
+  {
+    const AliHLTTPCGMPropagator::MaterialCorrection &m = prop.GetMaterialCorrection();
+    const double dLmask = fabs( dL ) < m.fDLMax ? dL : 0.;
+    const double dLabs = fabs( dLmask );
+    const double corr = 1. - m.fEP2 * dLmask;
+
+    st.fP[4] *= corr;
+    for ( int i = 0; i < 4; i++ ) st.fC[4][i] = st.fC[i][4] = st.fC[i][4] * corr;
+    st.fC[4][4] = st.fC[4][4] * corr * corr + dLabs * m.fSigmadE2;
+
+    if ( !toyMC ) {
+      st.fC[2][2] += dLabs * m.fK22 * ( 1. - st.fP[2] * st.fP[2] );
+      st.fC[3][3] += dLabs * m.fK33;
+      st.fC[4][3] = st.fC[3][4] = st.fC[3][4] + dLabs * m.fK43;
+      st.fC[4][4] += dLabs * m.fK44;
+    }
+  }
+
+  // Kalman filter update with the full 2D measurement, returns false if the matrix cannot be inverted
+  bool Update( State &st, double y, double z, double err2Y, double err2Z, double &chi2 )
+  {
+    const double s00 = st.fC[0][0] + err2Y, s01 = st.fC[0][1], s11 = st.fC[1][1] + err2Z;
+    const double det = s00 * s11 - s01 * s01;
+    if ( !( det > 0. ) ) return false;
+    const double w00 = s11 / det, w01 = -s01 / det, w11 = s00 / det;
+    const double r0 = y - st.fP[0], r1 = z - st.fP[1];
+    chi2 += r0 * ( w00 * r0 + w01 * r1 ) + r1 * ( w01 * r0 + w11 * r1 );
+
+    double c0[5], c1[5], k0[5], k1[5];
+    for ( int i = 0; i < 5; i++ ) {
+      c0[i] = st.fC[0][i];
+      c1[i] = st.fC[1][i];
+      k0[i] = c0[i] * w00 + c1[i] * w01;
+      k1[i] = c0[i] * w01 + c1[i] * w11;
+    }
+    for ( int i = 0; i < 5; i++ ) {
+      st.fP[i] += k0[i] * r0 + k1[i] * r1;
+      for ( int k = 0; k <= i; k++ ) st.fC[i][k] = st.fC[k][i] = st.fC[i][k] - k0[i] * c0[k] - k1[i] * c1[k];
+    }
+    return true;
+  }
+}
+
+AliHLTTPCGMReferenceFitter::AliHLTTPCGMReferenceFitter() : fThreadStatistics()
+{
+#ifdef _OPENMP
+  fThreadStatistics.resize( omp_get_max_threads() );
+#else
+  fThreadStatistics.resize( 1 );
+#endif
+  Reset();
+}
+
+void AliHLTTPCGMReferenceFitter::Reset()
+{
+  for ( unsigned int i = 0; i < fThreadStatistics.size(); i++ ) memset( &fThreadStatistics[i], 0, sizeof( Statistics ) );
+}
+
+int AliHLTTPCGMReferenceFitter::FitTrack( const AliHLTTPCGMMerger &merger, const AliHLTTPCGMMergedTrack &track, double par[kNPar], double cov[15], double &chi2, int &ndf )
+{
+  if ( !track.OK() || track.Looper() || track.NClusters() == 0 ) return 1;
+  const AliHLTTPCCAParam &param = merger.SliceParam();
+  const AliHLTTPCGMMergedTrackHit *clusters = merger.Clusters() + track.FirstClusterRef();
+  const int n = track.NClusters();
+  const float zOffset = track.GetParam().GetZOffset();
+  for ( int i = 0; i < n; i++ ) {
+    if ( clusters[i].fLeg != clusters[0].fLeg || ( clusters[i].fSlice < 18 ) != ( clusters[0].fSlice < 18 ) ) return 1;
+  }
+
+  // Clusters used by the production fit, the clusters of a double row are averaged with the charge as weight as in AliHLTTPCGMTrackParam::MergeDoubleRowClusters
+  std::vector<Hit> hits;
+  hits.reserve( n );
+  for ( int i = 0; i < n; ) {
+    int iEnd = i + 1;
+    while ( iEnd < n && clusters[iEnd].fRow == clusters[i].fRow && clusters[iEnd].fSlice == clusters[i].fSlice ) iEnd++;
+    Hit h;
+    memset( &h, 0, sizeof( h ) );
+    double sumW = 0.;
+    for ( int k = i; k < iEnd; k++ ) {
+      if ( clusters[k].fState & ( AliHLTTPCGMMergedTrackHit::flagReject | AliHLTTPCGMMergedTrackHit::flagNotFit ) ) continue;
+      const double w = iEnd - i > 1 ? clusters[k].fAmp : 1.;
+      h.fX += clusters[k].fX * w;
+      h.fY += clusters[k].fY * w;
+      h.fZ += ( clusters[k].fZ - zOffset ) * w;
+      h.fState |= clusters[k].fState;
+      if ( h.fCluster == NULL ) h.fCluster = &clusters[k];
+      sumW += w;
+    }
+    if ( sumW >= 0.1 ) {
+      h.fX /= sumW;
+      h.fY /= sumW;
+      h.fZ /= sumW;
+      h.fAlpha = param.Alpha( clusters[i].fSlice );
+      h.fRow = clusters[i].fRow;
+      hits.push_back( h );
+    }
+    i = iEnd;
+  }
+  const int nHits = hits.size();
+  if ( nHits < kMinHits ) return 1;
+
+  const AliHLTTPCGMPolynomialField &field = *merger.pField();
+  AliHLTTPCGMPropagator prop;
+  prop.SetMaterial( kRadLen, kRho );
+  prop.SetPolynomialField( &field );
+  prop.SetToyMCEventsFlag( param.ToyMCEventsFlag() );
+  prop.SetSpecialErrors( true );
+  AliHLTTPCGMTrackParam t = track.GetParam();
+
+  // Start from the production parameters, fit outwards (against the cluster order), then inwards. Both ways start from reset covariances
+  const AliHLTTPCGMTrackParam &prod = track.GetParam();
+  State st;
+  st.fX = prod.GetX();
+  st.fAlpha = track.GetAlpha();
+  for ( int i = 0; i < 5; i++ ) st.fP[i] = prod.GetPar( i );
+  for ( int iWay = 0; iWay < 2; iWay++ ) {
+    const bool inFlyDirection = iWay == 0;
+    chi2 = 0.;
+    ndf = -5;
+    for ( int k = 0; k < nHits; k++ ) {
+      const Hit &h = hits[inFlyDirection ? nHits - 1 - k : k];
+      double path;
+      if ( k == 0 ) {
+        double par1[5];
+        if ( !Transport( field, st.fX, st.fAlpha, st.fP, h.fX, h.fAlpha, par1, path ) ) return -1;
+        st.fX = h.fX;
+        st.fAlpha = h.fAlpha;
+        for ( int i = 0; i < 5; i++ ) st.fP[i] = par1[i];
+      } else {
+        if ( !TransportState( field, st, h.fX, h.fAlpha, path ) ) return -1;
+      }
+      SetPropagatorTrack( prop, t, st );
+      prop.SetStatErrorCurCluster( const_cast<AliHLTTPCGMMergedTrackHit *>( h.fCluster ) );
+      float err2Y, err2Z;
+      prop.GetErr2( err2Y, err2Z, param, h.fZ, h.fRow, h.fState );
+      if ( k == 0 ) { // first measurement, same initial covariance as the production refit
+        memset( st.fC, 0, sizeof( st.fC ) );
+        st.fP[0] = h.fY;
+        st.fP[1] = h.fZ;
+        st.fC[0][0] = err2Y;
+        st.fC[1][1] = err2Z;
+        st.fC[2][2] = fmax( 0.2, fabs( st.fP[2] ) / 2 );
+        st.fC[3][3] = fmax( 0.5, fabs( st.fP[3] ) / 2 );
+        st.fC[4][4] = fmax( 0.5, fabs( st.fP[4] ) );
+        ndf = -3;
+        continue;
+      }
+      MaterialCorrection( prop, st, inFlyDirection ? -path : path, param.ToyMCEventsFlag() );
+      if ( !Update( st, h.fY, h.fZ, err2Y, err2Z, chi2 ) ) return -1;
+      ndf += 2;
+    }
+  }
+
+  double path;
+  if ( !TransportState( field, st, prod.GetX(), track.GetAlpha(), path ) ) return -1;
+  SetPropagatorTrack( prop, t, st );
+  MaterialCorrection( prop, st, path, param.ToyMCEventsFlag() );
+
+  for ( int i = 0, k = 0; i < 5; i++ ) {
+    par[i] = st.fP[i];
+    for ( int j = 0; j <= i; j++ ) cov[k++] = st.fC[i][j];
+  }
+  return 0;
+}
+
+void AliHLTTPCGMReferenceFitter::FitTracks( const AliHLTTPCGMMerger &merger )
+{
+  const int nTracks = merger.NOutputTracks();
+#ifdef _OPENMP
+#pragma omp parallel
+  {
+    // the team can be larger than omp_get_max_threads() at construction (omp_set_num_threads), the implicit barrier of single protects the resize
+#pragma omp single
+    if ( (unsigned int) omp_get_num_threads() > fThreadStatistics.size() ) fThreadStatistics.resize( omp_get_num_threads() );
+    Statistics &s = fThreadStatistics[omp_get_thread_num()];
+#pragma omp for schedule( dynamic, 16 )
+#else
+  {
+    Statistics &s = fThreadStatistics[0];
+#endif
+  for ( int iTrk = 0; iTrk < nTracks; iTrk++ ) {
+    const AliHLTTPCGMMergedTrack &track = merger.OutputTracks()[iTrk];
+
+    double par[kNPar], cov[15], chi2;
+    int ndf;
+    const int retVal = FitTrack( merger, track, par, cov, chi2, ndf );
+    if ( retVal > 0 ) {
+      s.fNSkipped++;
+      continue;
+    }
+    const AliHLTTPCGMTrackParam &prod = track.GetParam();
+    bool ok = retVal == 0;
+    for ( int i = 0; i < kNPar && ok; i++ ) ok = cov[i * ( i + 3 ) / 2] > 0. && prod.GetCov( i * ( i + 3 ) / 2 ) > 0.;
+    if ( !ok ) {
+      s.fNFailed++;
+      continue;
+    }
+
+    s.fNTracks++;
+    for ( int i = 0; i < kNPar; i++ ) {
+      const double errRef = sqrt( cov[i * ( i + 3 ) / 2] );
+      const double pull = ( prod.GetPar( i ) - par[i] ) / errRef;
+      s.fSumPull[i] += pull;
+      s.fSumPull2[i] += pull * pull;
+      if ( fabs( pull ) > s.fMaxPull[i] ) s.fMaxPull[i] = fabs( pull );
+      s.fSumErrRatio[i] += sqrt( prod.GetCov( i * ( i + 3 ) / 2 ) ) / errRef;
+    }
+    s.fSumChi2NDF[0] += prod.GetChi2() / ( prod.GetNDF() > 0 ? prod.GetNDF() : 1 );
+    s.fSumChi2NDF[1] += chi2 / ( ndf > 0 ? ndf : 1 );
+  }
+  }
+}
+
+void AliHLTTPCGMReferenceFitter::GetStatistics( Statistics &s ) const
+{
+  memset( &s, 0, sizeof( s ) );
+  for ( unsigned int iThread = 0; iThread < fThreadStatistics.size(); iThread++ ) {
+    const Statistics &t = fThreadStatistics[iThread];
+    s.fNTracks += t.fNTracks;
+    s.fNSkipped += t.fNSkipped;
+    s.fNFailed += t.fNFailed;
+    for ( int i = 0; i < kNPar; i++ ) {
+      s.fSumPull[i] += t.fSumPull[i];
+      s.fSumPull2[i] += t.fSumPull2[i];
+      if ( t.fMaxPull[i] > s.fMaxPull[i] ) s.fMaxPull[i] = t.fMaxPull[i];
+      s.fSumErrRatio[i] += t.fSumErrRatio[i];
+    }
+    for ( int i = 0; i < 2; i++ ) s.fSumChi2NDF[i] += t.fSumChi2NDF[i];
+  }
+}
+
+void AliHLTTPCGMReferenceFitter::Print() const
+{
+  static const char* const parNames[kNPar] = { "Y", "Z", "SinPhi", "DzDs", "QPt" };
+  Statistics s;
+  GetStatistics( s );
+  printf( "Reference fit: %lld tracks compared, %lld skipped, %lld failed\n", s.fNTracks, s.fNSkipped, s.fNFailed );
+  if ( s.fNTracks == 0 ) return;
+  const double n = s.fNTracks;
+  printf( "\tChi2/NDF: production %8.4f, reference %8.4f\n", s.fSumChi2NDF[0] / n, s.fSumChi2NDF[1] / n );
+  printf( "\t%-8s %12s %12s %12s %14s\n", "Param", "Pull Mean", "Pull RMS", "Max |Pull|", "Err Prod/Ref" );
+  for ( int i = 0; i < kNPar; i++ ) {
+    const double mean = s.fSumPull[i] / n;
+    const double rms = sqrt( fmax( 0., s.fSumPull2[i] / n - mean * mean ) );
+    printf( "\t%-8s %12.5f %12.5f %12.5f %14.5f\n", parNames[i], mean, rms, s.fMaxPull[i], s.fSumErrRatio[i] / n );
+  }
+}
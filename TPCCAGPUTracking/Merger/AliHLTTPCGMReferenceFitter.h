@@ -0,0 +1,70 @@
+//-*- Mode: C++ -*-
+// ************************************************************************
+// This file is property of and copyright by the ALICE HLT Project        *
+// ALICE Experiment at CERN, All rights reserved.                         *
+// See cxx source for full Copyright notice                               *
+//                                                                        *
+//*************************************************************************
+
+
+#ifndef ALIHLTTPCGMREFERENCEFITTER_H
+#define ALIHLTTPCGMREFERENCEFITTER_H
+
+#include <vector>
+
+class AliHLTTPCGMMerger;
+class AliHLTTPCGMMergedTrack;
+
+/**
+ * @class AliHLTTPCGMReferenceFitter
+ *
+ * Double precision reference refit of the merged tracks, to validate AliHLTTPCGMTrackParam::Fit without AliRoot
+ * (AliHLTTPCGMOfflineFitter needs AliTPCtracker). Host only, independent of the merger, it only reads its output.
+ *
+ * The reference fit uses the clusters accepted by the production fit (double-row clusters merged in the same way) and the same
+ * cluster errors and material model (taken from AliHLTTPCGMPropagator), but none of its approximations:
+ * the trajectory is integrated with Runge-Kutta steps through the 3D polynomial field (AliHLTTPCGMPolynomialField::GetField in double),
+ * the transport Jacobian is obtained numerically, the material corrections are evaluated at every cluster and the Kalman update
+ * always uses the full 2D measurement. Like the production fit, a fit outwards is followed by a fit inwards, both starting from
+ * reset covariances, and the result is transported to X and alpha of the production parameters.
+ *
+ * The pull of a parameter is (production - reference) / reference error. The pulls and the ratios of the production to the reference
+ * errors are accumulated per thread, so FitTracks can refit the tracks in parallel. Loopers and tracks crossing the central electrode are skipped.
+ */
+class AliHLTTPCGMReferenceFitter
+{
+ public:
+  enum { kNPar = 5 };
+
+  struct Statistics
+  {
+    long long fNTracks;        // tracks compared
+    long long fNSkipped;       // tracks not refit (not OK, loopers, crossing the central electrode, too few clusters)
+    long long fNFailed;        // reference fit failed
+    double fSumPull[kNPar];    // sum of the pulls
+    double fSumPull2[kNPar];   // sum of the pulls^2
+    double fMaxPull[kNPar];    // max |pull|
+    double fSumErrRatio[kNPar]; // sum of the production error / reference error
+    double fSumChi2NDF[2];     // sum of chi2/ndf, production and reference
+  };
+
+  AliHLTTPCGMReferenceFitter();
+
+  void Reset();
+
+  // Refits all merged tracks of the merger (in parallel) and adds their pulls
+  void FitTracks( const AliHLTTPCGMMerger &merger );
+
+  // Reference fit of one track, par and cov (lower triangle, as AliHLTTPCGMTrackParam) at X and alpha of the production parameters.
+  // Returns 0 on success, 1 if the track is skipped, -1 if the fit failed
+  static int FitTrack( const AliHLTTPCGMMerger &merger, const AliHLTTPCGMMergedTrack &track, double par[kNPar], double cov[15], double &chi2, int &ndf );
+
+  // Sum of the statistics of all threads
+  void GetStatistics( Statistics &s ) const;
+  void Print() const;
+
+ private:
+  std::vector<Statistics> fThreadStatistics;
+};
+
+#endif
@@ -0,0 +1,254 @@
+// **************************************************************************
+// This file is property of and copyright by the ALICE HLT Project          *
+// ALICE Experiment at CERN, All rights reserved.                           *
+//                                                                          *
+// Permission to use, copy, modify and distribute this software and its     *
+// documentation strictly for non-commercial purposes is hereby granted     *
+// without fee, provided that the above copyright notice appears in all     *
+// copies and that both the copyright notice and this permission notice     *
+// appear in the supporting documentation. The authors make no claims       *
+// about the suitability of this software for any purpose. It is            *
+// provided "as is" without express or implied warranty.                    *
+//                                                                          *
+//***************************************************************************
+
+#include "AliHLTTPCGMResidualCollector.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+const float AliHLTTPCGMResidualCollector::fgkZMax = 250.f;
+const float AliHLTTPCGMResidualCollector::fgkAngleMax = 1.5f;
+
+namespace
+{
+  struct ResidualFileHeader
+  {
+    char fMagic[8];
+    int fVersion;
+    int fNYZ, fNRowTypes, fNZBins, fNAngleBins;
+    float fZMax, fAngleMax;
+  };
+
+  void FillHeader( ResidualFileHeader &h )
+  {
+    memset( &h, 0, sizeof( h ) );
+    memcpy( h.fMagic, "HLTCARES", 8 );
+    h.fVersion = 1;
+    h.fNYZ = AliHLTTPCGMResidualCollector::kNYZ;
+    h.fNRowTypes = AliHLTTPCGMResidualCollector::kNRowTypes;
+    h.fNZBins = AliHLTTPCGMResidualCollector::kNZBins;
+    h.fNAngleBins = AliHLTTPCGMResidualCollector::kNAngleBins;
+    h.fZMax = AliHLTTPCGMResidualCollector::fgkZMax;
+    h.fAngleMax = AliHLTTPCGMResidualCollector::fgkAngleMax;
+  }
+
+  bool SolveLinear( double *a, double *b, int n )
+  {
+    // Solves a x = b (a is n x n, row major) by Gaussian elimination with partial pivoting, the solution is returned in b
+    for ( int i = 0; i < n; i++ ) {
+      int iMax = i;
+      for ( int j = i + 1; j < n; j++ ) if ( fabs( a[j * n + i] ) > fabs( a[iMax * n + i] ) ) iMax = j;
+      if ( fabs( a[iMax * n + i] ) < 1.e-30 ) return false;
+      if ( iMax != i ) {
+        for ( int k = 0; k < n; k++ ) { double tmp = a[i * n + k]; a[i * n + k] = a[iMax * n + k]; a[iMax * n + k] = tmp; }
+        double tmp = b[i]; b[i] = b[iMax]; b[iMax] = tmp;
+      }
+      for ( int j = i + 1; j < n; j++ ) {
+        const double f = a[j * n + i] / a[i * n + i];
+        for ( int k = i; k < n; k++ ) a[j * n + k] -= f * a[i * n + k];
+        b[j] -= f * b[i];
+      }
+    }
+    for ( int i = n - 1; i >= 0; i-- ) {
+      for ( int k = i + 1; k < n; k++ ) b[i] -= a[i * n + k] * b[k];
+      b[i] /= a[i * n + i];
+    }
+    return true;
+  }
+}
+
+void AliHLTTPCGMResidualCollector::ThreadData::Predict( int ihit, int iWay, float y, float z, const float *par, const float *cov )
+{
+  fPending = false;
+  if ( ihit < 0 || ihit >= (int) fPredictions.size() ) return;
+  Prediction &p = fPredictions[ihit];
+  // Residuals instead of track positions, the z offset of the track might change between the fit ways
+  const float res[2] = { y - par[0], z - par[1] };
+  const float err2[2] = { cov[0], cov[2] };
+  if ( iWay == 1 ) {
+    for ( int i = 0; i < 2; i++ ) {
+      p.fRes[i] = res[i];
+      p.fErr2[i] = err2[i];
+    }
+    p.fSinPhi = par[2];
+    p.fDzDs = par[3];
+    p.fValid = true;
+  } else if ( iWay == 2 && p.fValid ) {
+    for ( int i = 0; i < 2; i++ ) {
+      const float sumErr2 = p.fErr2[i] + err2[i];
+      if ( !( sumErr2 > 0.f ) ) return;
+      fRes[i] = ( res[i] * p.fErr2[i] + p.fRes[i] * err2[i] ) / sumErr2;
+      fTrkErr2[i] = p.fErr2[i] * err2[i] / sumErr2;
+    }
+    fSinPhi = 0.5f * ( par[2] + p.fSinPhi );
+    fDzDs = 0.5f * ( par[3] + p.fDzDs );
+    fZ = z;
+    fPending = true;
+  }
+}
+
+void AliHLTTPCGMResidualCollector::ThreadData::Commit( int row )
+{
+  if ( !fPending ) return;
+  fPending = false;
+
+  // Same variables as in AliHLTTPCCAParam::GetClusterErrors2
+  const int rowType = ( row < 63 ) ? 0 : ( ( row > 126 ) ? 1 : 2 );
+  const float z = fabs( ( 250.f - 0.275f ) - fabs( fZ ) );
+  float s2 = fSinPhi * fSinPhi;
+  if ( s2 > 0.95f * 0.95f ) s2 = 0.95f * 0.95f;
+  const float sec2 = 1.f / ( 1.f - s2 );
+  const float angle2[2] = { s2 * sec2, fDzDs * fDzDs * sec2 };
+
+  int iZ = (int) ( z * ( kNZBins / fgkZMax ) );
+  if ( iZ >= kNZBins ) iZ = kNZBins - 1;
+  for ( int yz = 0; yz < 2; yz++ ) {
+    // Binned in the angle, not in angle^2, for a finer binning of the small angles
+    int iAngle = (int) ( sqrtf( angle2[yz] ) * ( kNAngleBins / fgkAngleMax ) );
+    if ( iAngle >= kNAngleBins ) iAngle = kNAngleBins - 1;
+    Bin &b = fBins[BinIndex( yz, rowType, iZ, iAngle )];
+    b.fN += 1.;
+    b.fSumZ += z;
+    b.fSumAngle2 += angle2[yz];
+    b.fSumRes += fRes[yz];
+    b.fSumRes2 += fRes[yz] * fRes[yz];
+    b.fSumTrkErr2 += fTrkErr2[yz];
+  }
+}
+
+AliHLTTPCGMResidualCollector::AliHLTTPCGMResidualCollector() : fThreadData()
+{
+#ifdef _OPENMP
+  fThreadData.resize( omp_get_max_threads() );
+#else
+  fThreadData.resize( 1 );
+#endif
+  Reset();
+}
+
+void AliHLTTPCGMResidualCollector::Reset()
+{
+  for ( unsigned int i = 0; i < fThreadData.size(); i++ ) {
+    memset( fThreadData[i].fBins.data(), 0, kNBins * sizeof( Bin ) );
+  }
+}
+
+AliHLTTPCGMResidualCollector::ThreadData* AliHLTTPCGMResidualCollector::StartTrack( int maxN )
+{
+#ifdef _OPENMP
+  const unsigned int iThread = omp_get_thread_num();
+#else
+  const unsigned int iThread = 0;
+#endif
+  if ( iThread >= fThreadData.size() ) return NULL;
+  ThreadData &data = fThreadData[iThread];
+  if ( (int) data.fPredictions.size() < maxN ) data.fPredictions.resize( maxN );
+  for ( int i = 0; i < maxN; i++ ) data.fPredictions[i].fValid = false;
+  data.fPending = false;
+  return &data;
+}
+
+void AliHLTTPCGMResidualCollector::GetBins( std::vector<Bin> &bins ) const
+{
+  bins.assign( kNBins, Bin() );
+  memset( bins.data(), 0, kNBins * sizeof( Bin ) );
+  for ( unsigned int iThread = 0; iThread < fThreadData.size(); iThread++ ) {
+    const Bin *threadBins = fThreadData[iThread].fBins.data();
+    for ( int i = 0; i < kNBins; i++ ) {
+      bins[i].fN += threadBins[i].fN;
+      bins[i].fSumZ += threadBins[i].fSumZ;
+      bins[i].fSumAngle2 += threadBins[i].fSumAngle2;
+      bins[i].fSumRes += threadBins[i].fSumRes;
+      bins[i].fSumRes2 += threadBins[i].fSumRes2;
+      bins[i].fSumTrkErr2 += threadBins[i].fSumTrkErr2;
+    }
+  }
+}
+
+bool AliHLTTPCGMResidualCollector::Write( const char *filename, bool append ) const
+{
+  std::vector<Bin> bins, oldBins;
+  GetBins( bins );
+  if ( append && Read( filename, oldBins ) ) {
+    for ( int i = 0; i < kNBins; i++ ) {
+      bins[i].fN += oldBins[i].fN;
+      bins[i].fSumZ += oldBins[i].fSumZ;
+      bins[i].fSumAngle2 += oldBins[i].fSumAngle2;
+      bins[i].fSumRes += oldBins[i].fSumRes;
+      bins[i].fSumRes2 += oldBins[i].fSumRes2;
+      bins[i].fSumTrkErr2 += oldBins[i].fSumTrkErr2;
+    }
+  }
+  FILE *fp = fopen( filename, "w+b" );
+  if ( fp == NULL ) return false;
+  ResidualFileHeader h;
+  FillHeader( h );
+  bool ok = fwrite( &h, sizeof( h ), 1, fp ) == 1 && fwrite( bins.data(), sizeof( Bin ), kNBins, fp ) == (size_t) kNBins;
+  fclose( fp );
+  return ok;
+}
+
+bool AliHLTTPCGMResidualCollector::Read( const char *filename, std::vector<Bin> &bins )
+{
+  FILE *fp = fopen( filename, "rb" );
+  if ( fp == NULL ) return false;
+  ResidualFileHeader h, ref;
+  FillHeader( ref );
+  bins.resize( kNBins );
+  bool ok = fread( &h, sizeof( h ), 1, fp ) == 1 && memcmp( &h, &ref, sizeof( h ) ) == 0 && fread( bins.data(), sizeof( Bin ), kNBins, fp ) == (size_t) kNBins;
+  fclose( fp );
+  return ok;
+}
+
+int AliHLTTPCGMResidualCollector::FitParameterization( const std::vector<Bin> &bins, float paramS0Par[2][3][6], float paramRMS0[2][3][4], int minEntries )
+{
+  // Weighted least squares fit of the cluster errors of the bins:
+  // error^2 = c0 + c1*z + c2*a2 + c3*z^2 + c4*a2^2 + c5*z*a2 (S0Par),
+  // error = c0 + c1*z + c2*a2 (RMS0, c3 is not used by AliHLTTPCCAParam)
+  int nFitted = 0;
+  for ( int yz = 0; yz < kNYZ; yz++ ) {
+    for ( int rowType = 0; rowType < kNRowTypes; rowType++ ) {
+      double aS0[36] = { 0 }, bS0[6] = { 0 }, aRMS[9] = { 0 }, bRMS[3] = { 0 };
+      int nBins = 0;
+      for ( int iZ = 0; iZ < kNZBins; iZ++ ) {
+        for ( int iAngle = 0; iAngle < kNAngleBins; iAngle++ ) {
+          const Bin &b = bins[BinIndex( yz, rowType, iZ, iAngle )];
+          if ( b.fN < minEntries ) continue;
+          const double mean = b.fSumRes / b.fN;
+          const double err2 = b.fSumRes2 / b.fN - mean * mean - b.fSumTrkErr2 / b.fN;
+          if ( err2 <= 0. ) continue;
+          const double z = b.fSumZ / b.fN, a2 = b.fSumAngle2 / b.fN;
+          const double f[6] = { 1., z, a2, z * z, a2 * a2, z * a2 };
+          for ( int i = 0; i < 6; i++ ) {
+            for ( int j = 0; j < 6; j++ ) aS0[i * 6 + j] += b.fN * f[i] * f[j];
+            bS0[i] += b.fN * f[i] * err2;
+          }
+          for ( int i = 0; i < 3; i++ ) {
+            for ( int j = 0; j < 3; j++ ) aRMS[i * 3 + j] += b.fN * f[i] * f[j];
+            bRMS[i] += b.fN * f[i] * sqrt( err2 );
+          }
+          nBins++;
+        }
+      }
+      if ( nBins < 6 || !SolveLinear( aS0, bS0, 6 ) || !SolveLinear( aRMS, bRMS, 3 ) ) continue;
+      for ( int i = 0; i < 6; i++ ) paramS0Par[yz][rowType][i] = bS0[i];
+      for ( int i = 0; i < 3; i++ ) paramRMS0[yz][rowType][i] = bRMS[i];
+      nFitted++;
+    }
+  }
+  return nFitted;
+}
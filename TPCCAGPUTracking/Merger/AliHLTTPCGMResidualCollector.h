@@ -0,0 +1,99 @@
+//-*- Mode: C++ -*-
+// ************************************************************************
+// This file is property of and copyright by the ALICE HLT Project        *
+// ALICE Experiment at CERN, All rights reserved.                         *
+// See cxx source for full Copyright notice                               *
+//                                                                        *
+//*************************************************************************
+
+
+#ifndef ALIHLTTPCGMRESIDUALCOLLECTOR_H
+#define ALIHLTTPCGMRESIDUALCOLLECTOR_H
+
+#include <vector>
+
+/**
+ * @class AliHLTTPCGMResidualCollector
+ *
+ * Collects the cluster residuals of the GM refit, for the calibration of the cluster error parameterization
+ * (fParamS0Par / fParamRMS0 of AliHLTTPCCAParam). Host only, enabled at runtime via AliHLTTPCGMMerger::SetResidualCollector.
+ *
+ * The residual of a cluster is taken to the unbiased track estimate, i.e. the weighted mean of the predictions
+ * of the 2nd fit way (excluding the clusters on one side) and the 3rd fit way (excluding the other side), hence NWays >= 3 is needed.
+ * The residuals are not stored, but accumulated into the moments of bins in (y/z, row type, drift length, angle),
+ * the same variables as used by AliHLTTPCCAParam::GetClusterErrors2. Every thread fills its own bins, thus no locking,
+ * the memory does not grow with the number of clusters.
+ * The variance of the residuals minus the variance of the track estimate is the cluster error^2 of a bin,
+ * FitParameterization fits the parameterization coefficients to it.
+ */
+class AliHLTTPCGMResidualCollector
+{
+ public:
+  enum { kNYZ = 2, kNRowTypes = 3, kNZBins = 25, kNAngleBins = 20, kNBins = kNYZ * kNRowTypes * kNZBins * kNAngleBins };
+  static const float fgkZMax;      // max drift length of the binning
+  static const float fgkAngleMax;  // max angle (sqrt(angle^2)) of the binning, larger angles go to the last bin
+
+  struct Bin
+  {
+    double fN;           // number of residuals
+    double fSumZ;        // sum of drift lengths
+    double fSumAngle2;   // sum of angle^2
+    double fSumRes;      // sum of residuals
+    double fSumRes2;     // sum of residuals^2
+    double fSumTrkErr2;  // sum of track error^2 at the cluster
+  };
+
+  /**
+   * Scratch memory and bins of one thread
+   */
+  class ThreadData
+  {
+   public:
+    ThreadData() : fBins(kNBins), fPredictions(), fPending(false), fRes(), fTrkErr2(), fSinPhi(0), fDzDs(0), fZ(0) {}
+
+    // Called with the track at the cluster, before the update. Stores the prediction in fit way 1, computes the unbiased residual in fit way 2
+    void Predict( int ihit, int iWay, float y, float z, const float *par, const float *cov );
+    // Adds the residual of the last Predict call to the bins, to be called only if the cluster was used in the fit
+    void Commit( int row );
+
+   private:
+    friend class AliHLTTPCGMResidualCollector;
+    struct Prediction
+    {
+      float fRes[2], fErr2[2], fSinPhi, fDzDs; // residuals, track errors^2 in y and z, track slopes
+      bool fValid;
+    };
+
+    std::vector<Bin> fBins;
+    std::vector<Prediction> fPredictions; // per hit of the current track
+    bool fPending;                        // Predict produced a residual
+    float fRes[2], fTrkErr2[2], fSinPhi, fDzDs, fZ;
+  };
+
+  AliHLTTPCGMResidualCollector();
+  AliHLTTPCGMResidualCollector( const AliHLTTPCGMResidualCollector& ) = delete;
+  AliHLTTPCGMResidualCollector& operator=( const AliHLTTPCGMResidualCollector& ) = delete;
+
+  void Reset();
+
+  // Scratch memory and bins of the calling thread, prepared for a track with maxN hits, NULL if the thread is unknown
+  ThreadData* StartTrack( int maxN );
+
+  // Sum of the bins of all threads
+  void GetBins( std::vector<Bin> &bins ) const;
+
+  // Binary output: header and the summed bins. Write adds the bins already stored in the file if append is set
+  bool Write( const char *filename, bool append = false ) const;
+  static bool Read( const char *filename, std::vector<Bin> &bins );
+
+  // Fits the parameterizations to the cluster errors of the bins, bins with less than minEntries residuals are ignored.
+  // Coefficients of row types without enough bins are not changed. Returns the number of fitted row types
+  static int FitParameterization( const std::vector<Bin> &bins, float paramS0Par[2][3][6], float paramRMS0[2][3][4], int minEntries = 100 );
+
+  static int BinIndex( int yz, int rowType, int iZ, int iAngle ) { return ( ( yz * kNRowTypes + rowType ) * kNZBins + iZ ) * kNAngleBins + iAngle; }
+
+ private:
+  std::vector<ThreadData> fThreadData;
+};
+
+#endif
@@ -22,6 +22,7 @@
  */
 class AliHLTTPCGMSliceTrack
 {
+  friend class AliHLTTPCGMSliceTrackBatch;
   
  public:
   
@@ -0,0 +1,464 @@
+// **************************************************************************
+// This file is property of and copyright by the ALICE HLT Project          *
+// ALICE Experiment at CERN, All rights reserved.                           *
+//                                                                          *
+// Permission to use, copy, modify and distribute this software and its     *
+// documentation strictly for non-commercial purposes is hereby granted     *
+// without fee, provided that the above copyright notice appears in all     *
+// copies and that both the copyright notice and this permission notice     *
+// appear in the supporting documentation. The authors make no claims       *
+// about the suitability of this software for any purpose. It is            *
+// provided "as is" without express or implied warranty.                    *
+//                                                                          *
+//***************************************************************************
+
+#include "AliHLTTPCGMSliceTrackBatch.h"
+#include "AliHLTTPCGMSliceTrack.h"
+#include "AliHLTTPCGMBorderTrack.h"
+#include "AliHLTTPCCAParam.h"
+#include "AliHLTTPCCAMath.h"
+#include <cmath>
+
+// The arithmetic follows AliHLTTPCGMSliceTrack.cxx operation by operation (including the double precision constants),
+// such that the results only differ by the vectorized division / square root. Lanes which are rejected continue with harmless values, since
+// the standalone benchmark traps floating point exceptions.
+
+namespace {
+  struct ClusterErrorCoefficients // AliHLTTPCCAParam::GetClusterErrors2 / GetClusterRMS2 for row 0
+  {
+    float fS0Y[6], fS0Z[6], fRMSY[4], fRMSZ[4]; // copies, pointers into the param would require alias checks in the vectorized loops
+    float fCorrY, fCorrZ;
+
+    ClusterErrorCoefficients( const AliHLTTPCCAParam &param ) : fCorrY( param.ClusterError2CorrectionY() ), fCorrZ( param.ClusterError2CorrectionZ() )
+    {
+      for( int i=0; i<6; i++ ){
+        fS0Y[i] = param.GetParamS0Par( 0, 0 )[i];
+        fS0Z[i] = param.GetParamS0Par( 1, 0 )[i];
+      }
+      for( int i=0; i<4; i++ ){
+        fRMSY[i] = param.GetParamRMS0( 0, 0 )[i];
+        fRMSZ[i] = param.GetParamRMS0( 1, 0 )[i];
+      }
+    }
+
+    static inline float Error2( const float *c, float corr, float z, float angle2 )
+    {
+      float v = c[0] + c[1]*z + c[2]*angle2 + c[3]*z*z
+        +c[4]*angle2*angle2 + c[5]*z*angle2;
+      v = fabs(v);
+      if (v<0.01) v = 0.01;
+      return v * corr;
+    }
+
+    static inline float RMS2( const float *c, float z, float angle2 )
+    {
+      float v = c[0] + c[1]*z + c[2]*angle2;
+      v = fabs(v);
+      return v * v;
+    }
+
+    // Maximum of the calibrated cluster error and the cluster RMS, as in AliHLTTPCGMSliceTrack::FilterErrors
+    inline void Get( float z, float sinPhi, float DzDs, float &err2Y, float &err2Z ) const
+    {
+      z = CAMath::Abs( ( 250. - 0.275 ) - CAMath::Abs( z ) );
+      float s2 = sinPhi*sinPhi;
+      if( s2>0.95f*0.95f ) s2 = 0.95f*0.95f;
+      float sec2 = 1.f/(1.f-s2);
+      float angleY2 = s2 * sec2;
+      float angleZ2 = DzDs * DzDs * sec2;
+      err2Y = Error2( fS0Y, fCorrY, z, angleY2 );
+      err2Z = Error2( fS0Z, fCorrZ, z, angleZ2 );
+      float C0a = RMS2( fRMSY, z, angleY2 );
+      float C2a = RMS2( fRMSZ, z, angleZ2 );
+      if (C0a > err2Y) err2Y = C0a;
+      if (C2a > err2Z) err2Z = C2a;
+    }
+  };
+}
+
+void AliHLTTPCGMSliceTrackBatch::Load( const AliHLTTPCGMSliceTrack *const *tracks, int n )
+{
+  fN = n;
+  for( int i=0; i<kLanes; i++ ){
+    const AliHLTTPCGMSliceTrack &t = *tracks[i < n ? i : n - 1];
+    fX[i] = t.fX; fY[i] = t.fY; fZ[i] = t.fZ;
+    fSinPhi[i] = t.fSinPhi; fDzDs[i] = t.fDzDs; fQPt[i] = t.fQPt; fCosPhi[i] = t.fCosPhi; fSecPhi[i] = t.fSecPhi;
+    fZOffset[i] = t.fZOffset;
+    fLastX[i] = t.fOrigTrack->Cluster( t.fOrigTrack->NClusters() - 1 ).GetX();
+    fC0[i] = t.fC0; fC2[i] = t.fC2; fC3[i] = t.fC3; fC5[i] = t.fC5; fC7[i] = t.fC7;
+    fC9[i] = t.fC9; fC10[i] = t.fC10; fC12[i] = t.fC12; fC14[i] = t.fC14;
+  }
+}
+
+void AliHLTTPCGMSliceTrackBatch::Store( AliHLTTPCGMSliceTrack *const *tracks ) const
+{
+  for( int i=0; i<fN; i++ ){
+    AliHLTTPCGMSliceTrack &t = *tracks[i];
+    t.fX = fX[i]; t.fY = fY[i]; t.fZ = fZ[i];
+    t.fSinPhi = fSinPhi[i]; t.fCosPhi = fCosPhi[i]; t.fSecPhi = fSecPhi[i];
+    t.fC0 = fC0[i]; t.fC2 = fC2[i]; t.fC3 = fC3[i]; t.fC5 = fC5[i]; t.fC7 = fC7[i];
+    t.fC9 = fC9[i]; t.fC10 = fC10[i]; t.fC12 = fC12[i]; t.fC14 = fC14[i];
+  }
+}
+
+void AliHLTTPCGMSliceTrackBatch::FilterErrors( const AliHLTTPCCAParam &param, float maxSinPhi, float sinPhiMargin, bool *ok )
+{
+  const int N = 3;
+
+  const float bz = -param.ConstBz();
+  const ClusterErrorCoefficients err( param );
+  const float maxSinPhiMargin = maxSinPhi + sinPhiMargin;
+  const float sinPhiUp = maxSinPhi - 0.01;
+  const float sinPhiDown = -maxSinPhi + 0.01;
+
+  float k[kLanes], dx[kLanes], kdx[kLanes], dxBz[kLanes], kdx205[kLanes];
+  int good[kLanes];
+
+  for( int i=0; i<kLanes; i++ ){
+    k[i] = fQPt[i]*bz;
+    dx[i] = (1.f/N)*(fLastX[i] - fX[i]);
+    kdx[i] = k[i]*dx[i];
+    dxBz[i] = dx[i] * bz;
+    kdx205[i] = 2.f+kdx[i]*kdx[i]*0.5f;
+    good[i] = 1;
+
+    err.Get( fZ[i], fSinPhi[i], fDzDs[i], fC0[i], fC2[i] );
+    fC3[i] = 0;
+    fC5[i] = 1;
+    fC7[i] = 0;
+    fC9[i] = 1;
+    fC10[i] = 0;
+    fC12[i] = 0;
+    fC14[i] = 10;
+  }
+
+  for( int iStep=0; iStep<N; iStep++ ){
+    for( int i=0; i<kLanes; i++ ){
+
+      // transport block
+
+      float ex = fCosPhi[i];
+      float ey = fSinPhi[i];
+      float ey1 = kdx[i] + ey;
+      const bool clamp = fabs( ey1 ) > maxSinPhi;
+      const bool up = ( ey1 > maxSinPhi ) & ( ey1 < maxSinPhiMargin );
+      const bool fail = clamp & !up & !( ey1 > -maxSinPhiMargin );
+      good[i] &= !fail;
+      ey1 = clamp ? ( fail ? ey : up ? sinPhiUp : sinPhiDown ) : ey1;
+
+      float ss = ey + ey1;
+      float ex1 = sqrt(1.f - ey1*ey1);
+
+      float cc = ex + ex1;
+      float dxcci = dx[i] / cc;
+
+      float dy = dxcci * ss;
+      float norm2 = 1.f + ey*ey1 + ex*ex1;
+      float dl = dxcci * sqrt( norm2 + norm2 );
+
+      float dS;
+      {
+        float dSin = 0.5f*k[i]*dl;
+        float a = dSin*dSin;
+        const float k2 = 1.f/6.f;
+        const float k4 = 3.f/40.f;
+        dS = dl + dl*a*(k2 + a*(k4 ));
+      }
+
+      float dz = dS * fDzDs[i];
+      float ex1i =1.f/ex1;
+      float err2Y, err2Z;
+      err.Get( fZ[i], fSinPhi[i], fDzDs[i], err2Y, err2Z );
+
+      float hh = kdx205[i] * dxcci*ex1i;
+      float h2 = hh * fSecPhi[i];
+
+      fX[i]+=dx[i];
+      fY[i]+= dy;
+      fZ[i]+= dz;
+      fSinPhi[i] = ey1;
+      fCosPhi[i] = ex1;
+      fSecPhi[i] = ex1i;
+
+      float h4 = bz*dxcci*hh;
+
+      float c20 = fC3[i];
+      float c22 = fC5[i];
+      float c31 = fC7[i];
+      float c33 = fC9[i];
+      float c40 = fC10[i];
+      float c42 = fC12[i];
+      float c44 = fC14[i];
+
+      float c20ph4c42 =  c20 + h4*c42;
+      float h2c22 = h2*c22;
+      float h4c44 = h4*c44;
+      float n7 = c31 + dS*c33;
+      float n10 = c40 + h2*c42 + h4c44;
+      float n12 = c42 + dxBz[i]*c44;
+
+      float c00 = fC0[i] + ( h2*h2c22 + h4*h4c44 + 2.f*( h2*c20ph4c42  + h4*c40 ) );
+      c20 = c20ph4c42 + h2c22  + dxBz[i]*n10;
+      c40 = n10;
+      c22 = c22 + dxBz[i]*( c42 + n12 );
+      c42 = n12;
+      float c11 = fC2[i] + dS*(c31 + n7);
+      c31 = n7;
+
+      // Filter block
+
+      float mS0 = 1.f/(err2Y + c00);
+      float mS2 = 1.f/(err2Z + c11);
+
+      float k00 = c00 * mS0;
+      float k20 = c20 * mS0;
+      float k40 = c40 * mS0;
+
+      fC0[i] = c00 - k00 * c00;
+      fC5[i] = c22 - k20 * c20;
+      fC10[i] = c40 - k00 * c40;
+      fC12[i] = c42 - k40 * c20;
+      fC3[i] = c20 - k20 * c00;
+      fC14[i] = c44 - k40 * c40;
+
+      float k11 = c11 * mS2;
+      float k31 = c31 * mS2;
+
+      fC7[i] = c31 - k31 * c11;
+      fC2[i] = c11 - k11 * c11;
+      fC9[i] = c33 - k31 * c31;
+    }
+  }
+
+  //* Check that the track parameters and covariance matrix are reasonable
+
+  for( int i=0; i<kLanes; i++ ){
+    bool okLane = good[i] & AliHLTTPCCAMath::Finite(fX[i]) & AliHLTTPCCAMath::Finite(fY[i]) & AliHLTTPCCAMath::Finite(fZ[i]) & AliHLTTPCCAMath::Finite(fSinPhi[i]) &
+      AliHLTTPCCAMath::Finite(fDzDs[i]) & AliHLTTPCCAMath::Finite(fQPt[i]) & AliHLTTPCCAMath::Finite(fCosPhi[i]) & AliHLTTPCCAMath::Finite(fSecPhi[i]) &
+      AliHLTTPCCAMath::Finite(fZOffset[i]) & AliHLTTPCCAMath::Finite(fC0[i]) & AliHLTTPCCAMath::Finite(fC2[i]) & AliHLTTPCCAMath::Finite(fC3[i]) &
+      AliHLTTPCCAMath::Finite(fC5[i]) & AliHLTTPCCAMath::Finite(fC7[i]) & AliHLTTPCCAMath::Finite(fC9[i]) & AliHLTTPCCAMath::Finite(fC10[i]) &
+      AliHLTTPCCAMath::Finite(fC12[i]) & AliHLTTPCCAMath::Finite(fC14[i]);
+
+    okLane = okLane & !( ( fC0[i] <= 0.f ) | ( fC2[i] <= 0.f ) | ( fC5[i] <= 0.f ) | ( fC9[i] <= 0.f ) | ( fC14[i] <= 0.f )
+      | ( fC0[i] > 5.f ) | ( fC2[i] > 5.f ) | ( fC5[i] > 2.f ) | ( fC9[i] > 2.f ) );
+
+    okLane = okLane
+      & ( fC3[i]*fC3[i]<=fC5[i]*fC0[i] )
+      & ( fC7[i]*fC7[i]<=fC9[i]*fC2[i] )
+      & ( fC10[i]*fC10[i]<=fC14[i]*fC0[i] )
+      & ( fC12[i]*fC12[i]<=fC14[i]*fC5[i] );
+    good[i] = okLane;
+  }
+  for( int i=0; i<fN; i++ ) ok[i] = good[i];
+}
+
+int AliHLTTPCGMSliceTrackBatch::TransportToX( float x, float Bz, AliHLTTPCGMBorderTrack *b, int *lane, float maxSinPhi )
+{
+  bool ok[kLanes];
+  Bz = -Bz;
+  for( int i=0; i<kLanes; i++ ){
+    float ex = fCosPhi[i];
+    float ey = fSinPhi[i];
+    float k  = fQPt[i]*Bz;
+    float dx = x - fX[i];
+    float ey1 = k*dx + ey;
+
+    ok[i] = !( fabs( ey1 ) > maxSinPhi );
+    ey1 = ok[i] ? ey1 : ey;
+
+    float ex1 = sqrt( 1.f - ey1 * ey1 );
+    float dxBz = dx * Bz;
+
+    float ss = ey + ey1;
+    float cc = ex + ex1;
+    float dxcci = dx / cc;
+    float norm2 = 1.f + ey*ey1 + ex*ex1;
+
+    float dy = dxcci * ss;
+
+    float dS;
+    {
+      float dl = dxcci * sqrt( norm2 + norm2 );
+      float dSin = 0.5f*k*dl;
+      float a = dSin*dSin;
+      const float k2 = 1.f/6.f;
+      const float k4 = 3.f/40.f;
+      dS = dl + dl*a*(k2 + a*(k4 ));
+    }
+
+    float dz = dS * fDzDs[i];
+
+    fPar[0][i] = fY[i] + dy;
+    fPar[1][i] = fZ[i] + dz;
+    fPar[2][i] = ey1;
+    fPar[3][i] = fDzDs[i];
+    fPar[4][i] = fQPt[i];
+
+    float ex1i = 1.f/ex1;
+    float hh = dxcci*ex1i*norm2;
+    float h2 = hh *fSecPhi[i];
+    float h4 = Bz*dxcci*hh;
+
+    float c20 = fC3[i];
+    float c22 = fC5[i];
+    float c31 = fC7[i];
+    float c33 = fC9[i];
+    float c40 = fC10[i];
+    float c42 = fC12[i];
+    float c44 = fC14[i];
+
+    float c20ph4c42 =  c20 + h4*c42;
+    float h2c22 = h2*c22;
+    float h4c44 = h4*c44;
+    float n7 = c31 + dS*c33;
+
+    float cov0 = fC0[i] + h2*h2c22 + h4*h4c44 + 2.f*( h2*c20ph4c42  + h4*c40 );
+    float cov1 = fC2[i]+ dS*(c31 + n7);
+    if (fabs(fQPt[i]) > 6.66) //Special treatment for low Pt, see AliHLTTPCGMSliceTrack::TransportToX
+    {
+      cov0 = AliHLTTPCCAMath::Max(fC0[i], cov0);
+      float C2tmp = dS * 2.f * c31;
+      if (C2tmp < 0) C2tmp = 0;
+      cov1 = fC2[i] + C2tmp + dS * dS * c33;
+    }
+    fCov[0][i] = cov0;
+    fCov[1][i] = cov1;
+    fCov[2][i] = c22 + dxBz*( c42 + c42 + dxBz*c44 );
+    fCov[3][i] = c33;
+    fCov[4][i] = c44;
+    fCovD[0][i] = c20ph4c42 + h2c22  + dxBz*(c40 + h2*c42 + h4c44);
+    fCovD[1][i] = n7;
+  }
+  return StoreBorderTracks( ok, b, lane );
+}
+
+int AliHLTTPCGMSliceTrackBatch::TransportToXAlpha( float newX, float sinAlpha, float cosAlpha, float Bz, AliHLTTPCGMBorderTrack *b, int *lane, float maxSinPhi )
+{
+  bool ok[kLanes];
+  Bz = -Bz;
+  for( int i=0; i<kLanes; i++ ){
+    float c00 = fC0[i];
+    float c11 = fC2[i];
+    float c20 = fC3[i];
+    float c22 = fC5[i];
+    float c31 = fC7[i];
+    float c33 = fC9[i];
+    float c40 = fC10[i];
+    float c42 = fC12[i];
+    float c44 = fC14[i];
+
+    float x,y;
+    float z = fZ[i];
+    float sinPhi = fSinPhi[i];
+    float cosPhi = fCosPhi[i];
+    float secPhi;
+    float dzds = fDzDs[i];
+    float qpt = fQPt[i];
+
+    // Rotate the coordinate system in XY on the angle alpha
+    {
+      float sP = sinPhi, cP = cosPhi;
+      cosPhi =  cP * cosAlpha + sP * sinAlpha;
+      sinPhi = -cP * sinAlpha + sP * cosAlpha;
+
+      ok[i] = !( CAMath::Abs( sinPhi ) > HLTCA_MAX_SIN_PHI || CAMath::Abs( cP ) < 1.e-2 );
+      cosPhi = ok[i] ? cosPhi : 1.f;
+      sinPhi = ok[i] ? sinPhi : 0.f;
+      cP = ok[i] ? cP : 1.f;
+
+      secPhi = 1./cosPhi;
+      float j0 = cP *secPhi;
+      float j2 = cosPhi / cP;
+      x =   fX[i]*cosAlpha +  fY[i]*sinAlpha ;
+      y =  -fX[i]*sinAlpha +  fY[i]*cosAlpha ;
+
+      c00 *= j0 * j0;
+      c40 *= j0;
+
+      c22 *= j2 * j2;
+      c42 *= j2;
+
+      const bool flip = cosPhi < 0.f; // rotate to 180'
+      cosPhi = flip ? -cosPhi : cosPhi;
+      secPhi = flip ? -secPhi : secPhi;
+      sinPhi = flip ? -sinPhi : sinPhi;
+      dzds = flip ? -dzds : dzds;
+      qpt = flip ? -qpt : qpt;
+      c20 = flip ? -c20 : c20;
+      c31 = flip ? -c31 : c31;
+      c40 = flip ? -c40 : c40;
+    }
+
+    float ex = cosPhi;
+    float ey = sinPhi;
+    float k  = qpt*Bz;
+    float dx = newX - x;
+    float ey1 = k*dx + ey;
+
+    ok[i] = ok[i] && !( fabs( ey1 ) > maxSinPhi );
+    ey1 = ok[i] ? ey1 : ey;
+
+    float ex1 = sqrt( 1.f - ey1 * ey1 );
+
+    float dxBz = dx * Bz;
+
+    float ss = ey + ey1;
+    float cc = ex + ex1;
+    float dxcci = dx / cc;
+    float norm2 = 1.f + ey*ey1 + ex*ex1;
+
+    float dy = dxcci * ss;
+
+    float dS;
+    {
+      float dl = dxcci * sqrt( norm2 + norm2 );
+      float dSin = 0.5f*k*dl;
+      float a = dSin*dSin;
+      const float k2 = 1.f/6.f;
+      const float k4 = 3.f/40.f;
+      dS = dl + dl*a*(k2 + a*(k4 ));
+    }
+
+    float ex1i = 1.f/ex1;
+    float dz = dS * dzds;
+
+    float hh = dxcci*ex1i*norm2;
+    float h2 = hh * secPhi;
+    float h4 = Bz*dxcci*hh;
+
+    float c20ph4c42 =  c20 + h4*c42;
+    float h2c22 = h2*c22;
+    float h4c44 = h4*c44;
+    float n7 = c31 + dS*c33;
+
+    fPar[0][i] = y + dy;
+    fPar[1][i] = z + dz;
+    fPar[2][i] = ey1;
+    fPar[3][i] = dzds;
+    fPar[4][i] = qpt;
+
+    fCov[0][i] = c00 + h2*h2c22 + h4*h4c44 + 2.f*( h2*c20ph4c42  + h4*c40 );
+    fCov[1][i] = c11 + dS*(c31 + n7);
+    fCov[2][i] = c22 + dxBz*( c42 + c42 + dxBz*c44 );
+    fCov[3][i] = c33;
+    fCov[4][i] = c44;
+    fCovD[0][i] = c20ph4c42 + h2c22  + dxBz*(c40 + h2*c42 + h4c44);
+    fCovD[1][i] = n7;
+  }
+  return StoreBorderTracks( ok, b, lane );
+}
+
+int AliHLTTPCGMSliceTrackBatch::StoreBorderTracks( const bool *ok, AliHLTTPCGMBorderTrack *b, int *lane ) const
+{
+  int n = 0;
+  for( int i=0; i<fN; i++ ){
+    if( !ok[i] ) continue;
+    AliHLTTPCGMBorderTrack &bt = b[n];
+    for( int j=0; j<5; j++ ) bt.SetPar( j, fPar[j][i] );
+    for( int j=0; j<5; j++ ) bt.SetCov( j, fCov[j][i] );
+    for( int j=0; j<2; j++ ) bt.SetCovD( j, fCovD[j][i] );
+    bt.SetZOffset( fZOffset[i] );
+    lane[n++] = i;
+  }
+  return n;
+}
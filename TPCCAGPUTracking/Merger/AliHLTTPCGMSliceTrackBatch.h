@@ -0,0 +1,59 @@
+//-*- Mode: C++ -*-
+// ************************************************************************
+// This file is property of and copyright by the ALICE HLT Project        *
+// ALICE Experiment at CERN, All rights reserved.                         *
+// See cxx source for full Copyright notice                               *
+//                                                                        *
+//*************************************************************************
+
+
+#ifndef ALIHLTTPCGMSLICETRACKBATCH_H
+#define ALIHLTTPCGMSLICETRACKBATCH_H
+
+class AliHLTTPCGMSliceTrack;
+class AliHLTTPCGMBorderTrack;
+class AliHLTTPCCAParam;
+
+/**
+ * @class AliHLTTPCGMSliceTrackBatch
+ *
+ * Structure of arrays of up to kLanes slice tracks, used by AliHLTTPCGMMerger to unpack and transport the slice tracks (host only).
+ * FilterErrors, TransportToX and TransportToXAlpha are the batched versions of the AliHLTTPCGMSliceTrack methods,
+ * written as branch-free loops over all lanes such that the compiler can vectorize them.
+ * Lanes that fail are masked instead of leaving the loop, unused lanes are copies of the last track.
+ * The scalar versions stay the reference (AliHLTTPCCAParam::SetMergerScalarSliceTracks). Without vectorization the results are identical,
+ * with -ffast-math the vectorized division and square root are approximations with one Newton step, so they can differ in the last bits.
+ */
+class AliHLTTPCGMSliceTrackBatch
+{
+ public:
+  enum { kLanes = 16 };
+
+  int N() const { return fN; }
+
+  // Gathers the parameters and covariances of n <= kLanes tracks
+  void Load( const AliHLTTPCGMSliceTrack *const *tracks, int n );
+  // Writes the parameters and covariances back to the tracks, after FilterErrors
+  void Store( AliHLTTPCGMSliceTrack *const *tracks ) const;
+
+  // Sets ok[i] for every lane i < N()
+  void FilterErrors( const AliHLTTPCCAParam &param, float maxSinPhi, float sinPhiMargin, bool *ok );
+
+  // Write the tracks, which could be transported, consecutively to b, with lane[j] the lane of b[j]. Return the number of tracks written
+  int TransportToX( float x, float Bz, AliHLTTPCGMBorderTrack *b, int *lane, float maxSinPhi );
+  int TransportToXAlpha( float x, float sinAlpha, float cosAlpha, float Bz, AliHLTTPCGMBorderTrack *b, int *lane, float maxSinPhi );
+
+ private:
+  int StoreBorderTracks( const bool *ok, AliHLTTPCGMBorderTrack *b, int *lane ) const;
+
+  int fN; // number of tracks
+  float fX[kLanes], fY[kLanes], fZ[kLanes], fSinPhi[kLanes], fDzDs[kLanes], fQPt[kLanes], fCosPhi[kLanes], fSecPhi[kLanes]; // parameters
+  float fZOffset[kLanes];
+  float fLastX[kLanes]; // X of the last cluster
+  float fC0[kLanes], fC2[kLanes], fC3[kLanes], fC5[kLanes], fC7[kLanes], fC9[kLanes], fC10[kLanes], fC12[kLanes], fC14[kLanes]; // covariances
+
+  // Output of the transport for StoreBorderTracks
+  float fPar[5][kLanes], fCov[5][kLanes], fCovD[2][kLanes];
+};
+
+#endif
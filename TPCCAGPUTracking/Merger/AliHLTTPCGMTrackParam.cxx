@@ -34,7 +34,9 @@
 #include "AliExternalTrackParam.h"
 #endif
 #include "AliHLTTPCCAParam.h"
-#include "AliHLTTPCCAClusterErrorStat.h"
+#if !defined(HLTCA_GPUCODE)
+#include "AliHLTTPCGMResidualCollector.h"
+#endif
 #ifdef HLTCA_CADEBUG_ENABLED
 #include "AliHLTTPCCAStandaloneFramework.h"
 #include "../cmodules/qconfig.h"
@@ -50,12 +52,14 @@ static constexpr float kRadLen = 29.532;//28.94;
 static constexpr float kDeg2Rad = M_PI / 180.f;
 static constexpr float kSectAngle = 2 * M_PI / 18.f;
 
-GPUd() bool AliHLTTPCGMTrackParam::Fit(const AliHLTTPCGMMerger* merger, int iTrk, AliHLTTPCGMMergedTrackHit* clusters, int &N, int &NTolerated, float &Alpha, int attempt, float maxSinPhi, AliHLTTPCCAOuterParam* outerParam)
+GPUd() bool AliHLTTPCGMTrackParam::Fit(const AliHLTTPCGMMerger* merger, int iTrk, AliHLTTPCGMMergedTrackHit* clusters, int &N, int &NTolerated, float &Alpha, int attempt, float maxSinPhi, AliHLTTPCCAOuterParam* outerParam, AliHLTTPCGMdEdx* dEdx, unsigned char* termination)
 {
   const AliHLTTPCCAParam &param = merger->SliceParam();
+  //Early termination policies for hopeless candidates, disabled if 0
+  const int maxNRejected = param.GetFitMaxNRejected();
+  const float maxChi2NDF = param.GetFitMaxChi2NDF();
+  unsigned char abortFit = kFitCompleted;
   
-  AliHLTTPCCAClusterErrorStat errorStat(N);
-
   AliHLTTPCGMPropagator prop;
   prop.SetMaterial( kRadLen, kRho );
   prop.SetPolynomialField( merger->pField() );
@@ -65,6 +69,9 @@ GPUd() bool AliHLTTPCGMTrackParam::Fit(const AliHLTTPCGMMerger* merger, int iTrk
 
   int nWays = param.GetNWays();
   int maxN = N;
+#if !defined(HLTCA_GPUCODE)
+  AliHLTTPCGMResidualCollector::ThreadData* residuals = nWays >= 3 && merger->ResidualCollector() ? merger->ResidualCollector()->StartTrack(maxN) : NULL;
+#endif
   int ihitStart = 0;
   float covYYUpd = 0.;
   float lastUpdateX = -1.;
@@ -214,7 +221,9 @@ GPUd() bool AliHLTTPCGMTrackParam::Fit(const AliHLTTPCGMMerger* merger, int iTrk
         continue;
       }
       CADEBUG(printf("\n");)
-      errorStat.Fill(xx, yy, zz, prop.GetAlpha(), fX, fP, fC, ihit, iWay);
+#if !defined(HLTCA_GPUCODE)
+      if (residuals) residuals->Predict(ihit, iWay, yy, zz, fP, fC);
+#endif
       
       int retVal;
       float threshold = 3. + (lastUpdateX >= 0 ? (fabs(fX - lastUpdateX) / 2) : 0.);
@@ -225,13 +234,23 @@ GPUd() bool AliHLTTPCGMTrackParam::Fit(const AliHLTTPCGMMerger* merger, int iTrk
 
       if (retVal == 0) // track is updated
       {
+#if !defined(HLTCA_GPUCODE)
+        if (residuals) residuals->Commit(clusters[ihit].fRow);
+#endif
         noFollowCircle2 = false;
         lastUpdateX = fX;
         covYYUpd = fC[0];
         nMissed = 0;
         UnmarkClusters(clusters, ihitMergeFirst, ihit, wayDirection, AliHLTTPCGMMergedTrackHit::flagNotFit);
         N++;
+        if (maxChi2NDF > 0.f && fNDF > 5 && fChi2 > maxChi2NDF * fNDF)
+        {
+          CADEBUG(printf("\tAbort fit, chi2 %f ndf %d\n", fChi2, fNDF);)
+          abortFit = kFitAbortChi2NDF;
+          break;
+        }
         ihitStart = ihit;
+        if (dEdx && iWay == nWays - 1 && !(clusterState & (AliHLTTPCGMMergedTrackHit::flagSplit | AliHLTTPCGMMergedTrackHit::flagEdge))) dEdx->Fill(clusters[ihit].fRow, clusters[ihit].fAmp, prop.GetSinPhi0(), fP[3]);
         float dy = fP[0] - prop.Model().Y();
         float dz = fP[1] - prop.Model().Z();
         if (AliHLTTPCCAMath::Abs(fP[4]) > 10 && --resetT0 <= 0 && AliHLTTPCCAMath::Abs(fP[2]) < 0.15 && dy*dy+dz*dz>1)
@@ -244,14 +263,27 @@ GPUd() bool AliHLTTPCGMTrackParam::Fit(const AliHLTTPCGMMerger* merger, int iTrk
       {
         if (rejectChi2) MarkClusters(clusters, ihitMergeFirst, ihit, wayDirection, AliHLTTPCGMMergedTrackHit::flagRejectDistance);
         nMissed++;
+        if (maxNRejected > 0 && nMissed >= maxNRejected)
+        {
+          CADEBUG(printf("\tAbort fit, %d clusters rejected\n", nMissed);)
+          abortFit = kFitAbortRejected;
+          break;
+        }
       }
       else break; // bad chi2 for the whole track, stop the fit
     }
+    if (abortFit)
+    {
+      if (termination) *termination = abortFit;
+      return(false);
+    }
     if (((nWays - iWay) & 1)) ShiftZ(merger->pField(), clusters, param, N);
   }
   ConstrainSinPhi();
   
-  bool ok = N + NTolerated >= TRACKLET_SELECTOR_MIN_HITS(fP[4]) && CheckNumericalQuality(covYYUpd);
+  const bool enoughClusters = N + NTolerated >= TRACKLET_SELECTOR_MIN_HITS(fP[4]);
+  bool ok = enoughClusters && CheckNumericalQuality(covYYUpd);
+  if (termination) *termination = ok ? kFitCompleted : enoughClusters ? kFitBadNumerics : kFitTooFewClusters;
   if (!ok) return(false);
   
   Alpha = prop.GetAlpha();
@@ -365,7 +397,9 @@ GPUd() void AliHLTTPCGMTrackParam::AttachClusters(const AliHLTTPCGMMerger* Merge
     MAKESharedRef(AliHLTTPCCARow, row, tracker.Row(iRow), s.fRows[iRow]);
 #ifndef HLTCA_GPU_TEXTURE_FETCH_CONSTRUCTOR
     GPUglobalref() const cahit2 *hits = tracker.HitData(row);
+#ifdef HLTCA_GPUCODE
     GPUglobalref() const calink *firsthit = tracker.FirstHitInBin(row);
+#endif
 #endif //!HLTCA_GPU_TEXTURE_FETCH_CONSTRUCTOR
     if (row.NHits() == 0) return;
     
@@ -382,8 +416,14 @@ GPUd() void AliHLTTPCGMTrackParam::AttachClusters(const AliHLTTPCGMMerger* Merge
     {
       int nBinsY = row.Grid().Ny();
       int mybin = bin + k * nBinsY;
+#ifdef HLTCA_GPUCODE
       unsigned int hitFst = TEXTUREFetchCons(calink, gAliTexRefu, firsthit, mybin);
       unsigned int hitLst = TEXTUREFetchCons(calink, gAliTexRefu, firsthit, mybin + ny + 1);
+#else
+      int binFst, binLst;
+      tracker.Data().FirstHitInBinRange(row, mybin, ny + 1, binFst, binLst); // the grid content can be sparse on the CPU
+      unsigned int hitFst = binFst, hitLst = binLst;
+#endif
       for ( unsigned int ih = hitFst; ih < hitLst; ih++ ) {
         assert( (signed) ih < row.NHits() );
         cahit2 hh = TEXTUREFetchCons(cahit2, gAliTexRefu2, hits, ih);
@@ -684,7 +724,11 @@ void AliHLTTPCGMTrackParam::SetExtParam( const AliExternalTrackParam &T )
 
 GPUd() void AliHLTTPCGMTrackParam::RefitTrack(AliHLTTPCGMMergedTrack &track, int iTrk, const AliHLTTPCGMMerger* merger, AliHLTTPCGMMergedTrackHit* clusters)
 {
-	if( !track.OK() ) return;
+	if( !track.OK() )
+	{
+		track.SetFitTermination(kFitSkipped);
+		return;
+	}
 
 	CADEBUG(cadebug_nTracks++;)
 	CADEBUG(if (DEBUG_SINGLE_TRACK >= 0 && cadebug_nTracks != DEBUG_SINGLE_TRACK) {track.SetNClusters(0);track.SetOK(0);return;})
@@ -697,14 +741,19 @@ GPUd() void AliHLTTPCGMTrackParam::RefitTrack(AliHLTTPCGMMergedTrack &track, int
 		AliHLTTPCGMTrackParam t = track.Param();
 		float Alpha = track.Alpha();  
 		CADEBUG(int nTrackHitsOld = nTrackHits; float ptOld = t.QPt();)
-		bool ok = t.Fit( merger, iTrk, clusters + track.FirstClusterRef(), nTrackHits, NTolerated, Alpha, attempt, HLTCA_MAX_SIN_PHI, &track.OuterParam() );
+		AliHLTTPCGMdEdx dEdx;
+		const bool computedEdx = merger->SliceParam().GetComputedEdx();
+		if (computedEdx) dEdx.Init();
+		unsigned char termination = kFitCompleted;
+		bool ok = t.Fit( merger, iTrk, clusters + track.FirstClusterRef(), nTrackHits, NTolerated, Alpha, attempt, HLTCA_MAX_SIN_PHI, &track.OuterParam(), computedEdx ? &dEdx : NULL, &termination );
+		const bool aborted = termination == kFitAbortRejected || termination == kFitAbortChi2NDF;
 		CADEBUG(printf("Finished Fit Track %d\n", cadebug_nTracks);)
 		
 		if ( fabs( t.QPt() ) < 1.e-4 ) t.QPt() = 1.e-4 ;
 
 		CADEBUG(printf("OUTPUT hits %d -> %d+%d = %d, QPt %f -> %f, SP %f, ok %d chi2 %f chi2ndf %f\n", nTrackHitsOld, nTrackHits, NTolerated, nTrackHits + NTolerated, ptOld, t.QPt(), t.SinPhi(), (int) ok, t.Chi2(), t.Chi2() / std::max(1,nTrackHits));)
 		
-		if (!ok && ++attempt < nAttempts)
+		if (!ok && !aborted && ++attempt < nAttempts) //Aborted candidates are hopeless, do not refit them
 		{
 			for (int i = 0;i < track.NClusters();i++) clusters[track.FirstClusterRef() + i].fState &= AliHLTTPCGMMergedTrackHit::hwcfFlags;
 			CADEBUG(printf("Track rejected, running refit\n");)
@@ -712,7 +761,9 @@ GPUd() void AliHLTTPCGMTrackParam::RefitTrack(AliHLTTPCGMMergedTrack &track, int
 		}
 		
 		track.SetOK(ok);
+		track.SetFitTermination(termination);
 		track.SetNClustersFitted( nTrackHits );
+		if (ok && computedEdx) dEdx.Compute(track.dEdxInfo());
 		track.Param() = t;
 		track.Alpha() = Alpha;
 		break;
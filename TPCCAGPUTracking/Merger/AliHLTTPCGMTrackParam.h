@@ -13,6 +13,7 @@
 
 #include "AliHLTTPCCAMath.h"
 #include "AliHLTTPCGMMergedTrackHit.h"
+#include "AliHLTTPCGMdEdx.h"
 
 class AliHLTTPCGMMerger;
 class AliHLTTPCGMBorderTrack;
@@ -41,6 +42,17 @@ public:
     float fC[15];
   };
 
+  enum FitTermination // Why the fit of a track ended, stored in AliHLTTPCGMMergedTrack
+  {
+    kFitCompleted = 0,  // all ways fitted, track accepted
+    kFitSkipped,        // track not fitted, not OK before the refit
+    kFitTooFewClusters, // too few clusters fitted
+    kFitBadNumerics,    // bad covariance or parameters after the fit
+    kFitAbortRejected,  // fit stopped early, too many consecutive rejected clusters (AliHLTTPCCAParam::GetFitMaxNRejected)
+    kFitAbortChi2NDF,   // fit stopped early, chi2/NDF above the limit (AliHLTTPCCAParam::GetFitMaxChi2NDF)
+    kNFitTerminations
+  };
+
   GPUd() float& X()      { return fX;    }
   GPUd() float& Y()      { return fP[0]; }
   GPUd() float& Z()      { return fP[1]; }
@@ -103,7 +115,7 @@ public:
   GPUd() bool CheckNumericalQuality(float overrideCovYY = -1.) const ;
   GPUd() bool CheckCov() const ;
 
-  GPUd() bool Fit(const AliHLTTPCGMMerger* merger, int iTrk, AliHLTTPCGMMergedTrackHit* clusters, int &N, int &NTolerated, float &Alpha, int attempt = 0, float maxSinPhi = HLTCA_MAX_SIN_PHI, AliHLTTPCCAOuterParam* outerParam = NULL);
+  GPUd() bool Fit(const AliHLTTPCGMMerger* merger, int iTrk, AliHLTTPCGMMergedTrackHit* clusters, int &N, int &NTolerated, float &Alpha, int attempt = 0, float maxSinPhi = HLTCA_MAX_SIN_PHI, AliHLTTPCCAOuterParam* outerParam = NULL, AliHLTTPCGMdEdx* dEdx = NULL, unsigned char* termination = NULL);
   GPUd() void MirrorTo(AliHLTTPCGMPropagator& prop, float toY, float toZ, bool inFlyDirection, const AliHLTTPCCAParam& param, unsigned char row, unsigned char clusterState, bool mirrorParameters);
   GPUd() int MergeDoubleRowClusters(int ihit, int wayDirection, AliHLTTPCGMMergedTrackHit* clusters, const AliHLTTPCCAParam &param, AliHLTTPCGMPropagator& prop, float& xx, float& yy, float& zz, int maxN, float clAlpha, unsigned char& clusterState, bool rejectChi2, int& nMissed);
   
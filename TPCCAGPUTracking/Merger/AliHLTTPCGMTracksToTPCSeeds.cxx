@@ -7,109 +7,208 @@
 #include "AliTPCtrackerSector.h"
 #include "TObjArray.h"
 #include "AliTPCclusterMI.h"
+#include <string.h>
 
-void AliHLTTPCGMTracksToTPCSeeds::CreateSeedsFromHLTTracks(TObjArray* seeds, AliTPCtracker* tpctracker)
+int AliHLTTPCGMTracksToTPCSeeds::GetSeedTracks(const AliHLTTPCGMMerger* merger, int* trackIds)
 {
-	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
-	if (merger == NULL) return;
-	seeds->Clear();
-	int index = 0;
+	//Indices of the merged tracks that become seeds, in output order
+	int nSeeds = 0;
 	for (int i = 0;i < merger->NOutputTracks();i++)
 	{
-		const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[i];
-		if (!track.OK()) continue;
-		
-	
-		AliTPCtrack tr;
-		tr.Set(track.GetParam().GetX(), track.GetAlpha(), track.GetParam().GetPar(), track.GetParam().GetCov());
-		AliTPCseed* seed = new(tpctracker->NextFreeSeed()) AliTPCseed(tr);
+		if (!merger->OutputTracks()[i].OK()) continue;
+		if (trackIds) trackIds[nSeeds] = i;
+		nSeeds++;
+	}
+	return nSeeds;
+}
+
+int AliHLTTPCGMTracksToTPCSeeds::NSeeds()
+{
+	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
+	if (merger == NULL) return 0;
+	return GetSeedTracks(merger, NULL);
+}
+
+int AliHLTTPCGMTracksToTPCSeeds::CreateSeeds(AliHLTTPCGMTPCSeed* seeds, int maxSeeds, AliTPCtracker* tpctracker)
+{
+	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
+	if (merger == NULL) return 0;
+	int* trackIds = new int[merger->NOutputTracks()];
+	const int nSeeds = GetSeedTracks(merger, trackIds);
+	if (nSeeds > maxSeeds)
+	{
+		printf("Insufficient memory for offline seeds (%d < %d)\n", maxSeeds, nSeeds);
+		delete[] trackIds;
+		return -1;
+	}
+
+#pragma omp parallel for schedule(dynamic, 16)
+	for (int iSeed = 0;iSeed < nSeeds;iSeed++)
+	{
+		AliHLTTPCGMTPCSeed& seed = seeds[iSeed];
+		const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[trackIds[iSeed]];
+		seed.fTrack = trackIds[iSeed];
+		seed.fX = track.GetParam().GetX();
+		seed.fAlpha = track.GetAlpha();
+		memcpy(seed.fP, track.GetParam().GetPar(), 5 * sizeof(float));
+		memcpy(seed.fC, track.GetParam().GetCov(), 15 * sizeof(float));
+		seed.fChi2 = track.GetParam().GetChi2();
 		for (int j = 0;j < HLTCA_ROW_COUNT;j++)
 		{
-			seed->SetClusterPointer(j, NULL);
-			seed->SetClusterIndex(j, -1);
+			seed.fClusterPointer[j] = NULL;
+			seed.fClusterIndex[j] = -1;
 		}
+
 		int ncls = 0;
 		int lastrow = -1;
 		int lastleg = -1;
 		for (int j = track.NClusters() - 1;j >= 0;j--)
 		{
-			AliHLTTPCGMMergedTrackHit& cls = merger->Clusters()[track.FirstClusterRef() + j];
+			const AliHLTTPCGMMergedTrackHit& cls = merger->Clusters()[track.FirstClusterRef() + j];
 			if (cls.fState & AliHLTTPCGMMergedTrackHit::flagReject) continue;
 			if (lastrow != -1 && (cls.fRow < lastrow || cls.fLeg != lastleg)) break;
 			if (cls.fRow == lastrow) continue;
-			
+
 			AliTPCtrackerRow& row = tpctracker->GetRow(cls.fSlice % 18, cls.fRow);
 			unsigned int clIndexOffline = 0;
-			AliTPCclusterMI* clOffline = row.FindNearest2(cls.fY, cls.fZ, 0.01f, 0.01f, clIndexOffline); 
+			AliTPCclusterMI* clOffline = row.FindNearest2(cls.fY, cls.fZ, 0.01f, 0.01f, clIndexOffline);
 			if (!clOffline) continue;
-			clIndexOffline = row.GetIndex(clIndexOffline);
-			
-			clOffline->Use(10);
-			seed->SetClusterPointer(cls.fRow, clOffline);
-			seed->SetClusterIndex2(cls.fRow, clIndexOffline);
-			
+
+			seed.fClusterPointer[cls.fRow] = clOffline;
+			seed.fClusterIndex[cls.fRow] = row.GetIndex(clIndexOffline);
+
 			lastrow = cls.fRow;
 			lastleg = cls.fLeg;
 			ncls++;
 		}
-		
-		seed->SetRelativeSector(track.GetAlpha() / (M_PI / 9.f));
-		seed->SetNumberOfClusters(ncls);
-		seed->SetNFoundable(ncls);
-		seed->SetChi2(track.GetParam().GetChi2());
-
-		float alpha = seed->GetAlpha();
-		if (alpha >= 2 * M_PI) alpha -= 2. * M_PI;
-		if (alpha < 0) alpha += 2. * M_PI;
-		seed->SetRelativeSector(track.GetAlpha() / (M_PI / 9.f));
-
-		seed->SetPoolID(tpctracker->GetLastSeedId());
-		seed->SetIsSeeding(kTRUE);
-		seed->SetSeed1(HLTCA_ROW_COUNT - 1);
-		seed->SetSeed2(HLTCA_ROW_COUNT - 2);
-		seed->SetSeedType(0);
-		seed->SetFirstPoint(-1);
-		seed->SetLastPoint(-1);
-		seeds->AddLast(seed); // note, track is seed, don't free the seed
-		index++;
+		seed.fNClusters = ncls;
 	}
+
+	delete[] trackIds;
+	return nSeeds;
 }
 
-void AliHLTTPCGMTracksToTPCSeeds::UpdateParamsOuter(TObjArray* seeds)
+void AliHLTTPCGMTracksToTPCSeeds::UpdateSeedsOuter(AliHLTTPCGMTPCSeed* seeds, int nSeeds)
 {
 	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
 	if (merger == NULL) return;
-	int index = 0;
-	for (int i = 0;i < merger->NOutputTracks();i++)
+#pragma omp parallel for
+	for (int iSeed = 0;iSeed < nSeeds;iSeed++)
+	{
+		AliHLTTPCGMTPCSeed& seed = seeds[iSeed];
+		const AliHLTTPCGMTrackParam::AliHLTTPCCAOuterParam& param = merger->OutputTracks()[seed.fTrack].OuterParam();
+		seed.fX = param.fX;
+		seed.fAlpha = param.fAlpha;
+		memcpy(seed.fP, param.fP, 5 * sizeof(float));
+		memcpy(seed.fC, param.fC, 15 * sizeof(float));
+	}
+}
+
+void AliHLTTPCGMTracksToTPCSeeds::UpdateSeedsInner(AliHLTTPCGMTPCSeed* seeds, int nSeeds)
+{
+	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
+	if (merger == NULL) return;
+#pragma omp parallel for
+	for (int iSeed = 0;iSeed < nSeeds;iSeed++)
 	{
-		const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[i];
-		if (!track.OK()) continue;
-		if (index > seeds->GetEntriesFast())
+		AliHLTTPCGMTPCSeed& seed = seeds[iSeed];
+		const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[seed.fTrack];
+		seed.fX = track.GetParam().GetX();
+		seed.fAlpha = track.GetAlpha();
+		memcpy(seed.fP, track.GetParam().GetPar(), 5 * sizeof(float));
+		memcpy(seed.fC, track.GetParam().GetCov(), 15 * sizeof(float));
+	}
+}
+
+AliTPCseed* AliHLTTPCGMTracksToTPCSeeds::CreateTPCseed(const AliHLTTPCGMTPCSeed& hltSeed, AliTPCtracker* tpctracker)
+{
+	AliTPCtrack tr;
+	tr.Set(hltSeed.fX, hltSeed.fAlpha, hltSeed.fP, hltSeed.fC);
+	AliTPCseed* seed = new(tpctracker->NextFreeSeed()) AliTPCseed(tr);
+	for (int j = 0;j < HLTCA_ROW_COUNT;j++)
+	{
+		AliTPCclusterMI* clOffline = hltSeed.fClusterPointer[j];
+		seed->SetClusterPointer(j, clOffline);
+		if (clOffline)
 		{
-			printf("Invalid number of offline seeds\n");
-			return;
+			clOffline->Use(10);
+			seed->SetClusterIndex2(j, hltSeed.fClusterIndex[j]);
+		}
+		else
+		{
+			seed->SetClusterIndex(j, -1);
 		}
-		AliTPCseed* seed = (AliTPCseed*) seeds->UncheckedAt(index++);
-		const AliHLTTPCGMTrackParam::AliHLTTPCGMTrackParam::AliHLTTPCCAOuterParam& param = track.OuterParam();
+	}
+
+	seed->SetNumberOfClusters(hltSeed.fNClusters);
+	seed->SetNFoundable(hltSeed.fNClusters);
+	seed->SetChi2(hltSeed.fChi2);
+	seed->SetRelativeSector(hltSeed.fAlpha / (M_PI / 9.f));
+
+	seed->SetPoolID(tpctracker->GetLastSeedId());
+	seed->SetIsSeeding(kTRUE);
+	seed->SetSeed1(HLTCA_ROW_COUNT - 1);
+	seed->SetSeed2(HLTCA_ROW_COUNT - 2);
+	seed->SetSeedType(0);
+	seed->SetFirstPoint(-1);
+	seed->SetLastPoint(-1);
+	return seed;
+}
+
+void AliHLTTPCGMTracksToTPCSeeds::CreateSeedsFromHLTTracks(TObjArray* seeds, AliTPCtracker* tpctracker)
+{
+	seeds->Clear();
+	const int maxSeeds = NSeeds();
+	if (maxSeeds == 0) return;
+	AliHLTTPCGMTPCSeed* hltSeeds = new AliHLTTPCGMTPCSeed[maxSeeds];
+	const int nSeeds = CreateSeeds(hltSeeds, maxSeeds, tpctracker);
+	for (int i = 0;i < nSeeds;i++)
+	{
+		seeds->AddLast(CreateTPCseed(hltSeeds[i], tpctracker)); // note, track is seed, don't free the seed
+	}
+	delete[] hltSeeds;
+}
+
+void AliHLTTPCGMTracksToTPCSeeds::UpdateParamsOuter(TObjArray* seeds)
+{
+	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
+	if (merger == NULL) return;
+	int* trackIds = new int[merger->NOutputTracks()];
+	const int nSeeds = GetSeedTracks(merger, trackIds);
+	if (nSeeds > seeds->GetEntriesFast())
+	{
+		printf("Invalid number of offline seeds\n");
+		delete[] trackIds;
+		return;
+	}
+#pragma omp parallel for
+	for (int i = 0;i < nSeeds;i++)
+	{
+		AliTPCseed* seed = (AliTPCseed*) seeds->UncheckedAt(i);
+		const AliHLTTPCGMTrackParam::AliHLTTPCCAOuterParam& param = merger->OutputTracks()[trackIds[i]].OuterParam();
 		seed->Set(param.fX, param.fAlpha, param.fP, param.fC);
 	}
+	delete[] trackIds;
 }
 
 void AliHLTTPCGMTracksToTPCSeeds::UpdateParamsInner(TObjArray* seeds)
 {
 	const AliHLTTPCGMMerger* merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
 	if (merger == NULL) return;
-	int index = 0;
-	for (int i = 0;i < merger->NOutputTracks();i++)
+	int* trackIds = new int[merger->NOutputTracks()];
+	const int nSeeds = GetSeedTracks(merger, trackIds);
+	if (nSeeds > seeds->GetEntriesFast())
 	{
-		const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[i];
-		if (!track.OK()) continue;
-		if (index > seeds->GetEntriesFast())
-		{
-			printf("Invalid number of offline seeds\n");
-			return;
-		}
-		AliTPCseed* seed = (AliTPCseed*) seeds->UncheckedAt(index++);
+		printf("Invalid number of offline seeds\n");
+		delete[] trackIds;
+		return;
+	}
+#pragma omp parallel for
+	for (int i = 0;i < nSeeds;i++)
+	{
+		AliTPCseed* seed = (AliTPCseed*) seeds->UncheckedAt(i);
+		const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[trackIds[i]];
 		seed->Set(track.GetParam().GetX(), track.GetAlpha(), track.GetParam().GetPar(), track.GetParam().GetCov());
 	}
+	delete[] trackIds;
 }
@@ -1,15 +1,46 @@
 #ifndef ALIHLTTPCGMTRACKSTOTPCSEEDS_H
 #define ALIHLTTPCGMTRACKSTOTPCSEEDS_H
 
+#include "AliHLTTPCCASettings.h"
+
 class TObjArray;
 class AliTPCtracker;
+class AliTPCseed;
+class AliTPCclusterMI;
+class AliHLTTPCGMMerger;
+
+//Plain seed record for the offline TPC refit, filled in bulk from the merged tracks
+struct AliHLTTPCGMTPCSeed
+{
+	float fX, fAlpha;
+	float fP[5];
+	float fC[15];
+	float fChi2;
+	int fTrack;										//Index of the merged track
+	int fNClusters;									//Number of rows with an offline cluster attached
+	int fClusterIndex[HLTCA_ROW_COUNT];				//Offline cluster index per row, -1 if none
+	AliTPCclusterMI* fClusterPointer[HLTCA_ROW_COUNT];	//Offline cluster per row, NULL if none
+};
 
 class AliHLTTPCGMTracksToTPCSeeds
 {
 public:
+	//Bulk export into a preallocated array, filled in parallel over the tracks, no ROOT objects are created
+	static int NSeeds();
+	static int CreateSeeds(AliHLTTPCGMTPCSeed* seeds, int maxSeeds, AliTPCtracker* tpctracker);
+	static void UpdateSeedsOuter(AliHLTTPCGMTPCSeed* seeds, int nSeeds);
+	static void UpdateSeedsInner(AliHLTTPCGMTPCSeed* seeds, int nSeeds);
+
+	//Adapter creating an AliTPCseed in the seed pool of the offline tracker, marks its clusters as used
+	static AliTPCseed* CreateTPCseed(const AliHLTTPCGMTPCSeed& seed, AliTPCtracker* tpctracker);
+
+	//TObjArray interface of the offline tracker, based on the bulk export
 	static void CreateSeedsFromHLTTracks(TObjArray* seeds, AliTPCtracker* tpctracker);
 	static void UpdateParamsOuter(TObjArray* seeds);
 	static void UpdateParamsInner(TObjArray* seeds);
+
+private:
+	static int GetSeedTracks(const AliHLTTPCGMMerger* merger, int* trackIds);
 };
 
 #endif
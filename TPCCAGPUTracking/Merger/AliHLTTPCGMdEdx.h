@@ -0,0 +1,98 @@
+//-*- Mode: C++ -*-
+// ************************************************************************
+// This file is property of and copyright by the ALICE HLT Project        *
+// ALICE Experiment at CERN, All rights reserved.                         *
+// See cxx source for full Copyright notice                               *
+//                                                                        *
+//*************************************************************************
+
+
+#ifndef ALIHLTTPCGMDEDX_H
+#define ALIHLTTPCGMDEDX_H
+
+#include "AliHLTTPCCADef.h"
+#include "AliHLTTPCCASettings.h"
+#include "AliHLTTPCCAMath.h"
+
+/**
+ * @struct AliHLTTPCGMMergedTrackdEdx
+ *
+ * Truncated mean dE/dx of a merged track, separately for the inner and the outer readout chambers
+ */
+struct AliHLTTPCGMMergedTrackdEdx
+{
+  float fdEdxIROC;            //* truncated mean of the path-length corrected cluster charge, IROC
+  float fdEdxOROC;            //* same for OROC
+  unsigned char fNClsIROC;    //* number of clusters used, IROC
+  unsigned char fNClsOROC;    //* number of clusters used, OROC
+};
+
+/**
+ * @class AliHLTTPCGMdEdx
+ *
+ * Accumulates the cluster charges during the last pass of AliHLTTPCGMTrackParam::Fit,
+ * and computes the truncated mean per readout region with a partial selection (no full sort).
+ * IROC charges are stored from the front, OROC charges from the back of one fixed-size buffer.
+ */
+class AliHLTTPCGMdEdx
+{
+ public:
+  GPUd() void Init() { fNIROC = 0; fNOROC = 0; }
+
+  GPUd() void Fill( int row, float amp, float sinPhi, float dzds )
+  {
+    if( fNIROC + fNOROC >= HLTCA_ROW_COUNT ) return;
+    const float cosPhi2 = CAMath::Max( 1.f - sinPhi * sinPhi, 1.e-4f );
+    const float q = amp * CAMath::Sqrt( cosPhi2 / ( 1.f + dzds * dzds ) ); // charge per unit path length in the pad row
+    if( row < HLTCA_GM_DEDX_IROC_ROWS ) fCharges[fNIROC++] = q;
+    else fCharges[HLTCA_ROW_COUNT - 1 - fNOROC++] = q;
+  }
+
+  GPUd() void Compute( AliHLTTPCGMMergedTrackdEdx &v )
+  {
+    v.fdEdxIROC = TruncatedMean( fCharges, fNIROC, v.fNClsIROC );
+    v.fdEdxOROC = TruncatedMean( fCharges + HLTCA_ROW_COUNT - fNOROC, fNOROC, v.fNClsOROC );
+  }
+
+ private:
+  GPUd() static float TruncatedMean( float *q, int n, unsigned char &nUsed )
+  {
+    const int kLow = (int) ( n * HLTCA_GM_DEDX_TRUNC_LOW );
+    const int kHigh = (int) ( n * HLTCA_GM_DEDX_TRUNC_HIGH );
+    nUsed = 0;
+    if( kHigh <= kLow ) return 0.f;
+    if( kHigh < n ) Select( q, n, kHigh );  // q[0 .. kHigh-1] are now the kHigh smallest charges
+    if( kLow > 0 ) Select( q, kHigh, kLow );
+    float sum = 0.f;
+    for( int i = kLow; i < kHigh; i++ ) sum += q[i];
+    nUsed = (unsigned char) CAMath::Min( kHigh - kLow, 255 );
+    return sum / ( kHigh - kLow );
+  }
+
+  GPUd() static void Select( float *a, int n, int k )
+  {
+    // Partial selection (Wirth): afterwards a[i] <= a[k] for i < k and a[i] >= a[k] for i > k
+    int l = 0, r = n - 1;
+    while( l < r ){
+      const float x = a[k];
+      int i = l, j = r;
+      do{
+        while( a[i] < x ) i++;
+        while( x < a[j] ) j--;
+        if( i <= j ){
+          const float tmp = a[i]; a[i] = a[j]; a[j] = tmp;
+          i++;
+          j--;
+        }
+      } while( i <= j );
+      if( j < k ) l = i;
+      if( k < i ) r = j;
+    }
+  }
+
+  int fNIROC;                      // number of IROC charges
+  int fNOROC;                      // number of OROC charges
+  float fCharges[HLTCA_ROW_COUNT]; // charges: IROC from the front, OROC from the back
+};
+
+#endif
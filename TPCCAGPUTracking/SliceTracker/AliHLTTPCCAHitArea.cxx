@@ -47,8 +47,7 @@ MEM_TEMPLATE() GPUdi() void AliHLTTPCCAHitArea::Init( const MEM_TYPE( AliHLTTPCC
   fHitYfst = tex1Dfetch(gAliTexRefu, ((char*) slice.FirstHitInBin(row) - slice.GPUTextureBaseConst()) / sizeof(calink) + fIndYmin);
   fHitYlst = tex1Dfetch(gAliTexRefu, ((char*) slice.FirstHitInBin(row) - slice.GPUTextureBaseConst()) / sizeof(calink) + fIndYmin + fBDY);
 #else
-  fHitYfst = slice.FirstHitInBin( row, fIndYmin ); // first and
-  fHitYlst = slice.FirstHitInBin( row, fIndYmin + fBDY ); // last hit index in the bin
+  slice.FirstHitInBinRange( row, fIndYmin, fBDY, fHitYfst, fHitYlst ); // first and last hit index in the bins
 #endif //HLTCA_GPU_TEXTURE_FETCH_NEIGHBORS
   fIh = fHitYfst;
 }
@@ -79,8 +78,7 @@ MEM_TEMPLATE() GPUdi() int AliHLTTPCCAHitArea::GetNext( GPUconstant() const MEM_
 	  fHitYfst = tex1Dfetch(gAliTexRefu, ((char*) slice.FirstHitInBin(row) - slice.GPUTextureBaseConst()) / sizeof(calink) + fIndYmin);
 	  fHitYlst = tex1Dfetch(gAliTexRefu, ((char*) slice.FirstHitInBin(row) - slice.GPUTextureBaseConst()) / sizeof(calink) + fIndYmin + fBDY);
 #else
-      fHitYfst = slice.FirstHitInBin( row, fIndYmin );
-      fHitYlst = slice.FirstHitInBin( row, fIndYmin + fBDY );
+      slice.FirstHitInBinRange( row, fIndYmin, fBDY, fHitYfst, fHitYlst );
 #endif
       fIh = fHitYfst;
     }
@@ -55,6 +55,7 @@ class AliHLTTPCCAMath
     GPUd()  static int AtomicMinShared (register GPUsharedref() int *addr, int val );
     GPUd()  static int Mul24( int a, int b );
     GPUd()  static float FMulRZ( float a, float b );
+    GPUhd() static unsigned int Popcount( unsigned int x );
 };
 
 typedef AliHLTTPCCAMath CAMath;
@@ -176,6 +177,17 @@ GPUhd() inline float AliHLTTPCCAMath::ASin( float x )
   return choiceA( asinf( x ), asin( x ) );
 }
 
+GPUhd() inline unsigned int AliHLTTPCCAMath::Popcount( unsigned int x )
+{
+#if defined( HLTCA_GPUCODE ) && defined( __CUDACC__ )
+  return __popc( x );
+#elif defined( HLTCA_GPUCODE ) && defined( __OPENCL__ )
+  return popcount( x );
+#else
+  return __builtin_popcount( x );
+#endif
+}
+
 GPUhd() inline float AliHLTTPCCAMath::Log(float x)
 {
 	return choice( log(x), log(x) );
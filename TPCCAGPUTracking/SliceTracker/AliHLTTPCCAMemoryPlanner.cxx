@@ -0,0 +1,96 @@
+// **************************************************************************
+// This file is property of and copyright by the ALICE HLT Project          *
+// ALICE Experiment at CERN, All rights reserved.                           *
+//                                                                          *
+// Permission to use, copy, modify and distribute this software and its     *
+// documentation strictly for non-commercial purposes is hereby granted     *
+// without fee, provided that the above copyright notice appears in all     *
+// copies and that both the copyright notice and this permission notice     *
+// appear in the supporting documentation. The authors make no claims       *
+// about the suitability of this software for any purpose. It is            *
+// provided "as is" without express or implied warranty.                    *
+//                                                                          *
+//***************************************************************************
+
+#include "AliHLTTPCCAMemoryPlanner.h"
+#include <cstdio>
+
+static inline size_t AlignOffset( size_t offset, size_t alignment )
+{
+  return ( offset + alignment - 1 ) / alignment * alignment;
+}
+
+int AliHLTTPCCAMemoryPlanner::Register( const char *name, size_t size, size_t alignment, int firstStage, int lastStage )
+{
+  Buffer b;
+  b.fName = name;
+  b.fSize = size;
+  b.fAlignment = alignment;
+  b.fFirstStage = firstStage;
+  b.fLastStage = lastStage;
+  b.fOffset = 0;
+  fBuffers.push_back( b );
+  return fBuffers.size() - 1;
+}
+
+size_t AliHLTTPCCAMemoryPlanner::Plan()
+{
+  // Greedy placement, largest buffer first (ties in registration order, so the layout is reproducible):
+  // every buffer goes to the lowest offset at which it does not collide with an already placed buffer of overlapping lifetime.
+  // Candidate offsets are 0 and the ends of the placed buffers.
+  const int n = fBuffers.size();
+  std::vector<int> order( n ), placed;
+  for ( int i = 0; i < n; i++ ) order[i] = i;
+  for ( int i = 1; i < n; i++ ) { // insertion sort, stable
+    const int id = order[i];
+    int j = i;
+    for ( ; j > 0 && fBuffers[order[j - 1]].fSize < fBuffers[id].fSize; j-- ) order[j] = order[j - 1];
+    order[j] = id;
+  }
+
+  fSize = 0;
+  for ( int i = 0; i < n; i++ ) {
+    Buffer &b = fBuffers[order[i]];
+    size_t best = (size_t) -1;
+    for ( int k = -1; k < (int) placed.size(); k++ ) {
+      const size_t candidate = AlignOffset( k == -1 ? 0 : fBuffers[placed[k]].fOffset + fBuffers[placed[k]].fSize, b.fAlignment );
+      if ( candidate >= best ) continue;
+      bool collides = false;
+      for ( unsigned int l = 0; l < placed.size() && !collides; l++ ) {
+        const Buffer &p = fBuffers[placed[l]];
+        const bool lifetimeOverlap = b.fFirstStage <= p.fLastStage && p.fFirstStage <= b.fLastStage;
+        collides = lifetimeOverlap && candidate < p.fOffset + p.fSize && p.fOffset < candidate + b.fSize;
+      }
+      if ( !collides ) best = candidate;
+    }
+    b.fOffset = best;
+    placed.push_back( order[i] );
+    if ( b.fOffset + b.fSize > fSize ) fSize = b.fOffset + b.fSize;
+  }
+
+  // The greedy placement may lose more to alignment gaps than it gains by sharing, keep the sequential layout then
+  if ( UnaliasedSize() <= fSize ) {
+    fSize = 0;
+    for ( int i = 0; i < n; i++ ) {
+      fBuffers[i].fOffset = AlignOffset( fSize, fBuffers[i].fAlignment );
+      fSize = fBuffers[i].fOffset + fBuffers[i].fSize;
+    }
+  }
+  return fSize;
+}
+
+size_t AliHLTTPCCAMemoryPlanner::UnaliasedSize() const
+{
+  size_t size = 0;
+  for ( unsigned int i = 0; i < fBuffers.size(); i++ ) size = AlignOffset( size, fBuffers[i].fAlignment ) + fBuffers[i].fSize;
+  return size;
+}
+
+void AliHLTTPCCAMemoryPlanner::Print( const char *title ) const
+{
+  printf( "%s: %lld bytes (without aliasing %lld bytes)\n", title, (long long int) fSize, (long long int) UnaliasedSize() );
+  for ( unsigned int i = 0; i < fBuffers.size(); i++ ) {
+    const Buffer &b = fBuffers[i];
+    printf( "\t%-20s offset %10lld size %10lld stages %d - %d\n", b.fName, (long long int) b.fOffset, (long long int) b.fSize, b.fFirstStage, b.fLastStage );
+  }
+}
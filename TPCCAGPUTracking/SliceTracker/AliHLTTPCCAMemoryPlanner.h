@@ -0,0 +1,67 @@
+//-*- Mode: C++ -*-
+// ************************************************************************
+// This file is property of and copyright by the ALICE HLT Project        *
+// ALICE Experiment at CERN, All rights reserved.                         *
+// See cxx source for full Copyright notice                               *
+//                                                                        *
+//*************************************************************************
+
+
+#ifndef ALIHLTTPCCAMEMORYPLANNER_H
+#define ALIHLTTPCCAMEMORYPLANNER_H
+
+#include "AliHLTTPCCADef.h"
+#include "AliHLTTPCCAGPUConfig.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class AliHLTTPCCAMemoryPlanner
+ *
+ * Layout of several buffers in one memory block, host only.
+ * Every buffer is registered with its size and its lifetime, the first and the last processing stage that uses it.
+ * Plan() assigns the offsets: buffers whose lifetimes do not overlap may share memory,
+ * so the block only needs the peak of the live buffers instead of the sum of all buffers.
+ * If sharing does not make the block smaller, the buffers are laid out sequentially in registration order.
+ * The alignment of a buffer is the same as with AssignMemory( T*&, char*&, count ), the block itself must be aligned to 16 bytes (new uint4[]).
+ */
+class AliHLTTPCCAMemoryPlanner
+{
+ public:
+  AliHLTTPCCAMemoryPlanner() : fBuffers(), fSize( 0 ) {}
+
+  void Reset() { fBuffers.clear(); fSize = 0; }
+
+  // Registers count elements of type T, used from stage firstStage to stage lastStage (inclusive), returns the buffer id
+  template <class T> int Register( const char *name, size_t count, int firstStage, int lastStage )
+  {
+    const size_t alignment = ( sizeof( T ) & ( sizeof( T ) - 1 ) ) == 0 && sizeof( T ) <= 16 ? sizeof( T ) : sizeof( void * );
+    return Register( name, count * sizeof( T ), alignment < sizeof( HLTCA_GPU_ROWALIGNMENT ) ? sizeof( HLTCA_GPU_ROWALIGNMENT ) : alignment, firstStage, lastStage );
+  }
+  int Register( const char *name, size_t size, size_t alignment, int firstStage, int lastStage );
+
+  // Computes the offsets of all buffers, returns the size of the memory block
+  size_t Plan();
+
+  template <class T> void Assign( T *&dst, char *base, int id ) const { dst = reinterpret_cast<T *>( base + fBuffers[id].fOffset ); }
+
+  size_t Size() const { return fSize; }
+  size_t UnaliasedSize() const; // Size of the block if no buffers shared memory
+  void Print( const char *title ) const;
+
+ private:
+  struct Buffer
+  {
+    const char *fName;
+    size_t fSize;      // size [bytes]
+    size_t fAlignment;
+    int fFirstStage;   // lifetime
+    int fLastStage;
+    size_t fOffset;    // offset in the memory block, set by Plan
+  };
+
+  std::vector<Buffer> fBuffers;
+  size_t fSize; // size of the memory block
+};
+
+#endif //ALIHLTTPCCAMEMORYPLANNER_H
@@ -88,7 +88,15 @@ MEM_CLASS_PRE() class AliHLTTPCCAParam
     GPUd() int GetNWaysOuter() const { return fNWaysOuter; }
     GPUd() float GetSearchWindowDZDR() const { return fSearchWindowDZDR; }
     GPUd() bool GetContinuousTracking() const { return fContinuousTracking; }
+    GPUd() bool GetDeterministicOutput() const { return fDeterministicOutput; }
+    GPUd() bool GetMergeLoopers() const { return fMergeLoopers; }
+    GPUd() bool GetComputedEdx() const { return fComputedEdx; }
+    GPUd() bool GetMergerScalarSliceTracks() const { return fMergerScalarSliceTracks; }
+    GPUd() int GetTrackingPasses() const { return fTrackingPasses; }
+    GPUd() bool GetSparseRowGrid() const { return fSparseRowGrid; }
     GPUd() float GetTrackReferenceX() const { return fTrackReferenceX;}
+    GPUd() int GetFitMaxNRejected() const { return fFitMaxNRejected; }
+    GPUd() float GetFitMaxChi2NDF() const { return fFitMaxChi2NDF; }
 
     GPUhd() void SetISlice( int v ) {  fISlice = v;}
     GPUhd() void SetNRows( int v ) {  fNRows = v;}
@@ -123,7 +131,15 @@ MEM_CLASS_PRE() class AliHLTTPCCAParam
     GPUd() void SetNWaysOuter( bool v ){ fNWaysOuter = v; }
     GPUd() void SetSearchWindowDZDR( float v ){ fSearchWindowDZDR = v; }
     GPUd() void SetContinuousTracking( bool v ){ fContinuousTracking = v; }
+    GPUd() void SetDeterministicOutput( bool v ){ fDeterministicOutput = v; }
+    GPUd() void SetMergeLoopers( bool v ){ fMergeLoopers = v; }
+    GPUd() void SetComputedEdx( bool v ){ fComputedEdx = v; }
+    GPUd() void SetMergerScalarSliceTracks( bool v ){ fMergerScalarSliceTracks = v; }
+    GPUd() void SetTrackingPasses( int v ){ fTrackingPasses = v; }
+    GPUd() void SetSparseRowGrid( bool v ){ fSparseRowGrid = v; }
     GPUd() void SetTrackReferenceX( float v) { fTrackReferenceX = v; }
+    GPUd() void SetFitMaxNRejected( int v ) { fFitMaxNRejected = v; }
+    GPUd() void SetFitMaxChi2NDF( float v ) { fFitMaxChi2NDF = v; }
 
     GPUd() float GetClusterRMS( int yz, int type, float z, float angle2 ) const;
     GPUd() void GetClusterRMS2( int row, float z, float sinPhi, float DzDs, float &ErrY2, float &ErrZ2 ) const;
@@ -183,8 +199,16 @@ MEM_CLASS_PRE() class AliHLTTPCCAParam
     char fAssumeConstantBz; //Assume a constant magnetic field
     char fToyMCEventsFlag; //events were build with home-made event generator
     char fContinuousTracking; //Continuous tracking, estimate bz and errors for abs(z) = 125cm during seeding
+    char fDeterministicOutput; //Bring slice tracks and merger inputs into a canonical order, independent of thread scheduling
+    char fMergeLoopers; //Link the legs of low-pt loopers in the merger and refit only one leg
+    char fComputedEdx; //Compute truncated mean dE/dx during the final pass of the merger refit
+    char fMergerScalarSliceTracks; //Unpack and transport the slice tracks in the merger one by one instead of in batches (reference for validation)
+    int fTrackingPasses; //Number of slice tracking passes, further passes use looser cuts on the hits not attached to good tracks of the previous passes (CPU only)
+    char fSparseRowGrid; //Store only the occupied bins of the row grids, with occupancy bitmaps and ranks (CPU only)
     float fSearchWindowDZDR; //Use DZDR window for seeding instead of vertex window
     float fTrackReferenceX; //Transport all tracks to this X after tracking (disabled if > 500)
+    int fFitMaxNRejected; //Stop the merger refit of a track after this number of consecutive rejected clusters (disabled if 0)
+    float fFitMaxChi2NDF; //Stop the merger refit of a track if chi2/NDF exceeds this value (disabled if 0)
 
     float fRowX[HLTCA_ROW_COUNT];// X-coordinate of rows    
     float fParamRMS0[2][3][4]; // cluster shape parameterization coeficients 
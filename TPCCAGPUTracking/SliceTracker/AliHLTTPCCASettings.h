@@ -15,6 +15,7 @@
 #define MERGE_CE_ROWLIMIT 15						////Distance from first / last row in order to attempt merging accross CE
 
 #define MERGE_LOOPER_QPT_LIMIT 4					//Min Q/Pt to run special looper merging procedure
+#define MERGE_LOOPER_MAX_TURNS 4					//Max number of helix turns between two linked looper legs
 #define MERGE_HORIZONTAL_DOUBLE_QPT_LIMIT 2			//Min Q/Pt to attempt second horizontal merge between slices after a vertical merge was found
 
 #define HLTCA_Y_FACTOR 4							//Weight of y residual vs z residual in tracklet constructor
@@ -22,8 +23,14 @@
 #define TRACKLET_CONSTRUCTOR_MAX_ROW_GAP 4			//Maximum number of consecutive rows without hit in track following
 #define TRACKLET_CONSTRUCTOR_MAX_ROW_GAP_SEED 2		//Same, but during fit of seed
 #define MIN_TRACK_PT_DEFAULT 0.010					//Default setting for minimum track Pt at some places
+#define HLTCA_ITERATIVE_MASK_MIN_HITS 30			//Min num of hits of a track in a non-final iterative tracking pass to keep it and mask its hits for the next pass
+#define HLTCA_ITERATIVE_TIGHT_FACTOR 0.75f			//Factor by which the search windows of the first iterative tracking pass are narrowed w.r.t. the default cuts
+#define HLTCA_ITERATIVE_LOOSE_FACTOR 1.5f			//Factor by which the search windows are widened in each further iterative tracking pass
 
 #define HLTCA_GM_MAXNMISSED 5						//Maximum number of missed hits in merger (0 = disabled)
+#define HLTCA_GM_DEDX_IROC_ROWS 63					//Rows belonging to the inner readout chamber for dE/dx
+#define HLTCA_GM_DEDX_TRUNC_LOW 0.f					//Lower fraction of cluster charges rejected by the dE/dx truncated mean
+#define HLTCA_GM_DEDX_TRUNC_HIGH 0.6f				//Upper limit (fraction) of cluster charges used by the dE/dx truncated mean
 
 #define MAX_SLICE_NTRACK (2 << 24)					//Maximum number of tracks per slice (limited by track id format)
 
@@ -141,6 +141,8 @@ void AliHLTTPCCASliceData::InitializeRows( const AliHLTTPCCAParam &p )
 			if (!fIsGpuSliceData) delete[] fMemory;
 			fMemory = NULL;
 		}
+		delete[] fSnapshot;
+		fSnapshot = NULL;
 
 	}
 #endif
@@ -162,9 +164,7 @@ size_t AliHLTTPCCASliceData::SetPointers(const AliHLTTPCCAClusterData *data, boo
   const unsigned int kVectorAlignment = 256 /*sizeof( uint4 )*/ ;
   fNumberOfHitsPlusAlign = NextMultipleOf < ( kVectorAlignment > sizeof(HLTCA_GPU_ROWALIGNMENT) ? kVectorAlignment : sizeof(HLTCA_GPU_ROWALIGNMENT)) / sizeof( int ) > ( hitMemCount );
   fNumberOfHits = data->NumberOfClusters();
-  const int firstHitInBinSize = (23 + sizeof(HLTCA_GPU_ROWALIGNMENT) / sizeof(int)) * HLTCA_ROW_COUNT + 4 * fNumberOfHits + 3;
-  //FIXME: sizeof(HLTCA_GPU_ROWALIGNMENT) / sizeof(int) * HLTCA_ROW_COUNT is way to big and only to ensure to reserve enough memory for GPU Alignment.
-  //Might be replaced by correct value
+  const int firstHitInBinSize = MaxFirstHitInBinSize();
 
   const int memorySize =
     // LinkData, HitData
@@ -395,15 +395,37 @@ int AliHLTTPCCASliceData::InitFromClusterData( const AliHLTTPCCAClusterData &dat
       return(1);
     }
 
-    for ( int i = 0; i < numberOfBins; ++i ) {
-      fFirstHitInBin[row.fFirstHitInBinOffset + i] = c[i]; // global bin-sorted hit index
-    }
-    const calink a = c[numberOfBins];
     // grid.N is <= row.fNHits
-    const int nn = numberOfBins + grid.Ny() + 3;
-    for ( int i = numberOfBins; i < nn; ++i ) {
-      assert( (signed) row.fFirstHitInBinOffset + i < 23 * numberOfRows + 4 * fNumberOfHits + 3 );
-      fFirstHitInBin[row.fFirstHitInBinOffset + i] = a;
+    int nn = numberOfBins + grid.Ny() + 3;
+    if ( fSparseRowGrid ) {
+      // occupancy words, their ranks, and the first hit of the occupied bins (see fFirstHitInBin), the bins >= numberOfBins are empty
+      const int nWords = SparseRowGridWords( grid );
+      calink *occupancy = &fFirstHitInBin[row.fFirstHitInBinOffset];
+      calink *firstHit = occupancy + 2 * nWords;
+      calink nOccupied = 0;
+      for ( int iWord = 0; iWord < nWords; ++iWord ) {
+        calink word = 0;
+        occupancy[nWords + iWord] = nOccupied;
+        for ( int bin = 32 * iWord; bin < 32 * iWord + 32 && bin < numberOfBins; ++bin ) {
+          if ( c[bin + 1] != c[bin] ) {
+            word |= 1u << ( bin & 31 );
+            firstHit[nOccupied++] = c[bin];
+          }
+        }
+        occupancy[iWord] = word;
+      }
+      firstHit[nOccupied] = c[numberOfBins];
+      nn = 2 * nWords + nOccupied + 1;
+      assert( (signed) row.fFirstHitInBinOffset + nn <= MaxFirstHitInBinSize() );
+    } else {
+      for ( int i = 0; i < numberOfBins; ++i ) {
+        fFirstHitInBin[row.fFirstHitInBinOffset + i] = c[i]; // global bin-sorted hit index
+      }
+      const calink a = c[numberOfBins];
+      for ( int i = numberOfBins; i < nn; ++i ) {
+        assert( (signed) row.fFirstHitInBinOffset + i < MaxFirstHitInBinSize() );
+        fFirstHitInBin[row.fFirstHitInBinOffset + i] = a;
+      }
     }
 
     row.fFullSize = nn;
@@ -422,6 +444,56 @@ int AliHLTTPCCASliceData::InitFromClusterData( const AliHLTTPCCAClusterData &dat
   return(0);
 }
 
+void AliHLTTPCCASliceData::SaveSnapshot()
+{
+  // copy the slice data after InitFromClusterData: the scalar members, the rows and the memory block
+
+  const size_t rowsSize = ( HLTCA_ROW_COUNT + 1 ) * sizeof( AliHLTTPCCARow );
+  const size_t size = sizeof( SnapshotHeader ) + rowsSize + fMemorySize;
+  if ( size > fSnapshotSize ) {
+    delete[] fSnapshot;
+    fSnapshot = new char[size];
+    fSnapshotSize = size;
+  }
+  SnapshotHeader header;
+  header.fFirstRow = fFirstRow;
+  header.fLastRow = fLastRow;
+  header.fNumberOfHits = fNumberOfHits;
+  header.fNumberOfHitsPlusAlign = fNumberOfHitsPlusAlign;
+  header.fGPUSharedDataReq = fGPUSharedDataReq;
+  header.fSparseRowGrid = fSparseRowGrid;
+  header.fMaxZ = fMaxZ;
+  header.fMemorySize = fMemorySize;
+  memcpy( fSnapshot, &header, sizeof( header ) );
+  memcpy( fSnapshot + sizeof( header ), fRows, rowsSize );
+  memcpy( fSnapshot + sizeof( header ) + rowsSize, fMemory, fMemorySize );
+  fSnapshotValid = 1;
+}
+
+int AliHLTTPCCASliceData::RestoreSnapshot( const AliHLTTPCCAClusterData &data )
+{
+  // restore the slice data saved by SaveSnapshot, data must be the same cluster data as for the snapshot
+
+  if ( !fSnapshotValid ) return 1;
+  SnapshotHeader header;
+  memcpy( &header, fSnapshot, sizeof( header ) );
+  if ( header.fNumberOfHits != data.NumberOfClusters() ) return 1;
+
+  // the memory layout only depends on the number of clusters and the grid format, allocate only if the memory block is gone
+  fSparseRowGrid = header.fSparseRowGrid;
+  if ( SetPointers( &data, fMemory == NULL || fMemorySize != header.fMemorySize ) == 0 ) return 1;
+  const size_t rowsSize = ( HLTCA_ROW_COUNT + 1 ) * sizeof( AliHLTTPCCARow );
+  memcpy( fRows, fSnapshot + sizeof( header ), rowsSize );
+  memcpy( fMemory, fSnapshot + sizeof( header ) + rowsSize, fMemorySize );
+  fFirstRow = header.fFirstRow;
+  fLastRow = header.fLastRow;
+  fNumberOfHits = header.fNumberOfHits;
+  fNumberOfHitsPlusAlign = header.fNumberOfHitsPlusAlign;
+  fGPUSharedDataReq = header.fGPUSharedDataReq;
+  fMaxZ = header.fMaxZ;
+  return 0;
+}
+
 void AliHLTTPCCASliceData::ClearHitWeights()
 {
   // clear hit weights
@@ -450,3 +522,83 @@ void AliHLTTPCCASliceData::ClearLinks()
     fLinkDownData[i] = CALINK_INVAL;
   }
 }
+
+int AliHLTTPCCASliceData::FirstHitInBinSize() const
+{
+  // number of FirstHitInBin entries of all rows
+
+  if ( fLastRow < fFirstRow ) return 0;
+  return fRows[fLastRow].fFirstHitInBinOffset + fRows[fLastRow].fFullSize;
+}
+
+void AliHLTTPCCASliceData::MaskHits( const char *hitMask, int *hitOrder, calink *firstHitInBin, int *rowNHits )
+{
+  // compact the unmasked hits of every row to the front, the masked hits are kept behind row.NHits()
+
+  memcpy( firstHitInBin, fFirstHitInBin, FirstHitInBinSize() * sizeof( calink ) );
+  cahit2 *tmpHitData = new cahit2[fNumberOfHitsPlusAlign];
+  int *tmpClusterDataIndex = new int[fNumberOfHitsPlusAlign];
+  int *nUnmasked = new int[fNumberOfHitsPlusAlign + 1];
+
+  for ( int rowIndex = 0; rowIndex < HLTCA_ROW_COUNT; ++rowIndex ) {
+    AliHLTTPCCARow &row = fRows[rowIndex];
+    rowNHits[rowIndex] = row.fNHits;
+    if ( rowIndex < fFirstRow || rowIndex > fLastRow || row.fNHits <= 0 ) continue;
+
+    const int offset = row.fHitNumberOffset;
+    int n = 0;
+    for ( int ih = 0; ih < row.fNHits; ++ih ) {
+      nUnmasked[ih] = n;
+      if ( !hitMask[offset + ih] ) hitOrder[offset + n++] = ih;
+    }
+    nUnmasked[row.fNHits] = n;
+    int nMasked = n;
+    for ( int ih = 0; ih < row.fNHits; ++ih ) {
+      if ( hitMask[offset + ih] ) hitOrder[offset + nMasked++] = ih;
+    }
+
+    for ( int ih = 0; ih < row.fNHits; ++ih ) {
+      tmpHitData[ih] = fHitData[offset + hitOrder[offset + ih]];
+      tmpClusterDataIndex[ih] = fClusterDataIndex[offset + hitOrder[offset + ih]];
+    }
+    memcpy( fHitData + offset, tmpHitData, row.fNHits * sizeof( cahit2 ) );
+    memcpy( fClusterDataIndex + offset, tmpClusterDataIndex, row.fNHits * sizeof( int ) );
+
+    // the bins are contiguous ranges of the bin-sorted hits, so the new bin start is the number of unmasked hits before the old one.
+    // In the sparse format the occupancy stays as it is, bins which become empty just start at the same hit as the next bin
+    for ( int i = fSparseRowGrid ? 2 * SparseRowGridWords( row.fGrid ) : 0; i < row.fFullSize; ++i ) {
+      fFirstHitInBin[row.fFirstHitInBinOffset + i] = nUnmasked[fFirstHitInBin[row.fFirstHitInBinOffset + i]];
+    }
+    row.fNHits = n;
+  }
+
+  delete[] tmpHitData;
+  delete[] tmpClusterDataIndex;
+  delete[] nUnmasked;
+}
+
+void AliHLTTPCCASliceData::UnmaskHits( const int *hitOrder, const calink *firstHitInBin, const int *rowNHits )
+{
+  // undo MaskHits
+
+  memcpy( fFirstHitInBin, firstHitInBin, FirstHitInBinSize() * sizeof( calink ) );
+  cahit2 *tmpHitData = new cahit2[fNumberOfHitsPlusAlign];
+  int *tmpClusterDataIndex = new int[fNumberOfHitsPlusAlign];
+
+  for ( int rowIndex = 0; rowIndex < HLTCA_ROW_COUNT; ++rowIndex ) {
+    AliHLTTPCCARow &row = fRows[rowIndex];
+    row.fNHits = rowNHits[rowIndex];
+    if ( rowIndex < fFirstRow || rowIndex > fLastRow || row.fNHits <= 0 ) continue;
+
+    const int offset = row.fHitNumberOffset;
+    for ( int ih = 0; ih < row.fNHits; ++ih ) {
+      tmpHitData[hitOrder[offset + ih]] = fHitData[offset + ih];
+      tmpClusterDataIndex[hitOrder[offset + ih]] = fClusterDataIndex[offset + ih];
+    }
+    memcpy( fHitData + offset, tmpHitData, row.fNHits * sizeof( cahit2 ) );
+    memcpy( fClusterDataIndex + offset, tmpClusterDataIndex, row.fNHits * sizeof( int ) );
+  }
+
+  delete[] tmpHitData;
+  delete[] tmpClusterDataIndex;
+}
@@ -48,9 +48,9 @@ MEM_CLASS_PRE() class AliHLTTPCCASliceData
   public:
     AliHLTTPCCASliceData()
       : 
-      fIsGpuSliceData(0), fGPUSharedDataReq(0), fFirstRow( 0 ), fLastRow( HLTCA_ROW_COUNT - 1), fNumberOfHits( 0 ), fNumberOfHitsPlusAlign( 0 ), fMaxZ(0.f), fMemorySize( 0 ), fGpuMemorySize( 0 ), fMemory( 0 ), fGPUTextureBase( 0 )
+      fIsGpuSliceData(0), fSparseRowGrid(0), fGPUSharedDataReq(0), fFirstRow( 0 ), fLastRow( HLTCA_ROW_COUNT - 1), fNumberOfHits( 0 ), fNumberOfHitsPlusAlign( 0 ), fMaxZ(0.f), fMemorySize( 0 ), fGpuMemorySize( 0 ), fMemory( 0 ), fGPUTextureBase( 0 )
       ,fRows( NULL ), fLinkUpData( 0 ), fLinkDownData( 0 ), fHitData( 0 ), fClusterDataIndex( 0 )
-      , fFirstHitInBin( 0 ), fHitWeights( 0 )
+      , fFirstHitInBin( 0 ), fHitWeights( 0 ), fSnapshot( 0 ), fSnapshotSize( 0 ), fSnapshotEnabled( 0 ), fSnapshotValid( 0 )
     {
     }
 
@@ -104,6 +104,21 @@ MEM_CLASS_PRE() class AliHLTTPCCASliceData
      */
     void ClearLinks();
 
+    /**
+     * Remove the masked hits from the rows for a further tracking pass. In each row the unmasked hits are
+     * moved to the front (keeping the bin order), the grid and the hit count of the row only cover them.
+     * hitOrder receives the original row index of every hit, the grid and the row hit counts are saved
+     * for UnmaskHits. hitMask and hitOrder are indexed like the hit data, firstHitInBin has
+     * FirstHitInBinSize() entries, rowNHits one per row.
+     */
+    void MaskHits( const char *hitMask, int *hitOrder, calink *firstHitInBin, int *rowNHits );
+
+    /**
+     * Restore the original hit order, grid and row hit counts saved by MaskHits.
+     */
+    void UnmaskHits( const int *hitOrder, const calink *firstHitInBin, const int *rowNHits );
+    int FirstHitInBinSize() const;
+
     /**
      * Return the y and z coordinate(s) of the given hit(s).
      */
@@ -120,6 +135,21 @@ MEM_CLASS_PRE() class AliHLTTPCCASliceData
      */
     MEM_TEMPLATE() GPUd() calink FirstHitInBin( const MEM_TYPE( AliHLTTPCCARow)&row, calink binIndexes ) const;
 
+    /**
+     * first = FirstHitInBin( row, binIndex ) and last = FirstHitInBin( row, binIndex + n ), i.e. the hits of the n bins from binIndex.
+     * With the sparse row grid an empty range is recognized from the occupancy ranks, without looking up the hits.
+     */
+    MEM_TEMPLATE() GPUd() void FirstHitInBinRange( const MEM_TYPE( AliHLTTPCCARow)&row, calink binIndex, calink n, int &first, int &last ) const;
+
+    /**
+     * Store the grid content of the rows in the sparse format (see fFirstHitInBin), CPU tracking only.
+     * FirstHitInBin( row ) must not be indexed directly then.
+     */
+    void SetSparseRowGrid( bool v ) { fSparseRowGrid = v; }
+    GPUhd() bool SparseRowGrid() const { return fSparseRowGrid; }
+    // Number of 32 bit occupancy words of a row in the sparse format, covering all N + Ny + 3 bins
+    GPUhd() static int SparseRowGridWords( const AliHLTTPCCAGrid &grid ) { return ( grid.N() + grid.Ny() + 3 + 31 ) / 32; }
+
     /**
      * If the given weight is higher than what is currently stored replace with the new weight.
      */
@@ -163,6 +193,19 @@ MEM_CLASS_PRE() class AliHLTTPCCASliceData
     void SetGpuSliceData() { fIsGpuSliceData = 1; }
     float MaxZ() const { return fMaxZ; }
 
+    /**
+     * Snapshot of the prepared slice data (rows with grids, packed hits and all other arrays), for benchmarks
+     * which process the same event several times. SaveSnapshot copies the state after InitFromClusterData,
+     * RestoreSnapshot copies it back instead of recreating it from the same cluster data.
+     * The snapshot must be invalidated when the cluster data changes.
+     */
+    void EnableSnapshot( bool v ) { fSnapshotEnabled = v; fSnapshotValid = 0; }
+    bool SnapshotEnabled() const { return fSnapshotEnabled; }
+    bool HasSnapshot() const { return fSnapshotValid; }
+    void InvalidateSnapshot() { fSnapshotValid = 0; }
+    void SaveSnapshot();
+    int RestoreSnapshot( const AliHLTTPCCAClusterData &data );
+
   private:
     AliHLTTPCCASliceData( const AliHLTTPCCASliceData & );
     AliHLTTPCCASliceData& operator=( const AliHLTTPCCASliceData & ) ;
@@ -172,7 +215,22 @@ MEM_CLASS_PRE() class AliHLTTPCCASliceData
     int PackHitData( AliHLTTPCCARow *row, const AliHLTArray<AliHLTTPCCAHit, 1> &binSortedHits );
 #endif
 
+    // Number of fFirstHitInBin entries allocated for fNumberOfHits hits, an upper bound of FirstHitInBinSize() incl. the alignment.
+    // The dense format stores N + Ny + 3 <= 23 + 4 * nHits entries per row, the sparse format 2 * SparseRowGridWords + nOccupied + 1 <= 5 + 5 * nHits / 4.
+    // FIXME: sizeof(HLTCA_GPU_ROWALIGNMENT) / sizeof(int) * HLTCA_ROW_COUNT is way to big and only to ensure to reserve enough memory for GPU Alignment.
+    int MaxFirstHitInBinSize() const
+    {
+      return fSparseRowGrid ? (5 + sizeof(HLTCA_GPU_ROWALIGNMENT) / sizeof(int)) * HLTCA_ROW_COUNT + 5 * fNumberOfHits / 4 + 3 : (23 + sizeof(HLTCA_GPU_ROWALIGNMENT) / sizeof(int)) * HLTCA_ROW_COUNT + 4 * fNumberOfHits + 3;
+    }
+
+    // Number of occupied bins before binIndex in the sparse format
+    GPUhd() static calink SparseRowGridRank( GPUglobalref() const calink *occupancy, int nWords, calink binIndex )
+    {
+      return occupancy[nWords + ( binIndex >> 5 )] + CAMath::Popcount( occupancy[binIndex >> 5] & ( ( 1u << ( binIndex & 31 ) ) - 1 ) );
+    }
+
     int fIsGpuSliceData;       //Slice Data for GPU Tracker?
+    int fSparseRowGrid;        //Grid content of the rows in the sparse format
     int fGPUSharedDataReq;     //Size of shared memory required for GPU Reconstruction
 
     int fFirstRow;             //First non-empty row
@@ -200,11 +258,27 @@ MEM_CLASS_PRE() class AliHLTTPCCASliceData
     /*
      * The size of the array is row.Grid.N + row.Grid.Ny + 3. The row.Grid.Ny + 3 is an optimization
      * to remove the need for bounds checking. The last values are the same as the entry at [N - 1].
+     *
+     * In the sparse format only the occupied bins are stored. For w = SparseRowGridWords words the row contains
+     * w occupancy words (bit b of word i is set if bin 32 * i + b has hits), w ranks (number of occupied bins
+     * before the word) and the first hit of every occupied bin followed by the number of hits.
+     * The first hit of any bin is then the entry of the next occupied bin: firstHit[rank + popcount(lower bits)].
+     * At low occupancy most bins are empty, so this needs much less memory than the full array.
      */
     GPUglobalref() calink *fFirstHitInBin;         // see FirstHitInBin
 
     GPUglobalref() int *fHitWeights;          // the weight of the longest tracklet crossed the cluster
 
+    struct SnapshotHeader {
+      int fFirstRow, fLastRow, fNumberOfHits, fNumberOfHitsPlusAlign, fGPUSharedDataReq, fSparseRowGrid;
+      float fMaxZ;
+      size_t fMemorySize;
+    };
+    GPUglobalref() char *fSnapshot;           // snapshot: header, rows and memory block (host only)
+    size_t fSnapshotSize;                     // allocated size of fSnapshot
+    int fSnapshotEnabled;                     // save the slice data after InitFromClusterData
+    int fSnapshotValid;                       // fSnapshot contains the slice data of the current cluster data
+
 };
 
 MEM_CLASS_PRE() MEM_TEMPLATE() GPUd() inline calink MEM_LG(AliHLTTPCCASliceData)::HitLinkUpData  ( const MEM_TYPE( AliHLTTPCCARow)&row, const calink &hitIndex ) const
@@ -244,9 +318,33 @@ MEM_CLASS_PRE() MEM_TEMPLATE() GPUd() inline cahit2 MEM_LG(AliHLTTPCCASliceData)
 
 MEM_CLASS_PRE() MEM_TEMPLATE() GPUd() inline calink MEM_LG(AliHLTTPCCASliceData)::FirstHitInBin( const MEM_TYPE( AliHLTTPCCARow)&row, calink binIndexes ) const
 {
+#ifndef HLTCA_GPUCODE
+  if ( fSparseRowGrid ) {
+    GPUglobalref() const calink *occupancy = &fFirstHitInBin[row.fFirstHitInBinOffset];
+    const int nWords = SparseRowGridWords( row.fGrid );
+    return occupancy[2 * nWords + SparseRowGridRank( occupancy, nWords, binIndexes )];
+  }
+#endif
   return fFirstHitInBin[row.fFirstHitInBinOffset + binIndexes];
 }
 
+MEM_CLASS_PRE() MEM_TEMPLATE() GPUd() inline void MEM_LG(AliHLTTPCCASliceData)::FirstHitInBinRange( const MEM_TYPE( AliHLTTPCCARow)&row, calink binIndex, calink n, int &first, int &last ) const
+{
+#ifndef HLTCA_GPUCODE
+  if ( fSparseRowGrid ) {
+    GPUglobalref() const calink *occupancy = &fFirstHitInBin[row.fFirstHitInBinOffset];
+    const int nWords = SparseRowGridWords( row.fGrid );
+    const calink rankFirst = SparseRowGridRank( occupancy, nWords, binIndex );
+    const calink rankLast = SparseRowGridRank( occupancy, nWords, binIndex + n );
+    first = occupancy[2 * nWords + rankFirst];
+    last = rankLast == rankFirst ? first : occupancy[2 * nWords + rankLast];
+    return;
+  }
+#endif
+  first = fFirstHitInBin[row.fFirstHitInBinOffset + binIndex];
+  last = fFirstHitInBin[row.fFirstHitInBinOffset + binIndex + n];
+}
+
 MEM_CLASS_PRE() MEM_TEMPLATE() GPUhd() inline int_v MEM_LG(AliHLTTPCCASliceData)::ClusterDataIndex( const MEM_TYPE( AliHLTTPCCARow)&row, uint_v hitIndex ) const
 {
   return fClusterDataIndex[row.fHitNumberOffset + hitIndex];
@@ -105,6 +105,7 @@ void AliHLTTPCCAStandaloneFramework::StartDataReading( int guessForNumberOfClust
   for ( int i = 0; i < fgkNSlices; i++ ) {
     fClusterData[i].StartReading( i, sliceGuess );
   }
+  fTracker.InvalidateSliceDataSnapshots(); // new cluster data
   fMCLabels.clear();
   fMCInfo.clear();
 }
@@ -196,11 +197,31 @@ int AliHLTTPCCAStandaloneFramework::ProcessEvent(int forceSingleSlice, bool rese
   if (fRunQA) printf("QA Time: %'d us\n", (int) (1000000 * timerQA.GetElapsedTime() / nCount));
 #endif
 
-  if (fDebugLevel >= 1)
+  const char* tmpNames[12] = {"Initialisation", "Neighbours Finder", "Neighbours Cleaner", "Starts Hits Finder", "Start Hits Sorter", "Weight Cleaner", "Tracklet Constructor", "Tracklet Selector", "Global Tracking", "Write Output", "Deterministic Sort", "Iterative Masking"};
+  if (PerfCounters::IsEnabled() && fTracker.GetGPUStatus() < 2)
   {
-		const char* tmpNames[10] = {"Initialisation", "Neighbours Finder", "Neighbours Cleaner", "Starts Hits Finder", "Start Hits Sorter", "Weight Cleaner", "Tracklet Constructor", "Tracklet Selector", "Global Tracking", "Write Output"};
+	//Summed over the slices, the stages of a slice are counted by the thread processing it
+	static double nClustersPerf = 0;
+	for (int iSlice = 0;iSlice < fgkNSlices;iSlice++)
+	{
+		if (forceSingleSlice == -1 || iSlice == forceSingleSlice) nClustersPerf += fClusterData[iSlice].NumberOfClusters();
+	}
+	for (int i = 0;i < 12;i++)
+	{
+		PerfCounters sum;
+		for (int iSlice = 0;iSlice < fgkNSlices;iSlice++)
+		{
+			sum.Add(*fTracker.GetPerfCounters(iSlice, i));
+			if (!HLTCA_TIMING_SUM && fDebugLevel < 1) fTracker.ResetTimer(iSlice, i); //Otherwise reset below
+		}
+		sum.Print(tmpNames[i], nClustersPerf);
+	}
+	if (!HLTCA_TIMING_SUM) nClustersPerf = 0;
+  }
 
-		for (int i = 0;i < 10;i++)
+  if (fDebugLevel >= 1)
+  {
+		for (int i = 0;i < 12;i++)
 		{
             double time = 0;
 			for ( int iSlice = 0; iSlice < fgkNSlices;iSlice++)
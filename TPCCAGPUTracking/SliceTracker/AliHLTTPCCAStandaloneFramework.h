@@ -76,9 +76,18 @@ class AliHLTTPCCAStandaloneFramework
 	int GetGPUMaxSliceCount() const { return(fTracker.MaxSliceCount()); }
 	void SetNWays(int v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetNWays(v); fMerger.SetSliceParam(param);}
 	void SetNWaysOuter(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetNWaysOuter(v); fMerger.SetSliceParam(param);}
+	void SetMergeLoopers(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetMergeLoopers(v); fMerger.SetSliceParam(param);}
+	void SetComputedEdx(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetComputedEdx(v); fMerger.SetSliceParam(param);}
+	void SetMergerScalarSliceTracks(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetMergerScalarSliceTracks(v); fMerger.SetSliceParam(param);}
 	void SetSearchWindowDZDR(float v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetSearchWindowDZDR(v); fMerger.SetSliceParam(param);for (int i = 0;i < fgkNSlices;i++) fTracker.GetParam(i).SetSearchWindowDZDR(v);}
 	void SetContinuousTracking(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetContinuousTracking(v); fMerger.SetSliceParam(param);for (int i = 0;i < fgkNSlices;i++) fTracker.GetParam(i).SetContinuousTracking(v);}
+	void SetDeterministicOutput(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetDeterministicOutput(v); fMerger.SetSliceParam(param);for (int i = 0;i < fgkNSlices;i++) fTracker.GetParam(i).SetDeterministicOutput(v);}
+	void SetSliceDataSnapshot(bool v) {fTracker.SetSliceDataSnapshot(v);}
+	void SetSparseRowGrid(bool v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetSparseRowGrid(v); fMerger.SetSliceParam(param);for (int i = 0;i < fgkNSlices;i++) fTracker.GetParam(i).SetSparseRowGrid(v);}
+	void SetTrackingPasses(int v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetTrackingPasses(v); fMerger.SetSliceParam(param);for (int i = 0;i < fgkNSlices;i++) fTracker.GetParam(i).SetTrackingPasses(v);}
 	void SetTrackReferenceX(float v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetTrackReferenceX(v); fMerger.SetSliceParam(param);}
+	void SetFitMaxNRejected(int v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetFitMaxNRejected(v); fMerger.SetSliceParam(param);}
+	void SetFitMaxChi2NDF(float v) { AliHLTTPCCAParam param = fMerger.SliceParam(); param.SetFitMaxChi2NDF(v); fMerger.SetSliceParam(param);}
 	void UpdateGPUSliceParam() {fTracker.UpdateGPUSliceParam();}
 	void SetEventDisplay(int v) {fEventDisplay = v;}
 	void SetRunQA(int v) {fRunQA = v;}
@@ -44,6 +44,8 @@
 #include <string.h>
 #include <cmath>
 #include <algorithm>
+#include <vector>
+#include "AliHLTTPCCAMemoryPlanner.h"
 #endif
 
 //#define DRAW1
@@ -376,6 +378,7 @@ void AliHLTTPCCATracker::SetupCommonMemory()
 	}
 
 	fHitMemory = fTrackletMemory = fTrackMemory = 0;
+	ClearScratchPointers();
 
 	fData.Clear();
 	fCommonMem->fNTracklets = 0;
@@ -392,11 +395,24 @@ int AliHLTTPCCATracker::ReadEvent( AliHLTTPCCAClusterData *clusterData )
 
 	StartEvent();
 
-	//* Convert input hits, create grids, etc.
-	if (fData.InitFromClusterData( *clusterData ))
+	//* Convert input hits, create grids, etc., or restore them from the snapshot of a previous run of the same event
+	if (fData.HasSnapshot() && !fIsGPUTracker)
 	{
-		printf("Error initializing from cluster data\n");
-		return 1;
+		if (fData.RestoreSnapshot( *clusterData ))
+		{
+			printf("Error restoring slice data snapshot\n");
+			return 1;
+		}
+	}
+	else
+	{
+		fData.SetSparseRowGrid(fParam.GetSparseRowGrid() && !fIsGPUTracker);
+		if (fData.InitFromClusterData( *clusterData ))
+		{
+			printf("Error initializing from cluster data\n");
+			return 1;
+		}
+		if (fData.SnapshotEnabled() && !fIsGPUTracker) fData.SaveSnapshot();
 	}
 	if (fData.MaxZ() > 300 && !fParam.GetContinuousTracking())
 	{
@@ -405,10 +421,18 @@ int AliHLTTPCCATracker::ReadEvent( AliHLTTPCCAClusterData *clusterData )
 	}
 	if (!fIsGPUTracker)
 	{
+#if !defined(HLTCA_GPUCODE)
+		SetPointersHitsPlanned( fData.NumberOfHits() ); // allocate and set pointers for hits and track hits
+#else
 		SetPointersHits( fData.NumberOfHits() ); // to calculate the size
 		fHitMemory = reinterpret_cast<char*> ( new uint4 [ fHitMemorySize/sizeof( uint4 ) + 100] );
+		SetPointersHits( fData.NumberOfHits() ); // set pointers for hits
+#endif
+	}
+	else
+	{
+		SetPointersHits( fData.NumberOfHits() ); // set pointers for hits
 	}
-	SetPointersHits( fData.NumberOfHits() ); // set pointers for hits
 	StopTimer(0);
 	return 0;
 }
@@ -457,6 +481,64 @@ GPUhd() void  AliHLTTPCCATracker::SetPointersTracks( int MaxNTracks, int MaxNHit
 	fTrackMemorySize = mem - fTrackMemory;
 }
 
+#if !defined(HLTCA_GPUCODE)
+GPUh() void AliHLTTPCCATracker::SetPointersHitsPlanned( int MaxNHits )
+{
+	// allocate the hit memory of the CPU tracker and set the pointers
+	// the start hits are dead when the tracklet selector writes the track hits, so both share memory,
+	// unless the data is kept for the event display, which draws the seeds after the tracking
+	AliHLTTPCCAMemoryPlanner planner;
+	const int iStartHits = planner.Register<AliHLTTPCCAHitId>( "Start Hits", MaxNHits, kMemStageStartHits, fKeepData ? kMemStageOutput : kMemStageTrackletConstructor );
+	const int iTrackHits = planner.Register<AliHLTTPCCAHitId>( "Track Hits", 2 * MaxNHits, kMemStageTrackletSelector, kMemStageOutput );
+	fHitMemorySize = planner.Plan();
+	fHitMemory = reinterpret_cast<char*> ( new uint4 [ fHitMemorySize/sizeof( uint4 ) + 100] );
+	planner.Assign( fTrackletStartHits, fHitMemory, iStartHits );
+	planner.Assign( fTrackHits, fHitMemory, iTrackHits );
+	if (fGPUDebugLevel >= 4) planner.Print( "Hit Memory" );
+}
+
+GPUh() void AliHLTTPCCATracker::SetPointersTrackletsPlanned( int MaxNTracklets, int MaxNTracks, int MaxNHits )
+{
+	// allocate the tracklet memory of the CPU tracker and set the pointers for tracklets and tracks, the track hits are in the hit memory
+	// the tracklets and their row hits are dead after the tracklet selector, the scratch of the track sorting, the global tracking and the output is placed over them
+	// the tracklets are kept alive for the event display, which draws them after the tracking
+	AliHLTTPCCAMemoryPlanner planner;
+	const int lastTrackletStage = fKeepData ? kMemStageOutput : kMemStageTrackletSelector;
+	const int iTracklets = planner.Register<AliHLTTPCCATracklet>( "Tracklets", MaxNTracklets, kMemStageTrackletConstructor, lastTrackletStage );
+#ifdef EXTERN_ROW_HITS
+	const int iRowHits = planner.Register<calink>( "Tracklet Row Hits", (size_t) MaxNTracklets * Param().NRows(), kMemStageTrackletConstructor, lastTrackletStage );
+#endif
+	const int iTracks = planner.Register<AliHLTTPCCATrack>( "Tracks", MaxNTracks, kMemStageTrackletSelector, kMemStageOutput );
+	int iSortOrder = -1, iSortTracks = -1, iSortHits = -1;
+	if (fParam.GetDeterministicOutput())
+	{
+		iSortOrder = planner.Register<int>( "Sort Order", MaxNTracks, kMemStageSortTracks, kMemStageSortTracks );
+		iSortTracks = planner.Register<AliHLTTPCCATrack>( "Sort Tracks", MaxNTracks, kMemStageSortTracks, kMemStageSortTracks );
+		iSortHits = planner.Register<AliHLTTPCCAHitId>( "Sort Track Hits", 2 * MaxNHits, kMemStageSortTracks, kMemStageSortTracks );
+	}
+	const int iGlobalTracklet = planner.Register<AliHLTTPCCATracklet>( "Global Tracklet", 1, kMemStageGlobalTracking, kMemStageGlobalTracking );
+	const int iGlobalRowHits = planner.Register<calink>( "Global Row Hits", HLTCA_ROW_COUNT, kMemStageGlobalTracking, kMemStageGlobalTracking );
+	const int iOutputOrder = planner.Register<trackSortData>( "Output Track Order", MaxNTracks, kMemStageOutput, kMemStageOutput );
+	fTrackletMemorySize = planner.Plan();
+	fTrackletMemory = reinterpret_cast<char*> ( new uint4 [ fTrackletMemorySize/sizeof( uint4 ) + 100] );
+	planner.Assign( fTracklets, fTrackletMemory, iTracklets );
+#ifdef EXTERN_ROW_HITS
+	planner.Assign( fTrackletRowHits, fTrackletMemory, iRowHits );
+#endif
+	planner.Assign( fTracks, fTrackletMemory, iTracks );
+	if (iSortOrder >= 0)
+	{
+		planner.Assign( fSortTrackOrder, fTrackletMemory, iSortOrder );
+		planner.Assign( fSortTracks, fTrackletMemory, iSortTracks );
+		planner.Assign( fSortTrackHits, fTrackletMemory, iSortHits );
+	}
+	planner.Assign( fGlobalTracklet, fTrackletMemory, iGlobalTracklet );
+	planner.Assign( fGlobalTrackletRowHits, fTrackletMemory, iGlobalRowHits );
+	planner.Assign( fOutputTrackOrder, fTrackletMemory, iOutputOrder );
+	if (fGPUDebugLevel >= 4) planner.Print( "Tracklet Memory" );
+}
+#endif
+
 GPUh() int AliHLTTPCCATracker::CheckEmptySlice() const
 {
 	//Check if the Slice is empty, if so set the output apropriate and tell the reconstuct procesdure to terminate
@@ -501,10 +583,172 @@ void AliHLTTPCCATracker::RunTrackletConstructor()
 void AliHLTTPCCATracker::RunTrackletSelector()
 {
 	//Run CPU Tracklet Selector
-	AliHLTTPCCAProcess<AliHLTTPCCATrackletSelector>( 1, fCommonMem->fNTracklets, *this );
+	AliHLTTPCCATrackletSelector::AliHLTTPCCATrackletSelectorCPU(*this);
+}
+
+struct AliHLTTPCCATracker::DeterministicTrackComparison
+{
+	//Strict ordering of tracks by their hits: first hit (row, hit), number of hits, then all remaining hits
+	const AliHLTTPCCATrack* const fTracks;
+	const AliHLTTPCCAHitId* const fHits;
+	DeterministicTrackComparison(const AliHLTTPCCATrack* tracks, const AliHLTTPCCAHitId* hits) : fTracks(tracks), fHits(hits) {}
+	bool operator()(const int aa, const int bb) const
+	{
+		const AliHLTTPCCATrack& a = fTracks[aa];
+		const AliHLTTPCCATrack& b = fTracks[bb];
+		const AliHLTTPCCAHitId* ha = fHits + a.FirstHitID();
+		const AliHLTTPCCAHitId* hb = fHits + b.FirstHitID();
+		if (ha[0].RowIndex() != hb[0].RowIndex()) return(ha[0].RowIndex() < hb[0].RowIndex());
+		if (ha[0].HitIndex() != hb[0].HitIndex()) return(ha[0].HitIndex() < hb[0].HitIndex());
+		if (a.NHits() != b.NHits()) return(a.NHits() > b.NHits());
+		for (int i = 1;i < a.NHits();i++)
+		{
+			if (ha[i].RowIndex() != hb[i].RowIndex()) return(ha[i].RowIndex() < hb[i].RowIndex());
+			if (ha[i].HitIndex() != hb[i].HitIndex()) return(ha[i].HitIndex() < hb[i].HitIndex());
+		}
+		return(aa < bb);
+	}
+};
+
+GPUh() void AliHLTTPCCATracker::SortTracksDeterministic()
+{
+	//Bring the local tracks and their hits into a canonical order.
+	//The tracklet selector assigns track and hit slots with atomics, so on the GPU (and in the multi-threaded tracker) the order depends on the scheduling.
+	//Must run before global tracking, which references local tracks by their index.
+	const int nTracks = fCommonMem->fNTracks;
+	if (nTracks <= 0) return;
+	StartTimer(10);
+
+	const bool heap = fSortTrackOrder == NULL; //GPU tracker, no planned tracklet memory
+	int* order = heap ? new int[nTracks] : fSortTrackOrder;
+	for (int i = 0;i < nTracks;i++) order[i] = i;
+	std::sort(order, order + nTracks, DeterministicTrackComparison(fTracks, fTrackHits));
+
+	AliHLTTPCCATrack* tmpTracks = heap ? new AliHLTTPCCATrack[nTracks] : fSortTracks;
+	AliHLTTPCCAHitId* tmpHits = heap ? new AliHLTTPCCAHitId[fCommonMem->fNTrackHits] : fSortTrackHits;
+	int nHits = 0;
+	for (int i = 0;i < nTracks;i++)
+	{
+		const AliHLTTPCCATrack& track = fTracks[order[i]];
+		memcpy((void*) (tmpHits + nHits), (const void*) (fTrackHits + track.FirstHitID()), track.NHits() * sizeof(AliHLTTPCCAHitId));
+		tmpTracks[i] = track;
+		tmpTracks[i].SetFirstHitID(nHits);
+		tmpTracks[i].SetLocalTrackId(i);
+		nHits += track.NHits();
+	}
+	memcpy((void*) fTracks, (const void*) tmpTracks, nTracks * sizeof(AliHLTTPCCATrack));
+	memcpy((void*) fTrackHits, (const void*) tmpHits, nHits * sizeof(AliHLTTPCCAHitId));
+	fCommonMem->fNTrackHits = nHits;
+
+	if (heap)
+	{
+		delete[] tmpHits;
+		delete[] tmpTracks;
+		delete[] order;
+	}
+	StopTimer(10);
 }
 
 GPUh() void AliHLTTPCCATracker::DoTracking()
+{
+#if !defined(HLTCA_GPUCODE)
+	if (!fIsGPUTracker && fParam.GetTrackingPasses() > 1)
+	{
+		DoIterativeTracking();
+		return;
+	}
+#endif
+	DoTrackingPass();
+}
+
+#if !defined(HLTCA_GPUCODE)
+GPUh() void AliHLTTPCCATracker::DoIterativeTracking()
+{
+	//Multi-pass slice tracking on the CPU.
+	//After every pass but the last, the tracks with at least HLTCA_ITERATIVE_MASK_MIN_HITS hits are kept and their hits are masked out of the rows.
+	//The first pass runs with the search windows narrowed by HLTCA_ITERATIVE_TIGHT_FACTOR, so that it picks up only the clean tracks.
+	//The next pass runs on the remaining hits with search windows widened by HLTCA_ITERATIVE_LOOSE_FACTOR, all tracks of the last pass are kept.
+	//The kept tracks of all passes form the track list of the slice, as if they came from a single pass.
+	const int nPasses = fParam.GetTrackingPasses();
+	const AliHLTTPCCAParam param = fParam;
+
+	const int nHitsAlloc = fData.NumberOfHitsPlusAlign();
+	char* hitMask = new char[nHitsAlloc];
+	int* hitOrder = new int[nHitsAlloc];
+	calink* firstHitInBin = new calink[fData.FirstHitInBinSize()];
+	int rowNHits[HLTCA_ROW_COUNT];
+	memset(hitMask, 0, nHitsAlloc * sizeof(char));
+
+	std::vector<AliHLTTPCCATrack> keptTracks;
+	std::vector<AliHLTTPCCAHitId> keptHits;
+	float factor = HLTCA_ITERATIVE_TIGHT_FACTOR;
+
+	for (int iPass = 0;iPass < nPasses;iPass++)
+	{
+		const bool lastPass = iPass == nPasses - 1;
+		if (iPass) factor *= HLTCA_ITERATIVE_LOOSE_FACTOR;
+		fParam.SetNeighboursSearchArea(param.NeighboursSearchArea() * factor);
+		fParam.SetSearchWindowDZDR(param.GetSearchWindowDZDR() * factor);
+		fParam.SetHitPickUpFactor(param.HitPickUpFactor() * factor);
+
+		DoTrackingPass();
+
+		StartTimer(11);
+		if (iPass)
+		{
+			//Back to the original hit indices
+			fData.UnmaskHits(hitOrder, firstHitInBin, rowNHits);
+			for (int i = 0;i < fCommonMem->fNTrackHits;i++)
+			{
+				const int row = fTrackHits[i].RowIndex();
+				fTrackHits[i].Set(row, hitOrder[Row(row).HitNumberOffset() + fTrackHits[i].HitIndex()]);
+			}
+		}
+
+		for (int i = 0;i < fCommonMem->fNTracks;i++)
+		{
+			AliHLTTPCCATrack track = fTracks[i];
+			if (!lastPass && track.NHits() < HLTCA_ITERATIVE_MASK_MIN_HITS) continue;
+			const AliHLTTPCCAHitId* hits = fTrackHits + track.FirstHitID();
+			track.SetFirstHitID(keptHits.size());
+			track.SetLocalTrackId(keptTracks.size());
+			keptTracks.push_back(track);
+			keptHits.insert(keptHits.end(), hits, hits + track.NHits());
+			if (!lastPass) for (int j = 0;j < track.NHits();j++) hitMask[Row(hits[j].RowIndex()).HitNumberOffset() + hits[j].HitIndex()] = 1;
+		}
+
+		if (!lastPass) fData.MaskHits(hitMask, hitOrder, firstHitInBin, rowNHits);
+		StopTimer(11);
+	}
+	fParam = param;
+
+	//Links and weights of the last pass refer to the masked hit order
+	fData.ClearLinks();
+	fData.ClearHitWeights();
+
+	//Track memory for the tracks of all passes, with the room of the last pass left for global tracking
+	const int nTracks = keptTracks.size();
+	const int nTrackHits = keptHits.size();
+	delete[] fTrackMemory;
+	fTrackMemory = NULL;
+	fNMaxTracks += nTracks;
+	SetPointersTracks( fNMaxTracks, NHitsTotal() + nTrackHits ); // to calculate the size
+	fTrackMemory = reinterpret_cast<char*> ( new uint4 [ fTrackMemorySize/sizeof( uint4 ) + 100] );
+	SetPointersTracks( fNMaxTracks, NHitsTotal() + nTrackHits ); // set pointers for tracks
+	if (nTracks) memcpy((void*) fTracks, (const void*) &keptTracks[0], nTracks * sizeof(AliHLTTPCCATrack));
+	if (nTrackHits) memcpy((void*) fTrackHits, (const void*) &keptHits[0], nTrackHits * sizeof(AliHLTTPCCAHitId));
+	fOutputTrackOrder = NULL; //Sized for the tracks of the last pass only
+	fCommonMem->fNTracks = nTracks;
+	fCommonMem->fNTrackHits = nTrackHits;
+	if (fGPUDebugLevel >= 3) printf("Slice %d, Number of tracks after %d passes: %d\n", fParam.ISlice(), nPasses, nTracks);
+
+	delete[] hitMask;
+	delete[] hitOrder;
+	delete[] firstHitInBin;
+}
+#endif
+
+GPUh() void AliHLTTPCCATracker::DoTrackingPass()
 {
 	fCommonMem->fNTracklets = fCommonMem->fNTracks = fCommonMem->fNTrackHits = 0;
 
@@ -554,15 +798,28 @@ GPUh() void AliHLTTPCCATracker::DoTracking()
 
 	if (!fIsGPUTracker)
 	{
+		if (fTrackletMemory) delete[] fTrackletMemory; //Previous pass of iterative tracking
+		if (fTrackMemory) delete[] fTrackMemory;
+		fTrackMemory = NULL;
+		fTrackMemorySize = 0;
+		fNMaxTracks = fCommonMem->fNTracklets * 2 + 50;
+#if !defined(HLTCA_GPUCODE)
+		ClearScratchPointers();
+		SetPointersTrackletsPlanned( fCommonMem->fNTracklets * 2, fNMaxTracks, NHitsTotal() ); // allocate and set pointers for tracklets, tracks and the scratch after the tracklet selector
+#else
 		SetPointersTracklets( fCommonMem->fNTracklets * 2 ); // to calculate the size
 		fTrackletMemory = reinterpret_cast<char*> ( new uint4 [ fTrackletMemorySize/sizeof( uint4 ) + 100] );
-		fNMaxTracks = fCommonMem->fNTracklets * 2 + 50;
 		SetPointersTracks( fNMaxTracks, NHitsTotal() ); // to calculate the size
 		fTrackMemory = reinterpret_cast<char*> ( new uint4 [ fTrackMemorySize/sizeof( uint4 ) + 100] );
+		SetPointersTracklets( fCommonMem->fNTracklets * 2 ); // set pointers for tracklets
+		SetPointersTracks( fNMaxTracks, NHitsTotal() ); // set pointers for tracks
+#endif
+	}
+	else
+	{
+		SetPointersTracklets( fCommonMem->fNTracklets * 2 ); // set pointers for tracklets
+		SetPointersTracks( fCommonMem->fNTracklets * 2 + 50, NHitsTotal() ); // set pointers for tracks
 	}
-
-	SetPointersTracklets( fCommonMem->fNTracklets * 2 ); // set pointers for tracklets
-	SetPointersTracks( fCommonMem->fNTracklets * 2 + 50, NHitsTotal() ); // set pointers for tracks
 
 	StartTimer(6);
 	RunTrackletConstructor();
@@ -579,6 +836,7 @@ GPUh() void AliHLTTPCCATracker::DoTracking()
 	StartTimer(7);
 	RunTrackletSelector();
 	StopTimer(7);
+	if (fParam.GetDeterministicOutput()) SortTracksDeterministic();
 	if (fGPUDebugLevel >= 3) printf("Slice %d, Number of tracks: %d\n", fParam.ISlice(), *NTracks());
 
 	//std::cout<<"Slice "<<Param().ISlice()<<": N start hits/tracklets/tracks = "<<nStartHits<<" "<<nStartHits<<" "<<*fNTracks<<std::endl;
@@ -618,6 +876,12 @@ template <class T> static inline bool SortComparison(const T& a, const T& b)
 	return(a.fSortVal < b.fSortVal);
 }
 
+template <class T> static inline bool SortComparisonDeterministic(const T& a, const T& b)
+{
+	if (a.fSortVal != b.fSortVal) return(a.fSortVal < b.fSortVal);
+	return(a.fSortId < b.fSortId);
+}
+
 GPUh() void AliHLTTPCCATracker::WriteOutput()
 {
 	// write output
@@ -645,14 +909,24 @@ GPUh() void AliHLTTPCCATracker::WriteOutput()
 
 	AliHLTTPCCASliceOutTrack *out = useOutput->FirstTrack();
 	
-	trackSortData* trackOrder = new trackSortData[fCommonMem->fNTracks];
+	trackSortData* trackOrder = fOutputTrackOrder ? fOutputTrackOrder : new trackSortData[fCommonMem->fNTracks];
 	for (int i = 0;i < fCommonMem->fNTracks;i++)
 	{
 		trackOrder[i].fTtrack = i;
 		trackOrder[i].fSortVal = fTracks[trackOrder[i].fTtrack].NHits() / 1000.f + fTracks[trackOrder[i].fTtrack].Param().GetZ() * 100.f + fTracks[trackOrder[i].fTtrack].Param().GetY();
+		trackOrder[i].fSortId = fTracks[trackOrder[i].fTtrack].LocalTrackId();
+	}
+	if (fParam.GetDeterministicOutput())
+	{
+		//Global tracks are appended by the neighbouring slices in arbitrary order, their LocalTrackId (slice, local track) is unique within this slice
+		std::sort(trackOrder, trackOrder + fCommonMem->fNLocalTracks, SortComparisonDeterministic<trackSortData>);
+		std::sort(trackOrder + fCommonMem->fNLocalTracks, trackOrder + fCommonMem->fNTracks, SortComparisonDeterministic<trackSortData>);
+	}
+	else
+	{
+		std::sort(trackOrder, trackOrder + fCommonMem->fNLocalTracks, SortComparison<trackSortData>);
+		std::sort(trackOrder + fCommonMem->fNLocalTracks, trackOrder + fCommonMem->fNTracks, SortComparison<trackSortData>);
 	}
-	std::sort(trackOrder, trackOrder + fCommonMem->fNLocalTracks, SortComparison<trackSortData>);
-	std::sort(trackOrder + fCommonMem->fNLocalTracks, trackOrder + fCommonMem->fNTracks, SortComparison<trackSortData>);
 	
 	for (int iTrTmp = 0;iTrTmp < fCommonMem->fNTracks;iTrTmp++)
 	{
@@ -712,7 +986,7 @@ GPUh() void AliHLTTPCCATracker::WriteOutput()
 		out->SetNClusters( nClu );
 		out = out->NextTrack();
 	}
-	delete[] trackOrder;
+	if (trackOrder != fOutputTrackOrder) delete[] trackOrder;
 
 	useOutput->SetNTracks( nStoredTracks );
 	useOutput->SetNLocalTracks( nStoredLocalTracks );
@@ -861,10 +1135,10 @@ GPUh() void AliHLTTPCCATracker::PerformGlobalTracking(AliHLTTPCCATracker& sliceL
 	int nTrkLeft = sliceLeft.fCommonMem->fNTracklets, nTrkRight = sliceRight.fCommonMem->fNTracklets;
 	sliceLeft.fCommonMem->fNTracklets = sliceRight.fCommonMem->fNTracklets = 1;
 	AliHLTTPCCATracklet *trkLeft = sliceLeft.fTracklets, *trkRight = sliceRight.fTracklets;
-	sliceLeft.fTracklets = sliceRight.fTracklets = new AliHLTTPCCATracklet;
+	sliceLeft.fTracklets = sliceRight.fTracklets = fGlobalTracklet ? fGlobalTracklet : new AliHLTTPCCATracklet;
 #ifdef EXTERN_ROW_HITS
 	calink *lnkLeft = sliceLeft.fTrackletRowHits, *lnkRight = sliceRight.fTrackletRowHits;
-	sliceLeft.fTrackletRowHits = sliceRight.fTrackletRowHits = new calink[HLTCA_ROW_COUNT];
+	sliceLeft.fTrackletRowHits = sliceRight.fTrackletRowHits = fGlobalTrackletRowHits ? fGlobalTrackletRowHits : new calink[HLTCA_ROW_COUNT];
 #endif
 
 	for (int i = 0;i < fCommonMem->fNLocalTracks;i++)
@@ -915,10 +1189,10 @@ GPUh() void AliHLTTPCCATracker::PerformGlobalTracking(AliHLTTPCCATracker& sliceL
 	}
 	
 	sliceLeft.fCommonMem->fNTracklets = nTrkLeft;sliceRight.fCommonMem->fNTracklets = nTrkRight;
-	delete sliceLeft.fTracklets;
+	if (sliceLeft.fTracklets != fGlobalTracklet) delete sliceLeft.fTracklets;
 	sliceLeft.fTracklets = trkLeft;sliceRight.fTracklets = trkRight;
 #ifdef EXTERN_ROW_HITS
-	delete[] sliceLeft.fTrackletRowHits;
+	if (sliceLeft.fTrackletRowHits != fGlobalTrackletRowHits) delete[] sliceLeft.fTrackletRowHits;
 	sliceLeft.fTrackletRowHits = lnkLeft;sliceRight.fTrackletRowHits = lnkRight;
 #endif
 	StopTimer(8);
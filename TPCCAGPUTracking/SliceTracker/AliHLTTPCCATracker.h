@@ -35,6 +35,7 @@ MEM_CLASS_PRE() class AliHLTTPCCARow;
         #define GPUCODE
     #endif
     #include "../cmodules/timer.h"
+    #include "../cmodules/perfcounter.h"
     #ifdef HLTCA_GPUCODE
         #undef GPUCODE
     #endif
@@ -72,6 +73,7 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
       fClusterData( 0 ),
       fData(),
       fIsGPUTracker( false ),
+      fKeepData( false ),
       fGPUDebugLevel( 0 ),
       fNMaxTracks( 0 ),
       fGPUDebugOut( 0 ),
@@ -94,6 +96,12 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
       fTrackletRowHits( NULL ),
       fTracks( 0 ),
       fTrackHits( 0 ),
+      fSortTrackOrder( NULL ),
+      fSortTracks( NULL ),
+      fSortTrackHits( NULL ),
+      fGlobalTracklet( NULL ),
+      fGlobalTrackletRowHits( NULL ),
+      fOutputTrackOrder( NULL ),
       fOutput( 0 )
   {
   }
@@ -140,6 +148,10 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
   void ReconstructOutput();
 #endif //!HLTCA_GPUCODE
   void DoTracking();
+  void DoTrackingPass();
+#if !defined(HLTCA_GPUCODE)
+  void DoIterativeTracking();
+#endif
   
   //Make Reconstruction steps directly callable (Used for GPU debugging)
   void RunNeighboursFinder();
@@ -147,6 +159,9 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
   void RunStartHitsFinder();
   void RunTrackletConstructor();
   void RunTrackletSelector();
+#if !defined(HLTCA_GPUCODE)
+  void SortTracksDeterministic();
+#endif
   
   //GPU Tracker Interface
   void SetGPUTracker();
@@ -175,6 +190,9 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
   GPUhd() AliHLTTPCCAClusterData *ClusterData() const { return fClusterData; }
 
   GPUh() void ClearSliceDataHitWeights() {fData.ClearHitWeights();}
+  GPUh() void SetSliceDataSnapshot(bool v) {fData.EnableSnapshot(v);}
+  GPUh() void SetKeepData(bool v) {fKeepData = v;}
+  GPUh() void InvalidateSliceDataSnapshot() {fData.InvalidateSnapshot();}
   GPUh() MakeType(const MEM_LG(AliHLTTPCCARow)&) Row( const AliHLTTPCCAHitId &HitId ) const { return fData.Row( HitId.RowIndex() ); }
 
   GPUhd() AliHLTTPCCASliceOutput** Output() const { return fOutput; }
@@ -208,6 +226,13 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
   void SetPointersHits( int MaxNHits );
   void SetPointersTracklets ( int MaxNTracklets );
   void SetPointersTracks( int MaxNTracks, int MaxNHits );
+  void ClearScratchPointers() { fSortTrackOrder = NULL; fSortTracks = NULL; fSortTrackHits = NULL; fGlobalTracklet = NULL; fGlobalTrackletRowHits = NULL; fOutputTrackOrder = NULL; }
+#if !defined(HLTCA_GPUCODE)
+  //Memory of the CPU tracker: buffers are registered with their lifetime in these stages, buffers that are not alive at the same time share memory
+  enum MemoryStage { kMemStageStartHits = 0, kMemStageTrackletConstructor, kMemStageTrackletSelector, kMemStageSortTracks, kMemStageGlobalTracking, kMemStageOutput };
+  GPUh() void SetPointersHitsPlanned( int MaxNHits );
+  GPUh() void SetPointersTrackletsPlanned( int MaxNTracklets, int MaxNTracks, int MaxNHits );
+#endif
   size_t SetPointersSliceData(const AliHLTTPCCAClusterData *data, bool allocate = false) { return(fData.SetPointers(data, allocate)); }
  
 #if !defined(HLTCA_GPUCODE)
@@ -302,15 +327,17 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
   {
 	int fTtrack;		//Track ID
 	float fSortVal;		//Value to sort for
+	int fSortId;		//Secondary key for deterministic output: LocalTrackId, independent of the track position in memory
   };
 
   void PerformGlobalTracking(AliHLTTPCCATracker& sliceLeft, AliHLTTPCCATracker& sliceRight, int MaxTracksLeft, int MaxTracksRight);
 
 #ifdef HLTCA_STANDALONE  
-  void StartTimer(int i) {if (fGPUDebugLevel) fTimers[i].Start();}
-  void StopTimer(int i) {if (fGPUDebugLevel) fTimers[i].Stop();}
+  void StartTimer(int i) {if (fGPUDebugLevel) fTimers[i].Start(); fPerfCounters[i].Start();}
+  void StopTimer(int i) {if (fGPUDebugLevel) fTimers[i].Stop(); fPerfCounters[i].Stop();}
   double GetTimer(int i) {return fTimers[i].GetElapsedTime();}
-  void ResetTimer(int i) {fTimers[i].Reset();}
+  void ResetTimer(int i) {fTimers[i].Reset(); fPerfCounters[i].Reset();}
+  const PerfCounters& GetPerfCounters(int i) const {return fPerfCounters[i];}
 #else
   void StartTimer(int i) {}
   void StopTimer(int i) {}
@@ -335,7 +362,8 @@ private:
   
   MEM_LG(AliHLTTPCCAParam) fParam; // parameters
 #ifdef HLTCA_STANDALONE
-  HighResTimer fTimers[10];
+  HighResTimer fTimers[12];
+  PerfCounters fPerfCounters[12]; // hardware counters of the same stages as fTimers, counted by the thread processing the slice
 #endif
   
   AliHLTTPCCASliceOutput::outputControlStruct* fOutputControl; // output control
@@ -346,6 +374,7 @@ private:
   MEM_LG(AliHLTTPCCASliceData) fData; // The SliceData object. It is used to encapsulate the storage in memory from the access
   
   char fIsGPUTracker; // is it GPU tracker object
+  char fKeepData; // keep the intermediate buffers (start hits, tracklets) until the output, used by the standalone event display
   int fGPUDebugLevel; // debug level
   int fNMaxTracks;
 
@@ -385,6 +414,14 @@ private:
   //
   GPUglobalref() MEM_GLOBAL(AliHLTTPCCATrack) *fTracks;  // reconstructed tracks
   GPUglobalref() AliHLTTPCCAHitId *fTrackHits;          // array of track hit numbers
+
+  // scratch of the steps after the tracklet selector, placed over the dead tracklets by SetPointersTrackletsPlanned (NULL: allocated on the heap)
+  int *fSortTrackOrder;                    // track order of SortTracksDeterministic
+  AliHLTTPCCATrack *fSortTracks;           // sorted tracks of SortTracksDeterministic
+  AliHLTTPCCAHitId *fSortTrackHits;        // sorted track hits of SortTracksDeterministic
+  AliHLTTPCCATracklet *fGlobalTracklet;    // tracklet followed into the neighbouring slices by PerformGlobalTracking
+  calink *fGlobalTrackletRowHits;          // row hits of fGlobalTracklet
+  trackSortData *fOutputTrackOrder;        // track order of WriteOutput
   
   // output
   
@@ -395,6 +432,9 @@ private:
   AliHLTTPCCATracker &operator=( const AliHLTTPCCATracker& );
   
   static int StarthitSortComparison(const void*a, const void* b);
+#if !defined(HLTCA_GPUCODE)
+  struct DeterministicTrackComparison;
+#endif
 };
 
 #endif //ALIHLTTPCCATRACKER_H
@@ -42,6 +42,9 @@ public:
 	int ProcessSlices(int firstSlice, int sliceCount, AliHLTTPCCAClusterData* pClusterData, AliHLTTPCCASliceOutput** pOutput);
 	double GetTimer(int iSlice, int iTimer);
 	void ResetTimer(int iSlice, int iTimer);
+#ifdef HLTCA_STANDALONE
+	const PerfCounters* GetPerfCounters(int iSlice, int iTimer) const { return(fUseGPUTracker ? NULL : &fCPUTrackers[iSlice].GetPerfCounters(iTimer)); } //Only measured for the CPU tracker
+#endif
 
 	int MaxSliceCount() const { return(fUseGPUTracker ? (fGPUTrackerAvailable ? fGPUTracker->GetSliceCount() : 0) : fCPUSliceCount); }
 	int GetGPUStatus() const { return(fGPUTrackerAvailable + fUseGPUTracker); }
@@ -50,7 +53,9 @@ public:
 	AliHLTTPCCAParam& GetParam(int iSlice) { return(*((AliHLTTPCCAParam*)fCPUTrackers[iSlice].pParam())); }
 	const AliHLTTPCCARow& Row(int iSlice, int iRow) const { return(fCPUTrackers[iSlice].Row(iRow)); }  //TODO: Should be changed to return only row parameters
 
-	void SetKeepData(bool v) {fKeepData = v;}
+	void SetKeepData(bool v) {fKeepData = v;for (int i = 0;i < fgkNSlices;i++) fCPUTrackers[i].SetKeepData(v);}
+	void SetSliceDataSnapshot(bool v) {for (int i = 0;i < fgkNSlices;i++) fCPUTrackers[i].SetSliceDataSnapshot(v);} //Prepare the slice data only once and restore it in further runs of the same event, CPU only
+	void InvalidateSliceDataSnapshots() {for (int i = 0;i < fgkNSlices;i++) fCPUTrackers[i].InvalidateSliceDataSnapshot();}
 
 	AliHLTTPCCAGPUTracker* GetGPUTracker() {return(fGPUTracker);}
 	AliHLTTPCCATracker& CPUTracker(int iSlice) {return(fCPUTrackers[iSlice]);}
@@ -251,7 +251,9 @@ MEM_CLASS_PRE2() GPUdi() void AliHLTTPCCATrackletConstructor::UpdateTracklet
 
 #ifndef HLTCA_GPU_TEXTURE_FETCH_CONSTRUCTOR
       GPUglobalref() const cahit2 *hits = tracker.HitData(row);
+#ifdef HLTCA_GPUCODE
       GPUglobalref() const calink *firsthit = tracker.FirstHitInBin(row);
+#endif
 #endif //!HLTCA_GPU_TEXTURE_FETCH_CONSTRUCTOR
       float fY = tParam.GetY();
       float fZ = tParam.GetZ();
@@ -273,8 +275,14 @@ MEM_CLASS_PRE2() GPUdi() void AliHLTTPCCATrackletConstructor::UpdateTracklet
         {
           int nBinsY = row.Grid().Ny();
           int mybin = bin + k * nBinsY;
+#ifdef HLTCA_GPUCODE
           unsigned int hitFst = TEXTUREFetchCons(calink, gAliTexRefu, firsthit, mybin);
           unsigned int hitLst = TEXTUREFetchCons(calink, gAliTexRefu, firsthit, mybin + ny + 1);
+#else
+          int binFst, binLst;
+          tracker.Data().FirstHitInBinRange( row, mybin, ny + 1, binFst, binLst ); // the grid content can be sparse on the CPU
+          unsigned int hitFst = binFst, hitLst = binLst;
+#endif
           for ( unsigned int ih = hitFst; ih < hitLst; ih++ ) {
             assert( (signed) ih < row.NHits() );
             cahit2 hh = TEXTUREFetchCons(cahit2, gAliTexRefu2, hits, ih);
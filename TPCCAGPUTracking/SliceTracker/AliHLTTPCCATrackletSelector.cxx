@@ -25,6 +25,60 @@
 #include "AliHLTTPCCATracklet.h"
 #include "AliHLTTPCCAMath.h"
 
+GPUdi() void AliHLTTPCCATrackletSelector::SegmentInit( SegmentState &st, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker, GPUglobalref() const MEM_GLOBAL(AliHLTTPCCATracklet) &tracklet )
+{
+	st.fIRow = tracklet.FirstRow();
+	st.fLastRow = tracklet.LastRow();
+	st.fWeight = tracklet.HitWeight();
+	st.fMinHits = tracker.Param().MinNTrackClusters() == -1 ? TRACKLET_SELECTOR_MIN_HITS(tracklet.Param().QPt()) : tracker.Param().MinNTrackClusters();
+	st.fGap = 0;
+	st.fNShared = 0;
+	st.fNHits = 0;
+	st.fEnd = false;
+}
+
+GPUdi() void AliHLTTPCCATrackletSelector::SegmentNext( SegmentState &st )
+{
+	if ( st.fEnd ) {
+		st.fNHits = 0;
+		st.fGap = 0;
+		st.fNShared = 0;
+		st.fEnd = false;
+	}
+	st.fIRow++;
+}
+
+GPUdi() int AliHLTTPCCATrackletSelector::SegmentRow( SegmentState &st, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker, GPUglobalref() const MEM_GLOBAL(AliHLTTPCCATracklet) &tracklet, int itr, int nTracklets, calink &ih )
+{
+	const int kMaxRowGap = 4;
+	const float kMaxShared = .1;
+
+	int flags = 0;
+	st.fGap++;
+#ifdef EXTERN_ROW_HITS
+	ih = tracker.TrackletRowHits()[st.fIRow * nTracklets + itr];
+#else
+	ih = tracklet.RowHit( st.fIRow );
+#endif //EXTERN_ROW_HITS
+	if ( ih != CALINK_INVAL ) {
+		GPUglobalref() const MEM_GLOBAL(AliHLTTPCCARow) &row = tracker.Row( st.fIRow );
+		bool own = ( tracker.HitWeight( row, ih ) <= st.fWeight );
+		bool sharedOK = ( ( st.fNShared < st.fNHits * kMaxShared ) );
+		if ( own || sharedOK ) {//SG!!!
+			st.fGap = 0;
+			st.fNHits++;
+			if ( !own ) st.fNShared++;
+			flags |= kSegmentHit;
+		}
+	}
+
+	if ( st.fGap > kMaxRowGap || st.fIRow == st.fLastRow ) {
+		st.fEnd = true;
+		if ( st.fNHits >= st.fMinHits ) flags |= kSegmentTrack; //SG!!!
+	}
+	return flags;
+}
+
 GPUdi() void AliHLTTPCCATrackletSelector::Thread
 ( int nBlocks, int nThreads, int iBlock, int iThread, int iSync,
  GPUsharedref() MEM_LOCAL(AliHLTTPCCASharedMemory) &s, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker )
@@ -50,83 +104,161 @@ GPUdi() void AliHLTTPCCATrackletSelector::Thread
 			}
 
 			GPUglobalref() MEM_GLOBAL(AliHLTTPCCATracklet) &tracklet = tracker.Tracklets()[itr];
-			const int kMaxRowGap = 4;
-			const float kMaxShared = .1;
-
-			int firstRow = tracklet.FirstRow();
-			int lastRow = tracklet.LastRow();
-
-			const int w = tracklet.HitWeight();
-
-			int irow = firstRow;
 
-			int gap = 0;
-			int nShared = 0;
-			nHits = 0;
-			const int minHits = tracker.Param().MinNTrackClusters() == -1 ? TRACKLET_SELECTOR_MIN_HITS(tracklet.Param().QPt()) : tracker.Param().MinNTrackClusters();
-
-			for (irow = firstRow; irow <= lastRow && lastRow - irow + nHits >= minHits; irow++ )
+			SegmentState st;
+			for ( SegmentInit( st, tracker, tracklet ); SegmentContinue( st ); SegmentNext( st ) )
 			{
-				gap++;
-#ifdef EXTERN_ROW_HITS
-				calink ih = tracker.TrackletRowHits()[irow * s.fNTracklets + itr];
-#else
-				calink ih = tracklet.RowHit( irow );
-#endif //EXTERN_ROW_HITS
-				if ( ih != CALINK_INVAL ) {
-					GPUglobalref() const MEM_GLOBAL(AliHLTTPCCARow) &row = tracker.Row( irow );
-					bool own = ( tracker.HitWeight( row, ih ) <= w );
-					bool sharedOK = ( ( nShared < nHits * kMaxShared ) );
-					if ( own || sharedOK ) {//SG!!!
-						gap = 0;
+				calink ih;
+				const int flags = SegmentRow( st, tracker, tracklet, itr, s.fNTracklets, ih );
+				if ( flags & kSegmentHit ) {
+					nHits = st.fNHits - 1;
 #if HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE != 0
-						if (nHits < HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE)
-							s.fHits[iThread][nHits].Set( irow, ih );
-						else
+					if (nHits < HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE)
+						s.fHits[iThread][nHits].Set( st.fIRow, ih );
+					else
 #endif //HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE != 0
-							trackHits[nHits - HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE].Set( irow, ih );
-						nHits++;
-						if ( !own ) nShared++;
-					}
+						trackHits[nHits - HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE].Set( st.fIRow, ih );
 				}
 
-				if ( gap > kMaxRowGap || irow == lastRow ) { // store
-					if ( nHits >= minHits ) { //SG!!!
-						int itrout = CAMath::AtomicAdd( tracker.NTracks(), 1 );
+				if ( flags & kSegmentTrack ) { // store
+					nHits = st.fNHits;
+					int itrout = CAMath::AtomicAdd( tracker.NTracks(), 1 );
 #ifdef HLTCA_GPUCODE
-						if (itrout >= HLTCA_GPU_MAX_TRACKS)
+					if (itrout >= HLTCA_GPU_MAX_TRACKS)
 #else
-						if (itrout >= tracker.CommonMemory()->fNTracklets * 2 + 50)
+					if (itrout >= tracker.CommonMemory()->fNTracklets * 2 + 50)
 #endif //HLTCA_GPUCODE
+					{
+						tracker.GPUParameters()->fGPUError = HLTCA_GPU_ERROR_TRACK_OVERFLOW;
+						CAMath::AtomicExch( tracker.NTracks(), 0 );
+						return;
+					}
+					nFirstTrackHit = CAMath::AtomicAdd( tracker.NTrackHits(), nHits );
+					tracker.Tracks()[itrout].SetAlive(1);
+					tracker.Tracks()[itrout].SetLocalTrackId(itrout);
+					tracker.Tracks()[itrout].SetParam(tracklet.Param());
+					tracker.Tracks()[itrout].SetFirstHitID(nFirstTrackHit);
+					tracker.Tracks()[itrout].SetNHits(nHits);
+					for ( int jh = 0; jh < nHits; jh++ ) {
+#if HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE != 0
+						if (jh < HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE)
 						{
-							tracker.GPUParameters()->fGPUError = HLTCA_GPU_ERROR_TRACK_OVERFLOW;
-							CAMath::AtomicExch( tracker.NTracks(), 0 );
-							return;
+							tracker.TrackHits()[nFirstTrackHit + jh] = s.fHits[iThread][jh];
 						}
-						nFirstTrackHit = CAMath::AtomicAdd( tracker.NTrackHits(), nHits );
-						tracker.Tracks()[itrout].SetAlive(1);
-						tracker.Tracks()[itrout].SetLocalTrackId(itrout);
-						tracker.Tracks()[itrout].SetParam(tracklet.Param());
-						tracker.Tracks()[itrout].SetFirstHitID(nFirstTrackHit);
-						tracker.Tracks()[itrout].SetNHits(nHits);
-						for ( int jh = 0; jh < nHits; jh++ ) {
-#if HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE != 0
-							if (jh < HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE)
-							{
-								tracker.TrackHits()[nFirstTrackHit + jh] = s.fHits[iThread][jh];
-							}
-							else
+						else
 #endif //HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE != 0
-							{
-								tracker.TrackHits()[nFirstTrackHit + jh] = trackHits[jh - HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE];
-							}
+						{
+							tracker.TrackHits()[nFirstTrackHit + jh] = trackHits[jh - HLTCA_GPU_TRACKLET_SELECTOR_HITS_REG_SIZE];
 						}
 					}
-					nHits = 0;
-					gap = 0;
-					nShared = 0;
 				}
 			}
 		}
 	}
 }
+
+#if !defined(HLTCA_GPUCODE)
+GPUh() void AliHLTTPCCATrackletSelector::AliHLTTPCCATrackletSelectorCPU( AliHLTTPCCATracker &tracker )
+{
+	// Two-phase tracklet selector for the CPU, selects the same tracks as Thread() without atomics.
+	// Phase 1: every tracklet independently splits its hits into track segments (SegmentRow(), as in Thread()),
+	//          and stores them in a compact per-tracklet region of a candidate buffer.
+	// Phase 2: the output track and hit offsets are obtained by a prefix sum over the per-tracklet counts,
+	//          the segments are then copied to their final positions.
+	// Tracks are stored in tracklet order, as by the sequential AliHLTTPCCAProcess<AliHLTTPCCATrackletSelector>.
+	// Both phases are independent per tracklet, but run serially: the CPU tracker is parallelized over the slices
+	// (AliHLTTPCCATrackerFramework), and nested OpenMP regions would not get any threads.
+
+	const int nTracklets = *tracker.NTracklets();
+	*tracker.NTracks() = 0;
+	*tracker.NTrackHits() = 0;
+	if (nTracklets == 0) return;
+
+	int* candOffset = new int[nTracklets + 1];
+	int* nSegments = new int[nTracklets + 1];
+	int* nSegmentHits = new int[nTracklets + 1];
+	candOffset[0] = 0;
+	for (int itr = 0;itr < nTracklets;itr++)
+	{
+		const AliHLTTPCCATracklet &tracklet = tracker.Tracklets()[itr];
+		candOffset[itr + 1] = candOffset[itr] + (tracklet.NHits() ? tracklet.LastRow() - tracklet.FirstRow() + 1 : 0);
+	}
+	AliHLTTPCCAHitId* candHits = new AliHLTTPCCAHitId[candOffset[nTracklets]];
+	int* candSegmentNHits = new int[candOffset[nTracklets]];
+
+	// Phase 1: find the segments of every tracklet
+	for (int itr = 0;itr < nTracklets;itr++)
+	{
+		const AliHLTTPCCATracklet &tracklet = tracker.Tracklets()[itr];
+		int nSeg = 0, nStored = 0;
+		if (tracklet.NHits())
+		{
+			AliHLTTPCCAHitId* hits = candHits + candOffset[itr];
+			int* segNHits = candSegmentNHits + candOffset[itr];
+
+			SegmentState st;
+			for ( SegmentInit( st, tracker, tracklet ); SegmentContinue( st ); SegmentNext( st ) )
+			{
+				calink ih;
+				const int flags = SegmentRow( st, tracker, tracklet, itr, nTracklets, ih );
+				if ( flags & kSegmentHit ) hits[nStored + st.fNHits - 1].Set( st.fIRow, ih );
+				if ( flags & kSegmentTrack ) {
+					segNHits[nSeg++] = st.fNHits;
+					nStored += st.fNHits;
+				}
+			}
+		}
+		nSegments[itr] = nSeg;
+		nSegmentHits[itr] = nStored;
+	}
+
+	// Phase 2: exclusive prefix sums give the output positions
+	int nTracks = 0, nTrackHits = 0;
+	for (int itr = 0;itr < nTracklets;itr++)
+	{
+		const int nSeg = nSegments[itr], nSegHits = nSegmentHits[itr];
+		nSegments[itr] = nTracks;
+		nSegmentHits[itr] = nTrackHits;
+		nTracks += nSeg;
+		nTrackHits += nSegHits;
+	}
+	nSegments[nTracklets] = nTracks;
+	nSegmentHits[nTracklets] = nTrackHits;
+
+	if (nTracks > tracker.CommonMemory()->fNTracklets * 2 + 50)
+	{
+		tracker.GPUParameters()->fGPUError = HLTCA_GPU_ERROR_TRACK_OVERFLOW;
+	}
+	else
+	{
+		for (int itr = 0;itr < nTracklets;itr++)
+		{
+			const AliHLTTPCCATracklet &tracklet = tracker.Tracklets()[itr];
+			const AliHLTTPCCAHitId* hits = candHits + candOffset[itr];
+			const int* segNHits = candSegmentNHits + candOffset[itr];
+			int itrout = nSegments[itr];
+			int iHitOut = nSegmentHits[itr];
+			for (int iSeg = 0;iSeg < nSegments[itr + 1] - nSegments[itr];iSeg++, itrout++)
+			{
+				const int nHits = segNHits[iSeg];
+				tracker.Tracks()[itrout].SetAlive(1);
+				tracker.Tracks()[itrout].SetLocalTrackId(itrout);
+				tracker.Tracks()[itrout].SetParam(tracklet.Param());
+				tracker.Tracks()[itrout].SetFirstHitID(iHitOut);
+				tracker.Tracks()[itrout].SetNHits(nHits);
+				for ( int jh = 0; jh < nHits; jh++ ) tracker.TrackHits()[iHitOut + jh] = hits[jh];
+				hits += nHits;
+				iHitOut += nHits;
+			}
+		}
+		*tracker.NTracks() = nTracks;
+		*tracker.NTrackHits() = nTrackHits;
+	}
+
+	delete[] candSegmentNHits;
+	delete[] candHits;
+	delete[] nSegmentHits;
+	delete[] nSegments;
+	delete[] candOffset;
+}
+#endif //!HLTCA_GPUCODE
@@ -14,6 +14,7 @@
 #include "AliHLTTPCCAHitId.h"
 #include "AliHLTTPCCAGPUConfig.h"
 MEM_CLASS_PRE() class AliHLTTPCCATracker;
+MEM_CLASS_PRE() class AliHLTTPCCATracklet;
 
 /**
  * @class AliHLTTPCCATrackletSelector
@@ -40,6 +41,32 @@ class AliHLTTPCCATrackletSelector
     GPUd() static void Thread( int nBlocks, int nThreads, int iBlock, int iThread, int iSync,
                                 MEM_LOCAL(GPUsharedref() AliHLTTPCCASharedMemory) &smem, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker );
 
+#if !defined(HLTCA_GPUCODE)
+    GPUh() static void AliHLTTPCCATrackletSelectorCPU( AliHLTTPCCATracker &tracker );
+#endif //!HLTCA_GPUCODE
+
+  protected:
+    // Splitting of one tracklet into track segments, common to Thread() and AliHLTTPCCATrackletSelectorCPU():
+    // for ( SegmentInit(...); SegmentContinue( st ); SegmentNext( st ) ) { int flags = SegmentRow(...); ... }
+    struct SegmentState
+    {
+      int fIRow; // current row
+      int fLastRow; // last row of the tracklet
+      int fWeight; // hit weight of the tracklet
+      int fMinHits; // min number of hits of a segment to be stored as track
+      int fGap; // number of rows since the last hit of the segment
+      int fNShared; // number of hits of the segment with a higher weight from other tracklets
+      int fNHits; // number of hits of the segment
+      bool fEnd; // the segment ended at the current row
+    };
+    enum { kSegmentHit = 1, kSegmentTrack = 2 };
+
+    GPUd() static void SegmentInit( SegmentState &st, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker, GPUglobalref() const MEM_GLOBAL(AliHLTTPCCATracklet) &tracklet );
+    GPUd() static bool SegmentContinue( const SegmentState &st ) { return st.fIRow <= st.fLastRow && st.fLastRow - st.fIRow + st.fNHits >= st.fMinHits; }
+    GPUd() static void SegmentNext( SegmentState &st );
+    // Process row st.fIRow: kSegmentHit is set if the hit ih of the row was added to the segment as hit st.fNHits - 1,
+    // kSegmentTrack is set if the segment ends at this row and is to be stored as a track with st.fNHits hits.
+    GPUd() static int SegmentRow( SegmentState &st, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker, GPUglobalref() const MEM_GLOBAL(AliHLTTPCCATracklet) &tracklet, int itr, int nTracklets, calink &ih );
 };
 
 
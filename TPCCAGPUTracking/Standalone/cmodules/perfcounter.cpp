@@ -0,0 +1,177 @@
+#include "perfcounter.h"
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PERFCOUNTER_LINUX
+#endif
+
+static bool enabled = false;
+static int available = -1; //Bitmask of the counters that could be opened, -1 if not yet tested
+
+static const char* const counterNames[PerfCounters::kNCounters] = {"Cycles", "Instructions", "LLC Misses", "Branch Misses", "dTLB Misses"};
+
+#ifdef PERFCOUNTER_LINUX
+struct PerfCounterGroup
+{
+	int fd[PerfCounters::kNCounters];
+	int index[PerfCounters::kNCounters]; //Position of the counter in the group read buffer
+	int nOpen;
+	bool initialized;
+
+	PerfCounterGroup() : nOpen(0), initialized(false)
+	{
+		for (int i = 0;i < PerfCounters::kNCounters;i++) fd[i] = index[i] = -1;
+	}
+	~PerfCounterGroup()
+	{
+		for (int i = 0;i < PerfCounters::kNCounters;i++) if (fd[i] != -1) close(fd[i]);
+	}
+
+	void Init()
+	{
+		initialized = true;
+		static const unsigned int types[PerfCounters::kNCounters] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+		static const unsigned long long configs[PerfCounters::kNCounters] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+			PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+		int leader = -1;
+		int mask = 0;
+		for (int i = 0;i < PerfCounters::kNCounters;i++)
+		{
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = types[i];
+			attr.config = configs[i];
+			attr.disabled = leader == -1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+			if (fd[i] == -1) continue;
+			if (leader == -1) leader = fd[i];
+			index[i] = nOpen++;
+			mask |= 1 << i;
+		}
+		if (leader != -1) ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#pragma omp critical(PerfCountersAvailable)
+		available = available == -1 ? mask : (available & mask);
+	}
+
+	bool Read(unsigned long long* values)
+	{
+		if (!initialized) Init();
+		memset(values, 0, PerfCounters::kNCounters * sizeof(values[0]));
+		if (nOpen == 0) return(false);
+		unsigned long long buffer[3 + PerfCounters::kNCounters]; //nr, time enabled, time running, values
+		int leader = -1;
+		for (int i = 0;i < PerfCounters::kNCounters && leader == -1;i++) leader = fd[i];
+		if (read(leader, buffer, (3 + nOpen) * sizeof(buffer[0])) != (ssize_t) ((3 + nOpen) * sizeof(buffer[0]))) return(false);
+		//Scale if the group was not always scheduled (more groups than hardware counters)
+		const double scale = buffer[2] && buffer[2] < buffer[1] ? (double) buffer[1] / buffer[2] : 1.;
+		for (int i = 0;i < PerfCounters::kNCounters;i++) if (index[i] != -1) values[i] = (unsigned long long) (buffer[3 + index[i]] * scale);
+		return(true);
+	}
+};
+
+static thread_local PerfCounterGroup threadGroup;
+#endif
+
+PerfCounters::PerfCounters() : running(0)
+{
+	Reset();
+}
+
+void PerfCounters::Start()
+{
+	if (!enabled) return;
+	Read(startCount);
+	running = 1;
+}
+
+void PerfCounters::Stop()
+{
+	if (running == 0) return;
+	running = 0;
+	unsigned long long endCount[kNCounters];
+	Read(endCount);
+	for (int i = 0;i < kNCounters;i++) count[i] += endCount[i] - startCount[i];
+}
+
+void PerfCounters::Reset()
+{
+	memset(count, 0, sizeof(count));
+	memset(startCount, 0, sizeof(startCount));
+	running = 0;
+}
+
+void PerfCounters::Add(const unsigned long long* start, const unsigned long long* end)
+{
+	if (!enabled) return;
+	for (int i = 0;i < kNCounters;i++)
+	{
+		const unsigned long long diff = end[i] - start[i];
+#pragma omp atomic
+		count[i] += diff;
+	}
+}
+
+void PerfCounters::Add(const PerfCounters& other)
+{
+	for (int i = 0;i < kNCounters;i++) count[i] += other.count[i];
+}
+
+void PerfCounters::AddCurrentTo(PerfCounters& target, bool restart)
+{
+	if (running == 0) return;
+	unsigned long long endCount[kNCounters];
+	Read(endCount);
+	for (int i = 0;i < kNCounters;i++) target.count[i] += endCount[i] - startCount[i];
+	if (restart) memcpy(startCount, endCount, sizeof(startCount));
+	else running = 0;
+}
+
+void PerfCounters::Print(const char* task, double nClusters) const
+{
+	printf("Perf Counters: Task: %20s", task);
+	if (IsAvailable(kCycles) && IsAvailable(kInstructions)) printf(" IPC %5.2f", count[kCycles] ? (double) count[kInstructions] / count[kCycles] : 0.);
+	if (nClusters <= 0) nClusters = 1;
+	for (int i = 0;i < kNCounters;i++)
+	{
+		if (IsAvailable(i)) printf(" - %s/Cl %9.3f", counterNames[i], count[i] / nClusters);
+		else printf(" - %s n/a", counterNames[i]);
+	}
+	printf("\n");
+}
+
+void PerfCounters::SetEnabled(bool enable)
+{
+	enabled = enable;
+}
+
+bool PerfCounters::IsEnabled()
+{
+	return(enabled);
+}
+
+bool PerfCounters::IsAvailable(int i)
+{
+	return(available != -1 && (available & (1 << i)));
+}
+
+const char* PerfCounters::GetName(int i)
+{
+	return(counterNames[i]);
+}
+
+bool PerfCounters::Read(unsigned long long* values)
+{
+#ifdef PERFCOUNTER_LINUX
+	if (enabled) return(threadGroup.Read(values));
+#endif
+	memset(values, 0, kNCounters * sizeof(values[0]));
+	return(false);
+}
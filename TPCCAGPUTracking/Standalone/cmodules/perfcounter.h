@@ -0,0 +1,37 @@
+#ifndef QONMODULE_PERFCOUNTER_H
+#define QONMODULE_PERFCOUNTER_H
+
+//Hardware performance counters (Linux perf_event_open), used like HighResTimer.
+//The counters are opened as one group per thread on first use, and count only the calling thread (user space).
+//Start / Stop must be called from the same thread. For parallel regions, every thread calls Read at the begin and end of its share and passes both to Add.
+//Everything is a no-op unless enabled with SetEnabled, counters not supported by the CPU / kernel report IsAvailable() == false.
+
+class PerfCounters {
+
+public:
+	enum {kCycles = 0, kInstructions, kLLCMisses, kBranchMisses, kDTLBMisses, kNCounters};
+
+	PerfCounters();
+	void Start();
+	void Stop();
+	void Reset();
+	void Add(const unsigned long long* start, const unsigned long long* end);
+	void Add(const PerfCounters& other);
+	void AddCurrentTo(PerfCounters& target, bool restart = true); //Adds the counts since Start to target, like HighResTimer::GetCurrentElapsedTime
+	void Print(const char* task, double nClusters) const; //IPC and counts per cluster
+	unsigned long long GetCount(int i) const {return count[i];}
+	int IsRunning() {return running;}
+
+	static void SetEnabled(bool enable);
+	static bool IsEnabled();
+	static bool IsAvailable(int i);
+	static const char* GetName(int i);
+	static bool Read(unsigned long long* values); //Current values of the calling thread, scaled for multiplexing
+
+private:
+	unsigned long long count[kNCounters];
+	unsigned long long startCount[kNCounters];
+	int running;
+};
+
+#endif
@@ -43,4 +43,9 @@ INCLUDEPATHSSYSTEM			+= $(shell root-config --incdir)
 LIBSUSE						+= $(shell root-config --libs)
 endif
 
+ifeq ($(BUILD_ZLIB), 1)
+DEFINES						+= HLTCA_BUILD_ZLIB
+LIBSUSE						+= -lz
+endif
+
 ALLDEP						+= config_common.mak config_options.mak
@@ -15,7 +15,7 @@ CC_i686-pc-cygwin			= ICC
 
 INCLUDEPATHS				= include SliceTracker HLTHeaders Merger GlobalTracker TRDTracking Common
 DEFINES						= HLTCA_STANDALONE HLTCA_ENABLE_GPU_TRACKER
-CPPFILES					= cmodules/timer.cpp
+CPPFILES					= cmodules/timer.cpp cmodules/perfcounter.cpp
 
 EXTRAFLAGSGCC				= -Weffc++
 EXTRAFLAGSLINK				= -rdynamic
@@ -30,6 +30,7 @@ CONFIG_LTO					= 1
 CXXFILES					= SliceTracker/AliHLTTPCCASliceData.cxx \
 								SliceTracker/AliHLTTPCCASliceOutput.cxx \
 								SliceTracker/AliHLTTPCCATracker.cxx \
+								SliceTracker/AliHLTTPCCAMemoryPlanner.cxx \
 								SliceTracker/AliHLTTPCCARow.cxx \
 								SliceTracker/AliHLTTPCCANeighboursFinder.cxx \
 								SliceTracker/AliHLTTPCCANeighboursCleaner.cxx \
@@ -46,11 +47,14 @@ CXXFILES					= SliceTracker/AliHLTTPCCASliceData.cxx \
 
 HLTCA_MERGER_CXXFILES		= Merger/AliHLTTPCGMMerger.cxx \
 								Merger/AliHLTTPCGMSliceTrack.cxx \
+								Merger/AliHLTTPCGMSliceTrackBatch.cxx \
 								Merger/AliHLTTPCGMPhysicalTrackModel.cxx \
 								Merger/AliHLTTPCGMPolynomialField.cxx \
 								Merger/AliHLTTPCGMPolynomialFieldCreator.cxx \
 								Merger/AliHLTTPCGMPropagator.cxx \
-								Merger/AliHLTTPCGMTrackParam.cxx
+								Merger/AliHLTTPCGMTrackParam.cxx \
+								Merger/AliHLTTPCGMResidualCollector.cxx \
+								Merger/AliHLTTPCGMReferenceFitter.cxx
 
 HLTCA_TRD_CXXFILES			= TRDTracking/AliHLTTRDTrack.cxx \
 								TRDTracking/AliHLTTRDTracker.cxx \
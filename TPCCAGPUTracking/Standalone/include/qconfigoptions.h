@@ -61,7 +61,9 @@ AddOption(noprompt, bool, true, "prompt", 0, "Do prompt for keypress before exit
 AddOption(continueOnError, bool, false, "continue", 0, "Continue processing after an error")
 AddOption(writeoutput, bool, false, "write", 0, "Write tracks found to text output file")
 AddOption(writebinary, bool, false, "writeBinary", 0, "Write tracks found to binary output file")
+AddOption(compressbinary, bool, false, "compressBinary", 0, "zlib-compress the blocks of the binary output file (needs BUILD_ZLIB)")
 AddOption(DebugLevel, int, 0, "debug", 'd', "Set debug level")
+AddOption(perfCounters, bool, false, "perfCounters", 0, "Measure hardware performance counters (Linux perf_event) for the tracking and merging stages (CPU only)")
 AddOption(seed, int, -1, "seed", 0, "Set srand seed (-1: random)")
 AddOption(cleardebugout, bool, false, "clearDebugFile", 0, "Clear debug output file when processing next event")
 AddOption(sliceCount, int, -1, "sliceCount", 0, "Number of slices to process (-1: all)", min(-1), max(36))
@@ -73,6 +75,7 @@ AddOption(merger, int, 1, "runMerger", 0, "Run track merging / refit", min(0), m
 AddOption(runs, int, 1, "runs", 'r', "Number of iterations to perform (repeat each event)", min(1))
 AddOption(runs2, int, 1, "runsExternal", 0, "Number of iterations to perform (repeat full processing)", min(1))
 AddOption(runsInit, int, 0, "runsInit", 0, "Number of initial iterations excluded from average", min(0))
+AddOption(runsSnapshot, bool, false, "runsSnapshot", 0, "Prepare the slice data (grids, packed hits) only in the first iteration of an event and restore it from a snapshot in the further iterations (CPU only)")
 AddOption(EventsDir, const char*, "pp", "events", 'e', "Directory with events to process", message("Reading events from Directory events/%s"))
 AddOption(OMPThreads, int, -1, "omp", 't', "Number of OMP threads to run (-1: all)", min(-1), message("Using %d OMP threads"))
 AddOption(eventDisplay, bool, false, "display", 'd', "Show standalone event display", message("Event display: %s"))
@@ -83,15 +86,26 @@ AddOption(nways, int, 3, "NWays", 0, "Use n-way track-fit", min(1))
 AddOptionSet(nways, int, 3, "3Way", 0, "Use 3-way track-fit")
 AddOptionSet(nways, int, 1, "1Way", 0, "Use 3-way track-fit")
 AddOption(nwaysouter, bool, false, "OuterParam", 0, "Create OuterParam")
+AddOption(dEdx, bool, false, "dEdx", 0, "Compute truncated mean dE/dx (IROC / OROC) in the merger refit")
+AddOption(mergeLoopers, bool, false, "mergeLoopers", 0, "Link the legs of low-pt loopers in the merger, refit only one leg")
+AddOption(mergerScalar, bool, false, "mergerScalar", 0, "Unpack and transport the slice tracks in the merger one by one (reference for the batched version)")
+AddOption(fitMaxNRejected, int, 0, "fitMaxNRejected", 0, "Stop the refit of a track after n consecutive rejected clusters (0 = disabled)", min(0))
+AddOption(fitMaxChi2NDF, float, 0.f, "fitMaxChi2NDF", 0, "Stop the refit of a track if its chi2/NDF exceeds this value (0 = disabled)", min(0.f))
 AddOption(dzdr, float, 2.5f, "DzDr", 0, "Use dZ/dR search window instead of vertex window")
 AddOption(cont, bool, false, "continuous", 0, "Process continuous timeframe data")
+AddOption(deterministic, bool, false, "deterministic", 0, "Canonical ordering of slice tracks and merger inputs, output independent of thread scheduling")
+AddOption(sparseGrid, bool, false, "sparseGrid", 0, "Store only the occupied bins of the row grids of the slice tracker (CPU only)")
+AddOption(trackingPasses, int, 1, "trackingPasses", 0, "Number of slice tracking passes, further passes run with looser cuts on the hits not attached to good tracks (CPU only)")
 AddOption(outputcontrolmem, unsigned long long int, 0, "outputMemory", 0, "Use predefined output buffer of this size", min(0ull), message("Using %lld bytes as output memory"))
 AddOption(affinity, int, -1, "cpuAffinity", 0, "Pin CPU affinity to this CPU core", min(-1), message("Setting affinity to restrict on CPU %d"))
 AddOption(fifo, bool, false, "fifoScheduler", 0, "Use FIFO realtime scheduler", message("Setting FIFO scheduler: %s"))
 AddOption(fpe, bool, true, "fpe", 0, "Trap on floating point exceptions")
 AddOption(solenoidBz, float, -1e6f, "solenoidBz", 0, "Field strength of solenoid Bz in kGaus")
 AddOption(constBz, bool, false, "constBz", 0, "Force constand Bz")
+AddOption(fieldMap, const char*, NULL, "fieldMap", 0, "Fit polynomial field from tabulated field map in binary file (int n, float Bz [kG], n x float x, y, z, Bx, By, Bz)")
 AddOption(referenceX, float, 500.f, "referenceX", 0, "Reference X position to transport track to after fit")
+AddOption(residuals, const char*, NULL, "residuals", 0, "Collect the cluster residuals of the refit (needs 3-way fit, CPU refit) and write the binned statistics to this file")
+AddOption(referenceFit, bool, false, "referenceFit", 0, "Refit the merged tracks with the double precision reference fitter and print the pulls of the track parameters")
 AddOptionVec(gpuOptions, tupleGpuOpt, "gpuOpt", 0, "Options for GPU tracker")
 AddOption(printSettings, bool, false, "printSettings", 0, "Print all settings")
 AddHelp("help", 'h')
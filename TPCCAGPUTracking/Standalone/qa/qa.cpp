@@ -11,6 +11,7 @@
 #include "include.h"
 #include <algorithm>
 #include <cstdio>
+#include <omp.h>
 
 #include "TH1F.h"
 #include "TH2F.h"
@@ -106,7 +107,80 @@ std::vector<std::vector<bool>> goodHits;
 #define DEBUG 0
 #define TIMING 0
 
-bool MCComp(const AliHLTTPCClusterMCWeight& a, const AliHLTTPCClusterMCWeight& b) {return(a.fMCID > b.fMCID);}
+std::vector<int> mcLabelOffset;
+std::vector<int> mcLabelIds;
+std::vector<float> mcLabelWeights;
+
+//Counts the MC labels of the clusters of one track in a small open-addressing hash map
+class MCLabelCounter
+{
+public:
+	MCLabelCounter() : fMask(0), fNUsed(0), fKeys(), fCounts(), fWeights(), fUsed() {}
+
+	void Init(int maxLabels)
+	{
+		unsigned int size = 16;
+		while (size < 2 * (unsigned int) maxLabels) size *= 2;
+		if (fKeys.size() < size)
+		{
+			fKeys.assign(size, -1);
+			fCounts.resize(size);
+			fWeights.resize(size);
+			fUsed.resize(size);
+		}
+		else
+		{
+			for (int i = 0;i < fNUsed;i++) fKeys[fUsed[i]] = -1;
+		}
+		fMask = size - 1;
+		fNUsed = 0;
+	}
+
+	void Add(int label, float weight)
+	{
+		unsigned int h = ((unsigned int) label * 2654435761u) & fMask;
+		while (fKeys[h] != -1 && fKeys[h] != label) h = (h + 1) & fMask;
+		if (fKeys[h] == -1)
+		{
+			fKeys[h] = label;
+			fCounts[h] = 0;
+			fWeights[h] = 0.f;
+			fUsed[fNUsed++] = h;
+		}
+		fCounts[h]++;
+		fWeights[h] += weight;
+	}
+
+	int NLabels() const {return(fNUsed);}
+
+	//Label with most clusters, the larger label id wins ties
+	int Dominant(int& count, float& weight, float& sumweight) const
+	{
+		int label = -1;
+		count = 0;
+		weight = sumweight = 0.f;
+		for (int i = 0;i < fNUsed;i++)
+		{
+			const int h = fUsed[i];
+			sumweight += fWeights[h];
+			if (fCounts[h] > count || (fCounts[h] == count && fKeys[h] > label))
+			{
+				label = fKeys[h];
+				count = fCounts[h];
+				weight = fWeights[h];
+			}
+		}
+		return(label);
+	}
+
+private:
+	unsigned int fMask;
+	int fNUsed;
+	std::vector<int> fKeys;
+	std::vector<int> fCounts;
+	std::vector<float> fWeights;
+	std::vector<int> fUsed;
+};
 
 #define Y_MAX 40
 #define Z_MAX 100
@@ -467,90 +541,106 @@ void RunQA(bool matchOnly)
 	
 	if (hlt.GetNMCInfo() && hlt.GetNMCLabels())
 	{
-		//Assign Track MC Labels
+		//Compact per-cluster label array, the labels of cluster i are mcLabelIds[mcLabelOffset[i]] to mcLabelIds[mcLabelOffset[i + 1] - 1]
 		timer.Start();
-		bool ompError = false;
-#if DEBUG == 0
+		const AliHLTTPCClusterMCLabel* mcLabels = hlt.GetMCLabels();
+		const int nMCLabels = hlt.GetNMCLabels();
+		mcLabelOffset.resize(nMCLabels + 1);
+		bool labelError = false;
 #pragma omp parallel for
-#endif
-		for (int i = 0; i < merger.NOutputTracks(); i++)
+		for (int i = 0;i < nMCLabels;i++)
 		{
-			if (ompError) continue;
-			int nClusters = 0;
-			const AliHLTTPCGMMergedTrack &track = merger.OutputTracks()[i];
-			std::vector<AliHLTTPCClusterMCWeight> labels;
-			for (int k = 0;k < track.NClusters();k++)
+			int n = 0;
+			for (int j = 0;j < 3;j++)
 			{
-				if (merger.Clusters()[track.FirstClusterRef() + k].fState & AliHLTTPCGMMergedTrackHit::flagReject) continue;
-				nClusters++;
-				int hitId = merger.Clusters()[track.FirstClusterRef() + k].fNum;
-				if (hitId >= hlt.GetNMCLabels()) {printf("Invalid hit id %d > %d\n", hitId, hlt.GetNMCLabels());ompError = true;break;}
-				for (int j = 0;j < 3;j++)
-				{
-					if (hlt.GetMCLabels()[hitId].fClusterID[j].fMCID >= hlt.GetNMCInfo()) {printf("Invalid label %d > %d\n", hlt.GetMCLabels()[hitId].fClusterID[j].fMCID, hlt.GetNMCInfo());ompError = true;break;}
-					if (hlt.GetMCLabels()[hitId].fClusterID[j].fMCID >= 0)
-					{
-						if (DEBUG >= 3 && track.OK()) printf("Track %d Cluster %d Label %d: %d (%f)\n", i, k, j, hlt.GetMCLabels()[hitId].fClusterID[j].fMCID, hlt.GetMCLabels()[hitId].fClusterID[j].fWeight);
-						labels.push_back(hlt.GetMCLabels()[hitId].fClusterID[j]);
-					}
-				}
-				if (ompError) break;
+				if (mcLabels[i].fClusterID[j].fMCID >= hlt.GetNMCInfo()) {printf("Invalid label %d > %d\n", mcLabels[i].fClusterID[j].fMCID, hlt.GetNMCInfo());labelError = true;}
+				if (mcLabels[i].fClusterID[j].fMCID >= 0) n++;
 			}
-			if (ompError) continue;
-			if (labels.size() == 0)
+			mcLabelOffset[i + 1] = n;
+		}
+		if (labelError) return;
+		mcLabelOffset[0] = 0;
+		for (int i = 0;i < nMCLabels;i++) mcLabelOffset[i + 1] += mcLabelOffset[i];
+		mcLabelIds.resize(mcLabelOffset[nMCLabels]);
+		mcLabelWeights.resize(mcLabelOffset[nMCLabels]);
+#pragma omp parallel for
+		for (int i = 0;i < nMCLabels;i++)
+		{
+			int n = mcLabelOffset[i];
+			for (int j = 0;j < 3;j++)
 			{
-				trackMCLabels[i] = MC_LABEL_INVALID;
-				totalFakes++;
-				continue;
+				if (mcLabels[i].fClusterID[j].fMCID < 0) continue;
+				mcLabelIds[n] = mcLabels[i].fClusterID[j].fMCID;
+				mcLabelWeights[n++] = mcLabels[i].fClusterID[j].fWeight;
 			}
-			std::sort(labels.data(), labels.data() + labels.size(), MCComp);
-			
-			AliHLTTPCClusterMCWeight maxLabel;
-			AliHLTTPCClusterMCWeight cur = labels[0];
-			float sumweight = 0.f;
-			int curcount = 1, maxcount = 0;
-			if (DEBUG >= 2 && track.OK()) for (unsigned int k = 0;k < labels.size();k++) printf("\t%d %f\n", labels[k].fMCID, labels[k].fWeight);
-			for (unsigned int k = 1;k <= labels.size();k++)
+		}
+
+		//Assign Track MC Labels
+		bool ompError = false;
+		int nFakes = 0;
+#if DEBUG == 0
+#pragma omp parallel reduction(+:nFakes)
+#endif
+		{
+			MCLabelCounter counter;
+#if DEBUG == 0
+#pragma omp for schedule(dynamic, 16)
+#endif
+			for (int i = 0; i < merger.NOutputTracks(); i++)
 			{
-				if (k == labels.size() || labels[k].fMCID != cur.fMCID)
+				if (ompError) continue;
+				int nClusters = 0;
+				const AliHLTTPCGMMergedTrack &track = merger.OutputTracks()[i];
+				counter.Init(3 * track.NClusters());
+				for (int k = 0;k < track.NClusters();k++)
 				{
-					sumweight += cur.fWeight;
-					if (curcount > maxcount)
-					{
-						maxLabel = cur;
-						maxcount = curcount;
-					}
-					if (k < labels.size())
+					if (merger.Clusters()[track.FirstClusterRef() + k].fState & AliHLTTPCGMMergedTrackHit::flagReject) continue;
+					nClusters++;
+					int hitId = merger.Clusters()[track.FirstClusterRef() + k].fNum;
+					if (hitId >= nMCLabels) {printf("Invalid hit id %d > %d\n", hitId, nMCLabels);ompError = true;break;}
+					for (int j = mcLabelOffset[hitId];j < mcLabelOffset[hitId + 1];j++)
 					{
-						cur = labels[k];
-						curcount = 1;
+						if (DEBUG >= 3 && track.OK()) printf("Track %d Cluster %d Label %d: %d (%f)\n", i, k, j - mcLabelOffset[hitId], mcLabelIds[j], mcLabelWeights[j]);
+						counter.Add(mcLabelIds[j], mcLabelWeights[j]);
 					}
 				}
-				else
+				if (ompError) continue;
+				if (counter.NLabels() == 0)
 				{
-					cur.fWeight += labels[k].fWeight;
-					curcount++;
+					trackMCLabels[i] = MC_LABEL_INVALID;
+					nFakes++;
+					continue;
+				}
+
+				int maxcount;
+				float maxweight, sumweight;
+				int maxLabel = counter.Dominant(maxcount, maxweight, sumweight);
+				if (maxcount < config.recThreshold * nClusters) maxLabel = -2 - maxLabel;
+				trackMCLabels[i] = maxLabel;
+				if (DEBUG && track.OK() && hlt.GetNMCInfo() > maxLabel)
+				{
+					const AliHLTTPCCAMCInfo& mc = hlt.GetMCInfo()[maxLabel >= 0 ? maxLabel : (-maxLabel - 2)];
+					printf("Track %d label %d weight %f clusters %d (fitted %d) (%f%% %f%%) Pt %f\n", i, maxLabel >= 0 ? maxLabel : (maxLabel + 2), maxweight, nClusters, track.NClustersFitted(), maxweight / sumweight, (float) maxcount / (float) nClusters, std::sqrt(mc.fPx * mc.fPx + mc.fPy * mc.fPy));
 				}
-			}
-			
-			if (maxcount < config.recThreshold * nClusters) maxLabel.fMCID = -2 - maxLabel.fMCID;
-			trackMCLabels[i] = maxLabel.fMCID;
-			if (DEBUG && track.OK() && hlt.GetNMCInfo() > maxLabel.fMCID)
-			{
-				const AliHLTTPCCAMCInfo& mc = hlt.GetMCInfo()[maxLabel.fMCID >= 0 ? maxLabel.fMCID : (-maxLabel.fMCID - 2)];
-				printf("Track %d label %d weight %f clusters %d (fitted %d) (%f%% %f%%) Pt %f\n", i, maxLabel.fMCID >= 0 ? maxLabel.fMCID : (maxLabel.fMCID + 2), maxLabel.fWeight, nClusters, track.NClustersFitted(), maxLabel.fWeight / sumweight, (float) maxcount / (float) nClusters, std::sqrt(mc.fPx * mc.fPx + mc.fPy * mc.fPy));
 			}
 		}
 		if (ompError) return;
+		totalFakes += nFakes;
+
+		//Efficiency / clone / fake counters, per-thread lists of the found MC labels, cluster attachment counters with atomics
+		const int nThreads = omp_get_max_threads();
+		std::vector<std::vector<int>> threadRecLabels(nThreads), threadFakeLabels(nThreads);
+#pragma omp parallel for schedule(dynamic, 16)
 		for (int i = 0; i < merger.NOutputTracks(); i++)
 		{
 			const AliHLTTPCGMMergedTrack &track = merger.OutputTracks()[i];
 			if (!track.OK()) continue;
-			if (trackMCLabels[i] == -1e9)
+			if (trackMCLabels[i] == MC_LABEL_INVALID)
 			{
 				for (int k = 0;k < track.NClusters();k++)
 				{
 					if (merger.Clusters()[track.FirstClusterRef() + k].fState & AliHLTTPCGMMergedTrackHit::flagReject) continue;
+#pragma omp atomic
 					clusterParam[merger.Clusters()[track.FirstClusterRef() + k].fNum].fakeAttached++;
 				}
 				continue;
@@ -563,31 +653,45 @@ void RunQA(bool matchOnly)
 					if (merger.Clusters()[track.FirstClusterRef() + k].fState & AliHLTTPCGMMergedTrackHit::flagReject) continue;
 					int hitId = merger.Clusters()[track.FirstClusterRef() + k].fNum;
 					bool correct = false;
-					for (int j = 0;j < 3;j++) if (hlt.GetMCLabels()[hitId].fClusterID[j].fMCID == label) {correct=true; break;}
-					if (correct) clusterParam[hitId].attached++;
-					else clusterParam[hitId].fakeAttached++;
+					for (int j = mcLabelOffset[hitId];j < mcLabelOffset[hitId + 1];j++) if (mcLabelIds[j] == label) {correct=true; break;}
+					if (correct)
+					{
+#pragma omp atomic
+						clusterParam[hitId].attached++;
+					}
+					else
+					{
+#pragma omp atomic
+						clusterParam[hitId].fakeAttached++;
+					}
 				}
 			}
-			if (trackMCLabels[i] < 0)
-			{
-				fakeTracks[label]++;
-			}
-			else
+			if (trackMCLabels[i] < 0) threadFakeLabels[omp_get_thread_num()].push_back(label);
+			else threadRecLabels[omp_get_thread_num()].push_back(label);
+		}
+		for (int iThread = 0;iThread < nThreads;iThread++)
+		{
+			for (unsigned int k = 0;k < threadRecLabels[iThread].size();k++) recTracks[threadRecLabels[iThread][k]]++;
+			for (unsigned int k = 0;k < threadFakeLabels[iThread].size();k++) fakeTracks[threadFakeLabels[iThread][k]]++;
+		}
+		//The track chosen for the resolution depends on the track order, keep it serial
+		for (int i = 0; i < merger.NOutputTracks(); i++)
+		{
+			const int label = trackMCLabels[i];
+			if (label < 0 || !merger.OutputTracks()[i].OK()) continue;
+			if (mcTrackMin == -1 || (label >= mcTrackMin && label < mcTrackMax))
 			{
-				recTracks[label]++;
-				if (mcTrackMin == -1 || (label >= mcTrackMin && label < mcTrackMax))
+				int& revLabel = trackMCLabelsReverse[label];
+				if (revLabel == -1 ||
+					!merger.OutputTracks()[revLabel].OK() ||
+					(merger.OutputTracks()[i].OK() && fabs(merger.OutputTracks()[i].GetParam().GetZ()) < fabs(merger.OutputTracks()[revLabel].GetParam().GetZ())))
 				{
-					int& revLabel = trackMCLabelsReverse[label];
-					if (revLabel == -1 ||
-						!merger.OutputTracks()[revLabel].OK() ||
-						(merger.OutputTracks()[i].OK() && fabs(merger.OutputTracks()[i].GetParam().GetZ()) < fabs(merger.OutputTracks()[revLabel].GetParam().GetZ())))
-					{
-						revLabel = i;
-					}
+					revLabel = i;
 				}
 			}
 		}
-		for (int i = 0;i < hlt.GetNMCLabels();i++)
+#pragma omp parallel for
+		for (int i = 0;i < nMCLabels;i++)
 		{
 			if (clusterParam[i].attached == 0 && clusterParam[i].fakeAttached == 0)
 			{
@@ -597,10 +701,9 @@ void RunQA(bool matchOnly)
 					int track = attach & AliHLTTPCGMMerger::attachTrackMask;
 					track =  trackMCLabels[track] < 0 ? (-trackMCLabels[track] - 2) : trackMCLabels[track];
 					bool fake = true;
-					for (int j = 0;j < 3;j++)
+					for (int j = mcLabelOffset[i];j < mcLabelOffset[i + 1];j++)
 					{
-						//printf("Attach %x Track %d / %d:%d\n", attach, track, j, hlt.GetMCLabels()[i].fClusterID[j].fMCID);
-						if (hlt.GetMCLabels()[i].fClusterID[j].fMCID == track) {fake = false; break;}
+						if (mcLabelIds[j] == track) {fake = false; break;}
 					}
 					if (fake) clusterParam[i].fakeAdjacent++;
 					else clusterParam[i].adjacent++;
@@ -646,15 +749,15 @@ void RunQA(bool matchOnly)
 		timer.ResetStart();
 		
 		//Recompute fNWeightCls (might have changed after merging events into timeframes)
+		//Serial in cluster order: the float sums must not depend on the thread scheduling, the flat label arrays make this loop cheap
 		for (int i = 0;i < hlt.GetNMCInfo();i++) mcParam[i].nWeightCls = 0.;
-		for (int i = 0;i < hlt.GetNMCLabels();i++)
+		for (int i = 0;i < nMCLabels;i++)
 		{
-			const AliHLTTPCClusterMCLabel* labels = hlt.GetMCLabels();
 			float weightTotal = 0.f;
-			for (int j = 0;j < 3;j++) if (labels[i].fClusterID[j].fMCID >= 0) weightTotal += labels[i].fClusterID[j].fWeight;
-			for (int j = 0;j < 3;j++) if (labels[i].fClusterID[j].fMCID >= 0)
+			for (int j = mcLabelOffset[i];j < mcLabelOffset[i + 1];j++) weightTotal += mcLabelWeights[j];
+			for (int j = mcLabelOffset[i];j < mcLabelOffset[i + 1];j++)
 			{
-				mcParam[labels[i].fClusterID[j].fMCID].nWeightCls += labels[i].fClusterID[j].fWeight / weightTotal;
+				mcParam[mcLabelIds[j]].nWeightCls += mcLabelWeights[j] / weightTotal;
 			}
 		}
 		if (TIMING) printf("QA Time: Compute cluster label weights:\t%6.0f us\n", timer.GetCurrentElapsedTime() * 1e6);
@@ -27,13 +27,17 @@
 #endif
 
 #include "AliHLTTPCGMMergedTrack.h"
-#include "Interface/outputtrack.h"
+#include "AliHLTTPCGMPolynomialFieldCreator.h"
+#include "AliHLTTPCGMResidualCollector.h"
+#include "AliHLTTPCGMReferenceFitter.h"
+#include "Interface/outputtrackfile.h"
 #include "include.h"
 #include "standaloneSettings.h"
 #include <vector>
 #include <xmmintrin.h>
 
 #include "cmodules/qconfig.h"
+#include "cmodules/perfcounter.h"
 
 #ifdef HAVE_O2HEADERS
 #include "DataFormatsTPC/ClusterNative.h"
@@ -125,7 +129,7 @@ int main(int argc, char** argv)
 	if (configStandalone.OMPThreads != -1) omp_set_num_threads(configStandalone.OMPThreads);
 	
 	std::ofstream CPUOut, GPUOut;
-	FILE* fpBinaryOutput = NULL;
+	OutputTrackFileWriter binaryOutput;
 
 	if (configStandalone.eventDisplay) configStandalone.noprompt = 1;
 	if (configStandalone.DebugLevel >= 4)
@@ -136,7 +140,7 @@ int main(int argc, char** argv)
 	}
 	if (configStandalone.writebinary)
 	{
-		if ((fpBinaryOutput = fopen("output.bin", "w+b")) == NULL)
+		if (binaryOutput.Open("output.bin", configStandalone.compressbinary))
 		{
 			printf("Error opening output file\n");
 			exit(1);
@@ -171,6 +175,7 @@ int main(int argc, char** argv)
 	if (configStandalone.constBz) eventSettings.constBz = true;
 	
 	hlt.SetGPUDebugLevel(configStandalone.DebugLevel, &CPUOut, &GPUOut);
+	PerfCounters::SetEnabled(configStandalone.perfCounters);
 	hlt.SetEventDisplay(configStandalone.eventDisplay);
 	hlt.SetRunQA(configStandalone.qa);
 	hlt.SetRunMerger(configStandalone.merger);
@@ -192,12 +197,43 @@ int main(int argc, char** argv)
 	hlt.SetSettings(eventSettings.solenoidBz, eventSettings.homemadeEvents, eventSettings.constBz);
 	hlt.SetNWays(configStandalone.nways);
 	hlt.SetNWaysOuter(configStandalone.nwaysouter);
+	if (configStandalone.mergeLoopers) hlt.SetMergeLoopers(configStandalone.mergeLoopers);
+	if (configStandalone.dEdx) hlt.SetComputedEdx(configStandalone.dEdx);
+	if (configStandalone.mergerScalar) hlt.SetMergerScalarSliceTracks(configStandalone.mergerScalar);
+	if (configStandalone.fitMaxNRejected) hlt.SetFitMaxNRejected(configStandalone.fitMaxNRejected);
+	if (configStandalone.fitMaxChi2NDF > 0.f) hlt.SetFitMaxChi2NDF(configStandalone.fitMaxChi2NDF);
 	if (configStandalone.cont) hlt.SetContinuousTracking(configStandalone.cont);
+	if (configStandalone.deterministic) hlt.SetDeterministicOutput(configStandalone.deterministic);
+	if (configStandalone.sparseGrid) hlt.SetSparseRowGrid(configStandalone.sparseGrid);
+	if (configStandalone.runsSnapshot) hlt.SetSliceDataSnapshot(configStandalone.runsSnapshot);
+	if (configStandalone.trackingPasses > 1) hlt.SetTrackingPasses(configStandalone.trackingPasses);
 	if (configStandalone.dzdr != 0.) hlt.SetSearchWindowDZDR(configStandalone.dzdr);
 	if (configStandalone.referenceX < 500.) hlt.SetTrackReferenceX(configStandalone.referenceX);
 	hlt.UpdateGPUSliceParam();
 	hlt.SetGPUTrackerOption("GlobalTracking", 1);
+	if (configStandalone.fieldMap)
+	{
+		AliHLTTPCGMPolynomialField field;
+		float residuals[6];
+		int err = AliHLTTPCGMPolynomialFieldCreator::FitFieldMap(configStandalone.fieldMap, field, residuals);
+		if (err)
+		{
+			printf("Error fitting field map %s (%d)\n", configStandalone.fieldMap, err);
+			return(1);
+		}
+		printf("Fitted polynomial field from %s: max residuals (relative) Bx %f By %f Bz %f, RMS Bx %f By %f Bz %f\n", configStandalone.fieldMap, residuals[0], residuals[1], residuals[2], residuals[3], residuals[4], residuals[5]);
+		hlt.Merger().SetField(&field);
+	}
 	
+	AliHLTTPCGMResidualCollector* residualCollector = NULL;
+	if (configStandalone.residuals)
+	{
+		if (configStandalone.nways < 3) printf("Residual collection needs the 3-way fit, no residuals will be collected\n");
+		residualCollector = new AliHLTTPCGMResidualCollector;
+		hlt.Merger().SetResidualCollector(residualCollector);
+	}
+	AliHLTTPCGMReferenceFitter* referenceFitter = configStandalone.referenceFit ? new AliHLTTPCGMReferenceFitter : NULL;
+
 	for (unsigned int i = 0;i < configStandalone.gpuOptions.size();i++)
 	{
 		printf("Setting GPU Option %s to %d\n", std::get<0>(configStandalone.gpuOptions[i]), std::get<1>(configStandalone.gpuOptions[i]));
@@ -574,6 +610,7 @@ int main(int argc, char** argv)
 					if (configStandalone.merger)
 					{
 						const AliHLTTPCGMMerger& merger = hlt.Merger();
+						if (referenceFitter && j == 0) referenceFitter->FitTracks(merger);
 						if (configStandalone.resetids && (configStandalone.writeoutput || configStandalone.writebinary))
 						{
 							printf("\nWARNING: Renumbering Cluster IDs, Cluster IDs in output do NOT match IDs from input\n\n");
@@ -606,14 +643,16 @@ int main(int argc, char** argv)
 						
 						if (configStandalone.writebinary)
 						{
-							int numTracks = merger.NOutputTracks();
-							fwrite(&numTracks, sizeof(numTracks), 1, fpBinaryOutput);
-							for (int k = 0;k < numTracks;k++)
+							std::vector<OutputTrack> sliceTracks[36];
+							std::vector<unsigned int> sliceClusters[36];
+							for (int k = 0;k < merger.NOutputTracks();k++)
 							{
 								OutputTrack tmpTrack;
 								const AliHLTTPCGMMergedTrack& track = merger.OutputTracks()[k];
 								const AliHLTTPCGMTrackParam& param = track.GetParam();
-								
+								const AliHLTTPCGMMergedTrackHit* clusters = merger.Clusters() + track.FirstClusterRef();
+								const int slice = track.NClusters() ? clusters[0].fSlice : 0;
+
 								tmpTrack.Alpha = track.GetAlpha();
 								tmpTrack.X = param.GetX();
 								tmpTrack.Y = param.GetY();
@@ -623,13 +662,21 @@ int main(int argc, char** argv)
 								tmpTrack.QPt = param.GetQPt();
 								tmpTrack.NClusters = track.NClusters();
 								tmpTrack.FitOK = track.OK();
-								fwrite(&tmpTrack, sizeof(tmpTrack), 1, fpBinaryOutput);
-								const AliHLTTPCGMMergedTrackHit* clusters = merger.Clusters() + track.FirstClusterRef();
+								sliceTracks[slice].push_back(tmpTrack);
 								for (int l = 0;l < track.NClusters();l++)
 								{
-									fwrite(&clusters[l].fNum, sizeof(clusters[l].fNum), 1, fpBinaryOutput);
+									sliceClusters[slice].push_back(clusters[l].fNum);
+								}
+							}
+							for (int iSlice = 0;iSlice < 36;iSlice++)
+							{
+								if (sliceTracks[iSlice].size() && binaryOutput.WriteBlock(iSlice, &sliceTracks[iSlice][0], sliceTracks[iSlice].size(), sliceClusters[iSlice].size() ? &sliceClusters[iSlice][0] : NULL))
+								{
+									printf("Error writing binary output\n");
+									exit(1);
 								}
 							}
+							binaryOutput.EndEvent();
 						}
 						
 					}
@@ -658,7 +705,19 @@ breakrun:
 		CPUOut.close();
 		GPUOut.close();
 	}
-	if (configStandalone.writebinary) fclose(fpBinaryOutput);
+	if (configStandalone.writebinary) binaryOutput.Close();
+	if (residualCollector)
+	{
+		if (residualCollector->Write(configStandalone.residuals)) printf("Cluster residual statistics written to %s\n", configStandalone.residuals);
+		else printf("Error writing cluster residual statistics to %s\n", configStandalone.residuals);
+		hlt.Merger().SetResidualCollector(NULL);
+		delete residualCollector;
+	}
+	if (referenceFitter)
+	{
+		referenceFitter->Print();
+		delete referenceFitter;
+	}
 
 	hlt.Merger().Clear();
 	hlt.Merger().SetGPUTracker(NULL);
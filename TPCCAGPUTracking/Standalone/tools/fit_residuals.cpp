@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "AliHLTTPCGMResidualCollector.h"
+
+//Fits the cluster error parameterization of AliHLTTPCCAParam to the residual statistics written by the standalone benchmark (--residuals file).
+//Several files are summed. The coefficients of row types without enough statistics keep their default values.
+//The output is in the format of the kParamS0Par / kParamRMS0 initializers in AliHLTTPCCAParam.cxx.
+//Build: c++ -O2 -I../../Merger fit_residuals.cpp ../../Merger/AliHLTTPCGMResidualCollector.cxx -o fit_residuals
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: fit_residuals [-m MINENTRIES] FILE [FILE...]\n");
+		return(1);
+	}
+	int minEntries = 100;
+	int iArg = 1;
+	if (argc > 3 && strcmp(argv[1], "-m") == 0)
+	{
+		minEntries = atoi(argv[2]);
+		iArg = 3;
+	}
+
+	std::vector<AliHLTTPCGMResidualCollector::Bin> bins, fileBins;
+	for (;iArg < argc;iArg++)
+	{
+		if (!AliHLTTPCGMResidualCollector::Read(argv[iArg], fileBins))
+		{
+			printf("Error reading %s\n", argv[iArg]);
+			return(1);
+		}
+		if (bins.size() == 0) bins = fileBins;
+		else for (unsigned int i = 0;i < bins.size();i++)
+		{
+			bins[i].fN += fileBins[i].fN;
+			bins[i].fSumZ += fileBins[i].fSumZ;
+			bins[i].fSumAngle2 += fileBins[i].fSumAngle2;
+			bins[i].fSumRes += fileBins[i].fSumRes;
+			bins[i].fSumRes2 += fileBins[i].fSumRes2;
+			bins[i].fSumTrkErr2 += fileBins[i].fSumTrkErr2;
+		}
+	}
+
+	//Defaults of AliHLTTPCCAParam
+	float paramS0Par[2][3][6] = {
+		{{6.45913474727e-04, 2.51547407970e-05, 1.57551113516e-02, 1.99872811635e-08, -5.86769729853e-03, 9.16301505640e-05},
+		 {9.71546804067e-04, 1.70938055817e-05, 2.17084009200e-02, 3.90275758377e-08, -1.68631039560e-03, 8.40498323669e-05},
+		 {7.27469159756e-05, 2.63869314949e-05, 3.29690799117e-02, -2.19274429725e-08, 1.77378822118e-02, 3.26595727529e-05}},
+		{{1.46874145139e-03, 6.36232061879e-06, 1.28665426746e-02, 1.19409449439e-07, 1.15883778781e-02, 1.32179644424e-04},
+		 {1.15970033221e-03, 1.30452335725e-05, 1.87015570700e-02, 5.39766737973e-08, 1.64790824056e-02, 1.44115634612e-04},
+		 {6.27940462437e-04, 1.78520094778e-05, 2.83537860960e-02, 1.16867742150e-08, 5.02607785165e-02, 1.88510020962e-04}}};
+	float paramRMS0[2][3][4] = {
+		{{4.17516864836e-02, 1.87623649254e-04, 5.63788712025e-02, 5.38373768330e-01},
+		 {8.29434990883e-02, 2.03291710932e-04, 6.81538805366e-02, 9.70965325832e-01},
+		 {8.67543518543e-02, 2.10733342101e-04, 1.38366967440e-01, 2.55089461803e-01}},
+		{{5.96254616976e-02, 8.62886518007e-05, 3.61776389182e-02, 4.79704320431e-01},
+		 {6.12571723759e-02, 7.23929333617e-05, 3.93057651818e-02, 9.29222583771e-01},
+		 {6.58465921879e-02, 1.03639606095e-04, 6.07583411038e-02, 9.90289509296e-01}}};
+
+	const int nFitted = AliHLTTPCGMResidualCollector::FitParameterization(bins, paramS0Par, paramRMS0, minEntries);
+	printf("Fitted %d of %d row types\n\n", nFitted, AliHLTTPCGMResidualCollector::kNYZ * AliHLTTPCGMResidualCollector::kNRowTypes);
+
+	printf("  float const kParamS0Par[2][3][6]=\n    {\n");
+	for (int i = 0;i < 2;i++)
+	{
+		printf("      {");
+		for (int j = 0;j < 3;j++)
+		{
+			printf("%s { ", j ? "\t" : "  ");
+			for (int k = 0;k < 6;k++) printf("%.11e%s", paramS0Par[i][j][k], k < 5 ? ", " : " ");
+			printf("}%s\n", j < 2 ? "," : "");
+		}
+		printf("      }%s\n", i < 1 ? "," : "");
+	}
+	printf("    };\n\n");
+
+	printf("  float const kParamRMS0[2][3][4] =\n    {\n");
+	for (int i = 0;i < 2;i++)
+	{
+		printf("      {");
+		for (int j = 0;j < 3;j++)
+		{
+			printf("%s { ", j ? "\t" : "  ");
+			for (int k = 0;k < 4;k++) printf("%.11e, ", paramRMS0[i][j][k]);
+			printf(" }%s\n", j < 2 ? "," : "");
+		}
+		printf("      }%s\n", i < 1 ? "," : "");
+	}
+	printf("    };\n");
+
+	return(0);
+}
@@ -1,56 +1,141 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <vector>
-#include <time.h>
+#include <random>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
 #include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//Builds time frames from single-event cluster dumps (event.%d.dump in the current directory, written to out/event.%d.dump).
+//1. All input files are indexed: file offset and number of clusters for every slice.
+//2. Events and z-shifts of all time frames are selected from the random seed, so the output only depends on the seed and not on the number of threads.
+//3. The slices of all time frames are merged in parallel. The output offsets follow from the index, so every slice is streamed
+//   event by event from the inputs to its final position in the output file, only one slice block per thread is kept in memory.
+//Build: c++ -O2 -fopenmp merger.cpp -o merger
 
 #define ERROR(...) {printf(__VA_ARGS__);exit(1);}
 
-struct ClusterData {
+#define NSLICES 36
+
+struct ClusterData { //Same layout as AliHLTTPCCAClusterData::Data
 	int fId;
-	int fRow;
+	short fRow;
+	short fFlags;
 	float fX;
 	float fY;
 	float fZ;
 	float fAmp;
 };
 
+struct EventIndex {
+	long long int fOffset[NSLICES]; //File offset of the clusters of a slice
+	int fNClusters[NSLICES];
+};
+
+static void Usage()
+{
+	printf("Usage: merger [options]\n"
+		"  -n N   Number of events per time frame (default 1)\n"
+		"  -d D   Average distance of events in z (default 200)\n"
+		"  -r 0/1 Randomize the distance (default 1)\n"
+		"  -f 0/1 Shift the first event of a time frame (default 1)\n"
+		"  -s S   Random seed (default 0)\n"
+		"  -x 0/1 Shuffle the order of the input events (default 0)\n"
+		"  -m M   Use at most M input events (default all)\n"
+		"  -j J   Number of threads (default OpenMP default)\n");
+}
+
+static bool IndexEvent(int iEvent, EventIndex& index)
+{
+	char filename[64];
+	sprintf(filename, "event.%d.dump", iEvent);
+	FILE* fp = fopen(filename, "rb");
+	if (fp == NULL) return(false);
+	for (int iSlice = 0;iSlice < NSLICES;iSlice++)
+	{
+		int numberOfHits = 0;
+		if (fread(&numberOfHits, sizeof(numberOfHits), 1, fp) != 1) ERROR("Error reading file %s\n", filename);
+		index.fNClusters[iSlice] = numberOfHits;
+		index.fOffset[iSlice] = ftell(fp);
+		if (fseek(fp, (long) numberOfHits * sizeof(ClusterData), SEEK_CUR)) ERROR("Error reading file %s\n", filename);
+	}
+	fclose(fp);
+	return(true);
+}
+
 int main(int argc, char** argv)
 {
-	timespec tv;
-	clock_gettime(CLOCK_REALTIME, &tv);
-	srand(tv.tv_nsec);
-	
 	int nMerge = 1;
 	float averageDistance = 200;
 	bool randomizeDistance = true;
 	bool shiftFirstEvent = true;
-	
-	if (argc != 5)
+	unsigned int seed = 0;
+	bool shuffle = false;
+	int maxEvents = -1;
+	int nThreads = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:d:r:f:s:x:m:j:h")) != -1)
 	{
-		printf("Usage merger nMerge averageDist randomizeDist shiftFirst\n");
-		return(1);
+		switch (opt)
+		{
+			case 'n': nMerge = atoi(optarg); break;
+			case 'd': averageDistance = atof(optarg); break;
+			case 'r': randomizeDistance = atoi(optarg); break;
+			case 'f': shiftFirstEvent = atoi(optarg); break;
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			case 'x': shuffle = atoi(optarg); break;
+			case 'm': maxEvents = atoi(optarg); break;
+			case 'j': nThreads = atoi(optarg); break;
+			default: Usage(); return(1);
+		}
 	}
-	nMerge = atoi(argv[1]);
-	averageDistance = atof(argv[2]);
-	randomizeDistance = atoi(argv[3]);
-	shiftFirstEvent = atoi(argv[4]);
-	
-	std::vector<ClusterData> clusters[36];
-	int nClusters [36] = {};
-	
-	int iEvent = 0;
-	int iEventInTimeframe = 0;
-	int nOut = 0;
-	mkdir("out", ACCESSPERMS);
-	while (true)
+	if (nMerge < 1) {Usage(); return(1);}
+#ifdef _OPENMP
+	if (nThreads > 0) omp_set_num_threads(nThreads);
+#endif
+
+	//Index all input files
+	int nEvents = 0;
+	struct stat st;
+	while (maxEvents < 0 || nEvents < maxEvents)
 	{
-		float shift;
+		char filename[64];
+		sprintf(filename, "event.%d.dump", nEvents);
+		if (stat(filename, &st)) break;
+		nEvents++;
+	}
+	std::vector<EventIndex> index(nEvents);
+#pragma omp parallel for schedule(dynamic)
+	for (int iEvent = 0;iEvent < nEvents;iEvent++)
+	{
+		if (!IndexEvent(iEvent, index[iEvent])) ERROR("Error opening event %d\n", iEvent);
+	}
+	printf("Indexed %d events\n", nEvents);
+
+	//Select the events and the z-shifts of all time frames
+	const int nOut = nEvents / nMerge;
+	std::mt19937 rng(seed);
+	std::vector<int> events(nEvents);
+	for (int i = 0;i < nEvents;i++) events[i] = i;
+	if (shuffle) std::shuffle(events.begin(), events.end(), rng);
+	std::uniform_real_distribution<double> uniform(0., 1.);
+	std::vector<float> shifts(nOut * nMerge);
+	for (int i = 0;i < nOut * nMerge;i++)
+	{
+		const int iEventInTimeframe = i % nMerge;
+		float shift = 0.;
 		if (shiftFirstEvent || iEventInTimeframe)
 		{
 			if (randomizeDistance)
 			{
-				shift = (double) rand() / (double) RAND_MAX;
+				shift = uniform(rng);
 				if (shiftFirstEvent)
 				{
 					if (iEventInTimeframe == 0) shift = shift * averageDistance;
@@ -64,71 +149,77 @@ int main(int argc, char** argv)
 			}
 			else
 			{
-				if (shiftFirstEvent)
-				{
-					shift = averageDistance * (iEventInTimeframe + 0.5);
-				}
-				else
-				{
-					shift = averageDistance * (iEventInTimeframe);
-				}
+				if (shiftFirstEvent) shift = averageDistance * (iEventInTimeframe + 0.5);
+				else shift = averageDistance * (iEventInTimeframe);
 			}
 		}
-		else
-		{
-			shift = 0.;
-		}
+		shifts[i] = shift;
+	}
 
-		int nClustersTotal = 0;
-		char filename[64];
-		sprintf(filename, "event.%d.dump", iEvent);
-		FILE *fp;
-		fp = fopen(filename, "rb");
-		if (fp == NULL) break;
-		for (int iSector = 0;iSector < 36;iSector++)
+	//Output layout: offset of every slice of every time frame, create the output files with their final size
+	mkdir("out", ACCESSPERMS);
+	std::vector<long long int> outOffset(nOut * NSLICES);
+	int maxBlock = 0;
+	for (int iOut = 0;iOut < nOut;iOut++)
+	{
+		long long int offset = 0;
+		for (int iSlice = 0;iSlice < NSLICES;iSlice++)
 		{
-			int numberOfHits = 0;
-			if (fread(&numberOfHits, sizeof(numberOfHits), 1, fp) != 1) ERROR("Error reading file\n");
-			if (numberOfHits == 0) continue;
-			clusters[iSector].resize(nClusters[iSector] + numberOfHits);
-			if (fread(&clusters[iSector][nClusters[iSector]], sizeof(ClusterData), numberOfHits, fp) != numberOfHits) ERROR("Error reading file\n");
-
-			for (int i = 0;i < numberOfHits;i++)
+			outOffset[iOut * NSLICES + iSlice] = offset;
+			long long int nClusters = 0;
+			for (int j = 0;j < nMerge;j++)
 			{
-				if (iSector < 18) clusters[iSector][nClusters[iSector] + i].fZ += shift;
-				else clusters[iSector][nClusters[iSector] + i].fZ -= shift;
+				const int n = index[events[iOut * nMerge + j]].fNClusters[iSlice];
+				nClusters += n;
+				if (n > maxBlock) maxBlock = n;
 			}
-
-			nClustersTotal += numberOfHits;
-			nClusters[iSector] += numberOfHits;
+			offset += sizeof(int) + nClusters * sizeof(ClusterData);
 		}
-		fclose(fp);
-		
-		printf("Read event %s (%d clusters)\n", filename, nClustersTotal);
+		char filename[64];
+		sprintf(filename, "out/event.%d.dump", iOut);
+		int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0 || ftruncate(fd, offset)) ERROR("Error opening output file %s\n", filename);
+		close(fd);
+	}
 
-		iEvent++;
-		iEventInTimeframe++;
-		
-		if (iEventInTimeframe == nMerge)
+	//Merge the slices
+	long long int nClustersTotal = 0;
+#pragma omp parallel reduction(+:nClustersTotal)
+	{
+		std::vector<ClusterData> buffer(maxBlock);
+#pragma omp for schedule(dynamic)
+		for (int iTask = 0;iTask < nOut * NSLICES;iTask++)
 		{
-			iEventInTimeframe = 0;
-			sprintf(filename, "out/event.%d.dump", nOut);
-			fp = fopen(filename, "w+b");
-			if (fp == NULL) ERROR("Error opening output file\n");
-			for (int iSector = 0;iSector < 36;iSector++)
+			const int iOut = iTask / NSLICES;
+			const int iSlice = iTask % NSLICES;
+			char filename[64];
+			sprintf(filename, "out/event.%d.dump", iOut);
+			int fdOut = open(filename, O_WRONLY);
+			if (fdOut < 0) ERROR("Error opening output file %s\n", filename);
+			long long int offset = outOffset[iTask] + sizeof(int);
+			int nClusters = 0;
+			for (int j = 0;j < nMerge;j++)
 			{
-				if (fwrite(&nClusters[iSector], sizeof(int), 1, fp) != 1) ERROR("Error writing output file\n");
-				if (fwrite(&clusters[iSector][0], sizeof(ClusterData), clusters[iSector].size(), fp) != clusters[iSector].size()) ERROR("Error writing output file\n");
-				nClustersTotal += nClusters[iSector];
-				nClusters[iSector] = 0;
-				clusters[iSector].clear();
+				const int iEvent = events[iOut * nMerge + j];
+				const int n = index[iEvent].fNClusters[iSlice];
+				if (n == 0) continue;
+				sprintf(filename, "event.%d.dump", iEvent);
+				int fdIn = open(filename, O_RDONLY);
+				if (fdIn < 0) ERROR("Error opening input file %s\n", filename);
+				if (pread(fdIn, &buffer[0], n * sizeof(ClusterData), index[iEvent].fOffset[iSlice]) != (ssize_t) (n * sizeof(ClusterData))) ERROR("Error reading file %s\n", filename);
+				close(fdIn);
+				const float shift = iSlice < NSLICES / 2 ? shifts[iOut * nMerge + j] : -shifts[iOut * nMerge + j];
+				for (int i = 0;i < n;i++) buffer[i].fZ += shift;
+				if (pwrite(fdOut, &buffer[0], n * sizeof(ClusterData), offset) != (ssize_t) (n * sizeof(ClusterData))) ERROR("Error writing output file\n");
+				offset += n * sizeof(ClusterData);
+				nClusters += n;
 			}
-			fclose(fp);
-			printf("Merged %d events into %s (total %d clusters)\n", nMerge, filename, nClustersTotal);
-			
-			nOut++;
+			if (pwrite(fdOut, &nClusters, sizeof(nClusters), outOffset[iTask]) != sizeof(nClusters)) ERROR("Error writing output file\n");
+			close(fdOut);
+			nClustersTotal += nClusters;
 		}
 	}
-	
+	printf("Merged %d events into %d time frames (seed %u, total %lld clusters)\n", nOut * nMerge, nOut, seed, nClustersTotal);
+
 	return(0);
 }
@@ -1,44 +1,59 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <vector>
-#include "outputtrack.h"
+#include "outputtrackfile.h"
+
+//Reads the binary track output (output.bin) of the standalone.
+//Usage: read_output [file] [event] [slice], prints all events, or only one event / one slice of an event.
+//The file index is used to access the requested blocks directly, the rest of the file is not read.
+//Build: c++ -O2 -I../../Interface read_output.cpp -o read_output (add -DHLTCA_BUILD_ZLIB -lz for compressed files)
+
+static void PrintBlock(const OutputTrackBlock& block)
+{
+	for (OutputTrackBlock::iterator it = block.begin();it != block.end();++it)
+	{
+		const OutputTrackBlock::TrackRef t = *it;
+		const OutputTrack& track = t.fTrack;
+		printf("Track Parameters: Alpha %f, X %f, Y %f, Z %f, SinPhi %f, DzDs %f, Q/Pt %f, Number of clusters %d, Fit OK %d\n", track.Alpha, track.X, track.Y, track.Z, track.SinPhi, track.DzDs, track.QPt, track.NClusters, track.FitOK);
+		printf("Cluster IDs:");
+		for (int iCluster = 0;iCluster < track.NClusters;iCluster++)
+		{
+			printf(" %d", t.fClusters[iCluster]);
+		}
+		printf("\n");
+	}
+}
 
 int main(int argc, char** argv)
 {
-	FILE* fpInput = fopen("../output.bin", "rb");
-	if (fpInput == NULL)
+	const char* filename = argc > 1 ? argv[1] : "../output.bin";
+	const int selectEvent = argc > 2 ? atoi(argv[2]) : -1;
+	const int selectSlice = argc > 3 ? atoi(argv[3]) : -1;
+
+	OutputTrackFileReader reader;
+	if (reader.Open(filename))
 	{
 		printf("Error opening input file\n");
 		exit(1);
 	}
-	
-	//Loop over all events in the input file.
-	//Number of events is not stored int the file, but we just read until we reach the end of file.
-	//All values stored in the file are either int or float, so 32 bit.
-	//Thus, we do not need to care about alignment. The same data structures must be used again for reading the file.
-	int nEvents = 0;
-	std::vector<unsigned int> ClusterIDs;
-	while (!feof(fpInput))
+
+	OutputTrackBlock block;
+	for (int iEvent = 0;iEvent < reader.NEvents();iEvent++)
 	{
-		int numTracks; //Must be int!
-		OutputTrack track;
-		fread(&numTracks, sizeof(numTracks), 1, fpInput);
-		printf("Event: %d, Number of tracks: %d\n", nEvents, numTracks);
-		for (int iTrack = 0;iTrack < numTracks;iTrack++)
+		if (selectEvent != -1 && iEvent != selectEvent) continue;
+		printf("Event: %d, Number of tracks: %d\n", iEvent, reader.EventNTracks(iEvent));
+		int first, last;
+		reader.EventBlocks(iEvent, first, last);
+		for (int i = first;i < last;i++)
 		{
-			fread(&track, sizeof(track), 1, fpInput);
-			printf("Track %d Parameters: Alpha %f, X %f, Y %f, Z %f, SinPhi %f, DzDs %f, Q/Pt %f, Number of clusters %d, Fit OK %d\n", iTrack, track.Alpha, track.X, track.Y, track.Z, track.SinPhi, track.DzDs, track.QPt, track.NClusters, track.FitOK);
-			if (track.NClusters > ClusterIDs.size()) ClusterIDs.resize(track.NClusters);
-			fread(&ClusterIDs[0], sizeof(ClusterIDs[0]), track.NClusters, fpInput);
-			printf("Cluster IDs:");
-			for (int iCluster = 0;iCluster < track.NClusters;iCluster++)
+			if (selectSlice != -1 && reader.Block(i).fSlice != selectSlice) continue;
+			if (reader.GetBlock(i, block))
 			{
-				printf(" %d", ClusterIDs[iCluster]);
+				printf("Error reading block %d\n", i);
+				exit(1);
 			}
-			printf("\n");
+			printf("Slice %d, Number of tracks: %d\n", reader.Block(i).fSlice, block.NTracks());
+			PrintBlock(block);
 		}
-		
-		nEvents++;
 	}
-	fclose(fpInput);
+	return(0);
 }
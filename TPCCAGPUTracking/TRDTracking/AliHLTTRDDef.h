@@ -31,6 +31,7 @@ typedef AliTrackerBase HLTTRDBasePropagator;
 #else
 class AliHLTTPCGMPropagator;
 typedef AliHLTTPCGMPropagator HLTTRDBasePropagator;
+#define TRD_PROPAGATOR_GM // enables the tracklet search specialised for the GM propagator
 #endif
 
 template <class T> class trackInterface;
@@ -194,6 +194,30 @@ template <> class propagatorInterface<AliHLTTPCGMPropagator> : public AliHLTTPCG
     GPUd() float getAlpha() { return GetAlpha(); }
     // TODO sigma_yz not taken into account yet, is not zero due to pad tilting!
     GPUd() float getPredictedChi2(const My_Float p[2], const My_Float cov[3]) const { return PredictChi2( p[0], p[1], cov[0], cov[2]); }
+    // y and z of the track at the radii x[0..n-1] by helix steps from the current position in the Bz field at that position
+    // (same curvature convention as AliHLTTPCGMPropagator::PropagateToXAlpha), the track is not changed.
+    // ok[i] is false if x[i] cannot be reached. The loop has no branches, such that it can be vectorized
+    GPUd() void getPredictedYZ(int n, const float *x, float *y, float *z, bool *ok) const {
+      const float x0 = fTrack->GetX(), y0 = fTrack->GetY(), z0 = fTrack->GetZ();
+      const float k = -fTrack->GetQPt() * GetBz( GetAlpha(), x0, y0, z0 );
+      const float ey = fTrack->GetSinPhi();
+      const float ex = sqrtf(1.f - ey * ey);
+      const float dzds = fTrack->GetDzDs();
+      for (int i=0; i<n; i++) {
+        const float dx = x[i] - x0;
+        float ey1 = k * dx + ey;
+        ok[i] = CAMath::Abs(ey1) <= HLTCA_MAX_SIN_PHI;
+        ey1 = ok[i] ? ey1 : ey;
+        const float ex1 = sqrtf(1.f - ey1 * ey1);
+        const float dxcci = dx / (ex + ex1);
+        const float norm2 = 1.f + ey * ey1 + ex * ex1;
+        const float dl = dxcci * sqrtf(norm2 + norm2);
+        const float dSin = 0.5f * k * dl;
+        const float a = dSin * dSin;
+        y[i] = y0 + dxcci * (ey + ey1);
+        z[i] = z0 + (dl + dl * a * (1.f / 6.f + a * (3.f / 40.f))) * dzds;
+      }
+    }
 
     trackInterface<AliHLTTPCGMTrackParam> *fTrack;
 };
@@ -13,6 +13,11 @@
 #include "AliHLTTRDTrack.h"
 #include "AliHLTTRDTrackerDebug.h"
 #include "AliHLTTPCGMMerger.h"
+#include "AliHLTTPCGMMergedTrack.h"
+#include "AliHLTTPCCAMath.h"
+#if defined(HLTCA_STANDALONE) && !defined(HLTCA_GPUCODE)
+#include "../cmodules/timer.h"
+#endif
 
 #ifdef HLTCA_BUILD_ALIROOT_LIB
 #include "TDatabasePDG.h"
@@ -37,6 +42,11 @@ AliHLTTRDTracker::AliHLTTRDTracker() :
   fR(nullptr),
   fIsInitialized(false),
   fTracks(nullptr),
+  fNTracksMax(0),
+  fTracksTPC(nullptr),
+  fTracksTPCLab(nullptr),
+  fTracksTPCId(nullptr),
+  fNTracksTPCMax(0),
   fNCandidates(1),
   fNTracks(0),
   fNEvents(0),
@@ -57,6 +67,10 @@ AliHLTTRDTracker::AliHLTTRDTracker() :
   fChi2Penalty(12.0),
   fZCorrCoefNRC(1.4),
   fNhypothesis(100),
+  fBatchedTrackletSearch(true),
+  fNTracksProcessed(0),
+  fNTrackletPropagations(0),
+  fNTrackletChi2(0),
   fMaskedChambers(nullptr),
   fMCEvent(nullptr),
   fMerger(&fgkMerger),
@@ -65,6 +79,10 @@ AliHLTTRDTracker::AliHLTTRDTracker() :
   //--------------------------------------------------------------------
   // Default constructor
   //--------------------------------------------------------------------
+  for (int i=0; i<2; ++i) {
+    fNTracksFollowed[i] = 0;
+    fFollowTime[i] = 0.;
+  }
 }
 
 AliHLTTRDTracker::~AliHLTTRDTracker()
@@ -75,6 +93,9 @@ AliHLTTRDTracker::~AliHLTTRDTracker()
   if (fIsInitialized) {
     delete[] fTracklets;
     delete[] fTracks;
+    delete[] fTracksTPC;
+    delete[] fTracksTPCLab;
+    delete[] fTracksTPCId;
     delete[] fSpacePoints;
     delete[] fHypothesis;
     delete[] fCandidates;
@@ -228,7 +249,7 @@ GPUd() void AliHLTTRDTracker::LoadTracklet(const AliHLTTRDTrackletWord &tracklet
   fNtrackletsInChamber[tracklet.GetDetector()]++;
 }
 
-GPUd() void AliHLTTRDTracker::DoTracking( HLTTRDTrack *tracksTPC, int *tracksTPClab, int nTPCtracks, int *tracksTPCnTrklts, int *tracksTRDlabel )
+GPUd() void AliHLTTRDTracker::DoTracking( HLTTRDTrack *tracksTPC, int *tracksTPClab, int nTPCtracks, int *tracksTPCnTrklts, int *tracksTRDlabel, const int *tracksTPCId )
 {
   //--------------------------------------------------------------------
   // Steering function for the tracking
@@ -249,15 +270,29 @@ GPUd() void AliHLTTRDTracker::DoTracking( HLTTRDTrack *tracksTPC, int *tracksTPC
     Error("DoTracking", "Space points for at least one chamber could not be calculated");
   }
 
-  delete[] fTracks;
-  fTracks = new HLTTRDTrack[nTPCtracks];
+  if (nTPCtracks > fNTracksMax) {
+    delete[] fTracks;
+    fNTracksMax = nTPCtracks;
+    fTracks = new HLTTRDTrack[fNTracksMax];
+  }
   fNTracks = 0;
 
+#ifdef TRD_PROPAGATOR_GM
+  const int iSearch = fBatchedTrackletSearch ? 1 : 0;
+#else
+  const int iSearch = 0;
+#endif
+#if defined(HLTCA_STANDALONE) && !defined(HLTCA_GPUCODE)
+  HighResTimer timer;
+  timer.Start();
+#endif
+
+  HLTTRDPropagator prop(fMerger);
   for (int i=0; i<nTPCtracks; ++i) {
     // TODO is this copying necessary or can it be omitted for optimization?
     HLTTRDTrack tMI(tracksTPC[i]);
     HLTTRDTrack *t = &tMI;
-    t->SetTPCtrackId(i);
+    t->SetTPCtrackId(tracksTPCId ? tracksTPCId[i] : i);
     t->SetLabel(tracksTPClab[i]);
     if (tracksTPCnTrklts) {
       t->SetNtrackletsOffline(tracksTPCnTrklts[i]);
@@ -265,15 +300,62 @@ GPUd() void AliHLTTRDTracker::DoTracking( HLTTRDTrack *tracksTPC, int *tracksTPC
     if (tracksTRDlabel) {
       t->SetLabelOffline(tracksTRDlabel[i]);
     }
-    HLTTRDPropagator prop(fMerger);
     prop.setTrack(t);
     FollowProlongation(&prop, t, nTPCtracks);
     fTracks[fNTracks++] = *t;
   }
+  fNTracksProcessed += nTPCtracks;
+  fNTracksFollowed[iSearch] += nTPCtracks;
+#if defined(HLTCA_STANDALONE) && !defined(HLTCA_GPUCODE)
+  fFollowTime[iSearch] += timer.GetCurrentElapsedTime();
+#endif
 
   fNEvents++;
 }
 
+GPUd() int AliHLTTRDTracker::DoTracking( const AliHLTTPCGMMerger *merger, const char *selectTrack, const int *tracksMergerLab )
+{
+  //--------------------------------------------------------------------
+  // Tracking seeded directly by the outer parameters of the merged TPC tracks,
+  // for TRD tracking in the same process as the TPC global merger.
+  // Only tracks with selectTrack[i] != 0 are used (all good tracks if not given),
+  // tracksMergerLab are the MC labels indexed by merged track (optional).
+  // Returns the number of seeds
+  //--------------------------------------------------------------------
+  const int nMergedTracks = merger->NOutputTracks();
+  if (nMergedTracks > fNTracksTPCMax) {
+    delete[] fTracksTPC;
+    delete[] fTracksTPCLab;
+    delete[] fTracksTPCId;
+    fNTracksTPCMax = nMergedTracks;
+    fTracksTPC = new HLTTRDTrack[fNTracksTPCMax];
+    fTracksTPCLab = new int[fNTracksTPCMax];
+    fTracksTPCId = new int[fNTracksTPCMax];
+  }
+
+  int nTPCtracks = 0;
+  for (int iTrk=0; iTrk<nMergedTracks; ++iTrk) {
+    const AliHLTTPCGMMergedTrack &track = merger->OutputTracks()[iTrk];
+    if (!track.OK() || (selectTrack && !selectTrack[iTrk])) {
+      continue;
+    }
+    const AliHLTTPCGMTrackParam::AliHLTTPCCAOuterParam &param = track.OuterParam();
+    // normalize the angle to +-Pi
+    float alpha = param.fAlpha - CAMath::Nint(param.fAlpha / CAMath::TwoPi()) * CAMath::TwoPi();
+    fTracksTPC[nTPCtracks].set(param.fX, alpha, param.fP, param.fC);
+    fTracksTPCLab[nTPCtracks] = tracksMergerLab ? tracksMergerLab[iTrk] : -1;
+    fTracksTPCId[nTPCtracks] = iTrk;
+    nTPCtracks++;
+  }
+
+  // the propagator takes the magnetic field from the merger
+  const AliHLTTPCGMMerger *defaultMerger = fMerger;
+  fMerger = merger;
+  DoTracking(fTracksTPC, fTracksTPCLab, nTPCtracks, 0x0, 0x0, fTracksTPCId);
+  fMerger = defaultMerger;
+  return nTPCtracks;
+}
+
 
 GPUd() bool AliHLTTRDTracker::CalculateSpacePoints()
 {
@@ -489,9 +571,18 @@ GPUd() bool AliHLTTRDTracker::FollowProlongation(HLTTRDPropagator *prop, HLTTRDT
                     GetSector(prop->getAlpha()), currSec);
           continue;
         }
+#ifdef TRD_PROPAGATOR_GM
+        if (fBatchedTrackletSearch) {
+          if (fNtrackletsInChamber[currDet] == 0 || FindTrackletsInChamberBatched(prop, iCandidate, currIdx, currDet, tilt, roadY, roadZ, pad, nCurrHypothesis)) {
+            continue;
+          }
+          // the track could not be propagated to the first tracklet, the tracklet loop below tries every tracklet
+        }
+#endif
         // first propagate track to x of tracklet
         for (int iTrklt=0; iTrklt<fNtrackletsInChamber[currDet]; ++iTrklt) {
           int trkltIdx = fTrackletIndexArray[currDet] + iTrklt;
+          fNTrackletPropagations++;
           if (!prop->PropagateToX(fSpacePoints[trkltIdx].fR, fgkMaxSnp, fgkMaxStep)) {
             if (ENABLE_WARNING) {
               Warning("FollowProlongation", "Track parameter for track %i, x=%f at tracklet %i x=%f in layer %i cannot be retrieved",
@@ -516,25 +607,9 @@ GPUd() bool AliHLTTRDTracker::FollowProlongation(HLTTRDPropagator *prop, HLTTRDT
             //tracklet is in windwow: get predicted chi2 for update and store tracklet index if best guess
             RecalcTrkltCov(trkltIdx, tilt, fCandidates[2*iCandidate+currIdx].getSnp(), pad->GetRowSize(fTracklets[trkltIdx].GetZbin()));
             float chi2 = prop->getPredictedChi2(trkltPosTmpYZ, fSpacePoints[trkltIdx].fCov);
+            fNTrackletChi2++;
             if (chi2 < fMaxChi2) {
-              if (nCurrHypothesis < fNhypothesis) {
-                fHypothesis[nCurrHypothesis].fChi2 = fCandidates[2*iCandidate+currIdx].GetChi2() + chi2;
-                fHypothesis[nCurrHypothesis].fLayers = fCandidates[2*iCandidate+currIdx].GetNlayers();
-                fHypothesis[nCurrHypothesis].fCandidateId = iCandidate;
-                fHypothesis[nCurrHypothesis].fTrackletId = trkltIdx;
-                nCurrHypothesis++;
-              }
-              else {
-                //std::sort(fHypothesis, fHypothesis+nCurrHypothesis, Hypothesis_Sort);
-                Quicksort(0, nCurrHypothesis - 1, nCurrHypothesis, 1);
-                if ( ((chi2 + fCandidates[2*iCandidate+currIdx].GetChi2()) / CAMath::Max(fCandidates[2*iCandidate+currIdx].GetNlayers(), 1)) <
-                      (fHypothesis[nCurrHypothesis].fChi2 / CAMath::Max(fHypothesis[nCurrHypothesis].fLayers, 1)) ) {
-                  fHypothesis[nCurrHypothesis-1].fChi2 = fCandidates[2*iCandidate+currIdx].GetChi2() + chi2;
-                  fHypothesis[nCurrHypothesis-1].fLayers = fCandidates[2*iCandidate+currIdx].GetNlayers();
-                  fHypothesis[nCurrHypothesis-1].fCandidateId = iCandidate;
-                  fHypothesis[nCurrHypothesis-1].fTrackletId = trkltIdx;
-                }
-              }
+              AddTrackletHypothesis(nCurrHypothesis, &fCandidates[2*iCandidate+currIdx], iCandidate, trkltIdx, chi2);
             } // end tracklet chi2 < fMaxChi2
           } // end tracklet in window
         } // tracklet loop
@@ -811,6 +886,131 @@ GPUd() bool AliHLTTRDTracker::FollowProlongation(HLTTRDPropagator *prop, HLTTRDT
   return true;
 }
 
+GPUd() void AliHLTTRDTracker::AddTrackletHypothesis(int &nCurrHypothesis, const HLTTRDTrack *candidate, const int iCandidate, const int trkltIdx, const float chi2)
+{
+  //--------------------------------------------------------------------
+  // Add the update of candidate iCandidate with tracklet trkltIdx to the
+  // hypothesis list, if the list is full replace the worst hypothesis
+  //--------------------------------------------------------------------
+  if (nCurrHypothesis < fNhypothesis) {
+    fHypothesis[nCurrHypothesis].fChi2 = candidate->GetChi2() + chi2;
+    fHypothesis[nCurrHypothesis].fLayers = candidate->GetNlayers();
+    fHypothesis[nCurrHypothesis].fCandidateId = iCandidate;
+    fHypothesis[nCurrHypothesis].fTrackletId = trkltIdx;
+    nCurrHypothesis++;
+  }
+  else {
+    //std::sort(fHypothesis, fHypothesis+nCurrHypothesis, Hypothesis_Sort);
+    Quicksort(0, nCurrHypothesis - 1, nCurrHypothesis, 1);
+    if ( ((chi2 + candidate->GetChi2()) / CAMath::Max(candidate->GetNlayers(), 1)) <
+          (fHypothesis[nCurrHypothesis].fChi2 / CAMath::Max(fHypothesis[nCurrHypothesis].fLayers, 1)) ) {
+      fHypothesis[nCurrHypothesis-1].fChi2 = candidate->GetChi2() + chi2;
+      fHypothesis[nCurrHypothesis-1].fLayers = candidate->GetNlayers();
+      fHypothesis[nCurrHypothesis-1].fCandidateId = iCandidate;
+      fHypothesis[nCurrHypothesis-1].fTrackletId = trkltIdx;
+    }
+  }
+}
+
+#ifdef TRD_PROPAGATOR_GM
+GPUd() bool AliHLTTRDTracker::FindTrackletsInChamberBatched(HLTTRDPropagator *prop, const int iCandidate, const int currIdx, const int det, const float tilt,
+                                                            const float roadY, const float roadZ, AliHLTTRDpadPlane *pad, int &nCurrHypothesis)
+{
+  //--------------------------------------------------------------------
+  // Tracklet search in chamber det, specialised for the GM propagator:
+  // the candidate is propagated once, to the radius of the first tracklet,
+  // the track positions at the radii of the other tracklets (which differ
+  // only by the misalignment) are helix steps from there, and the chi2 of
+  // the tracklets are computed in batches with the covariance of the track
+  // at the first tracklet, by loops without branches.
+  // Same selection as the tracklet loop in FollowProlongation.
+  // Returns false if the track cannot be propagated to the first tracklet,
+  // then the caller falls back to the tracklet loop, which skips only the
+  // tracklets that cannot be reached
+  //--------------------------------------------------------------------
+  const int kBatch = 16;
+  HLTTRDTrack *cand = &fCandidates[2*iCandidate+currIdx];
+  const int firstIdx = fTrackletIndexArray[det];
+  const int nTracklets = fNtrackletsInChamber[det];
+
+  fNTrackletPropagations++;
+  if (!prop->PropagateToX(fSpacePoints[firstIdx].fR, fgkMaxSnp, fgkMaxStep)) {
+    if (ENABLE_WARNING) {
+      Warning("FindTrackletsInChamberBatched", "Track parameter for track %i, x=%f at tracklet x=%f in chamber %i cannot be retrieved",
+        cand->GetTPCtrackId(), cand->getX(), fSpacePoints[firstIdx].fR, det);
+    }
+    return false;
+  }
+  const float snp = cand->getSnp();
+  const float tgl = cand->getTgl();
+  const float sigmaY2 = cand->getSigmaY2();
+  const float sigmaZ2 = cand->getSigmaZ2();
+
+  float trkltR[kBatch], trkltY[kBatch], trkltZ[kBatch], rowSize[kBatch], trkltCov0[kBatch], trkltCov2[kBatch];
+  float trackY[kBatch], trackZ[kBatch], chi2[kBatch];
+  bool ok[kBatch];
+  for (int iFirst=0; iFirst<nTracklets; iFirst += kBatch) {
+    const int n = CAMath::Min(kBatch, nTracklets - iFirst);
+    for (int i=0; i<n; i++) {
+      const int trkltIdx = firstIdx + iFirst + i;
+      rowSize[i] = pad->GetRowSize(fTracklets[trkltIdx].GetZbin());
+      RecalcTrkltCov(trkltIdx, tilt, snp, rowSize[i]);
+      trkltR[i] = fSpacePoints[trkltIdx].fR;
+      trkltY[i] = fSpacePoints[trkltIdx].fX[0];
+      trkltZ[i] = fSpacePoints[trkltIdx].fX[1];
+      trkltCov0[i] = fSpacePoints[trkltIdx].fCov[0];
+      trkltCov2[i] = fSpacePoints[trkltIdx].fCov[2];
+    }
+    prop->getPredictedYZ(n, trkltR, trackY, trackZ, ok);
+    for (int i=0; i<n; i++) {
+      const float zPosCorr = trkltZ[i] + fZCorrCoefNRC * tgl;
+      const float deltaZ = zPosCorr - trackZ[i];
+      const float tiltCorr = tilt * (trkltZ[i] - trackZ[i]);
+      // tilt correction only makes sense if deltaZ < l_pad && track z err << l_pad
+      const bool correctTilt = CAMath::Abs(trkltZ[i] - trackZ[i]) < rowSize[i] && sigmaZ2 < rowSize[i] * rowSize[i] / 12.f;
+      const float deltaY = trkltY[i] - trackY[i] - (correctTilt ? tiltCorr : 0.f);
+      const float residualY = trkltY[i] - tiltCorr - trackY[i];
+      const bool inRoad = ok[i] && CAMath::Abs(deltaY) < roadY && CAMath::Abs(deltaZ) < roadZ;
+      const float chi2Trklt = residualY * residualY / (trkltCov0[i] + sigmaY2) + deltaZ * deltaZ / (trkltCov2[i] + sigmaZ2);
+      chi2[i] = inRoad ? chi2Trklt : -1.f;
+    }
+    for (int i=0; i<n; i++) {
+      if (chi2[i] < 0.f) {
+        continue;
+      }
+      fNTrackletChi2++;
+      if (chi2[i] < fMaxChi2) {
+        AddTrackletHypothesis(nCurrHypothesis, cand, iCandidate, firstIdx + iFirst + i, chi2[i]);
+      }
+    }
+    if (fDebugOutput && iFirst + n == nTracklets && ok[n-1]) {
+      CheckPredictedYZ(prop, cand, trkltR[n-1], trackY[n-1], trackZ[n-1]);
+    }
+  }
+  return true;
+}
+
+GPUd() void AliHLTTRDTracker::CheckPredictedYZ(HLTTRDPropagator *prop, HLTTRDTrack *cand, const float x, const float y, const float z)
+{
+  //--------------------------------------------------------------------
+  // Debug check of the helix steps of the batched tracklet search:
+  // a copy of the candidate is propagated to x, its y and z must agree
+  // with the predicted ones. The propagator is reset to the candidate
+  //--------------------------------------------------------------------
+  HLTTRDTrack trkCopy(*cand);
+  prop->setTrack(&trkCopy);
+  if (prop->PropagateToX(x, fgkMaxSnp, fgkMaxStep)) {
+    const float dy = trkCopy.getY() - y;
+    const float dz = trkCopy.getZ() - z;
+    if (CAMath::Abs(dy) > 1.e-2f || CAMath::Abs(dz) > 1.e-2f) {
+      Warning("CheckPredictedYZ", "Predicted position of track %i at x=%f differs from the propagated one: dy=%f, dz=%f",
+        cand->GetTPCtrackId(), x, dy, dz);
+    }
+  }
+  prop->setTrack(cand);
+}
+#endif
+
 GPUd() int AliHLTTRDTracker::GetDetectorNumber(const float zPos, const float alpha, const int layer) const
 {
   //--------------------------------------------------------------------
@@ -1219,4 +1419,29 @@ GPUd() void AliHLTTRDTracker::PrintSettings() const
   printf("fMaxChi2(%f), fChi2Penalty(%f), nCandidates(%i), nHypothesisMax(%i), maxMissingLayers(%i)\n",
           fMaxChi2, fChi2Penalty, fNCandidates, fNhypothesis, fMaxMissingLy);
   printf("ptCut = %f GeV, abs(eta) < %f\n", fMinPt, fMaxEta);
+#ifdef TRD_PROPAGATOR_GM
+  printf("batched tracklet search (%i)\n", (int) fBatchedTrackletSearch);
+#endif
+}
+
+GPUd() void AliHLTTRDTracker::PrintStatistics() const
+{
+  //--------------------------------------------------------------------
+  // Print the work done in the tracklet search and the time per track
+  // of the scalar and the batched search, to compare the propagator
+  // back ends and the two searches
+  //--------------------------------------------------------------------
+  const float nTracks = fNTracksProcessed > 0 ? (float) fNTracksProcessed : 1.f;
+  printf("HLT TRD tracker: %i events, %lld TPC tracks, %lld propagations (%.2f / track) and %lld tracklet chi2 (%.2f / track) in the tracklet search\n",
+          fNEvents, fNTracksProcessed, fNTrackletPropagations, fNTrackletPropagations / nTracks, fNTrackletChi2, fNTrackletChi2 / nTracks);
+  for (int i=0; i<2; ++i) {
+    if (fNTracksFollowed[i] == 0) {
+      continue;
+    }
+#if defined(HLTCA_STANDALONE) && !defined(HLTCA_GPUCODE)
+    printf("  %s tracklet search: %lld tracks followed in %.3f s (%.2f us / track)\n", i ? "batched" : "scalar", fNTracksFollowed[i], fFollowTime[i], fFollowTime[i] * 1.e6 / fNTracksFollowed[i]);
+#else
+    printf("  %s tracklet search: %lld tracks followed\n", i ? "batched" : "scalar", fNTracksFollowed[i]);
+#endif
+  }
 }
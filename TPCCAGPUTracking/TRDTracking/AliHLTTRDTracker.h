@@ -13,6 +13,9 @@ class AliHLTTRDGeometry;
 class AliExternalTrackParam;
 class AliMCEvent;
 class AliHLTTPCGMMerger;
+#ifdef TRD_PROPAGATOR_GM
+class AliHLTTRDpadPlane;
+#endif
 
 //-------------------------------------------------------------------------
 class AliHLTTRDTracker {
@@ -54,9 +57,16 @@ class AliHLTTRDTracker {
   GPUd() void Reset();
   GPUd() void StartLoadTracklets(const int nTrklts);
   GPUd() void LoadTracklet(const AliHLTTRDTrackletWord &tracklet);
-  GPUd() void DoTracking(HLTTRDTrack *tracksTPC, int *tracksTPClab, int nTPCtracks, int *tracksTPCnTrklts = 0x0, int *tracksTRDlabel = 0x0);
+  GPUd() void DoTracking(HLTTRDTrack *tracksTPC, int *tracksTPClab, int nTPCtracks, int *tracksTPCnTrklts = 0x0, int *tracksTRDlabel = 0x0, const int *tracksTPCId = 0x0);
+  GPUd() int DoTracking(const AliHLTTPCGMMerger *merger, const char *selectTrack = 0x0, const int *tracksMergerLab = 0x0);
   GPUd() bool CalculateSpacePoints();
   GPUd() bool FollowProlongation(HLTTRDPropagator *prop, HLTTRDTrack *t, int nTPCtracks);
+  GPUd() void AddTrackletHypothesis(int &nCurrHypothesis, const HLTTRDTrack *candidate, const int iCandidate, const int trkltIdx, const float chi2);
+#ifdef TRD_PROPAGATOR_GM
+  GPUd() bool FindTrackletsInChamberBatched(HLTTRDPropagator *prop, const int iCandidate, const int currIdx, const int det, const float tilt,
+                                            const float roadY, const float roadZ, AliHLTTRDpadPlane *pad, int &nCurrHypothesis);
+  GPUd() void CheckPredictedYZ(HLTTRDPropagator *prop, HLTTRDTrack *cand, const float x, const float y, const float z);
+#endif
   GPUd() int GetDetectorNumber(const float zPos, const float alpha, const int layer) const;
   GPUd() bool AdjustSector(HLTTRDPropagator *prop, HLTTRDTrack *t, const int layer) const;
   GPUd() int GetSector(float alpha) const;
@@ -73,6 +83,7 @@ class AliHLTTRDTracker {
   GPUd() int   PartitionHypothesis(const int left, const int right);
   GPUd() void  Quicksort(const int left, const int right, const int size, const int type = 0);
   GPUd() void  PrintSettings() const;
+  GPUd() void  PrintStatistics() const;
 
   // settings
   GPUd() void SetMCEvent(AliMCEvent* mc)       { fMCEvent = mc;}
@@ -83,6 +94,7 @@ class AliHLTTRDTracker {
   GPUd() void SetChi2Penalty(float chi2)       { fChi2Penalty = chi2; }
   GPUd() void SetMaxMissingLayers(int ly)      { fMaxMissingLy = ly; }
   GPUd() void SetNCandidates(int n);
+  GPUd() void SetBatchedTrackletSearch(bool b) { fBatchedTrackletSearch = b; }
 
   GPUd() AliMCEvent * GetMCEvent()   const { return fMCEvent; }
   GPUd() bool  GetIsDebugOutputOn()  const { return fDebugOutput; }
@@ -92,6 +104,7 @@ class AliHLTTRDTracker {
   GPUd() float GetChi2Penalty()      const { return fChi2Penalty; }
   GPUd() int   GetMaxMissingLayers() const { return fMaxMissingLy; }
   GPUd() int   GetNCandidates()      const { return fNCandidates; }
+  GPUd() bool  GetBatchedTrackletSearch() const { return fBatchedTrackletSearch; }
 
   // output
   GPUd() HLTTRDTrack *Tracks()                       const { return fTracks;}
@@ -102,6 +115,11 @@ class AliHLTTRDTracker {
   float *fR;                                  // rough radial position of each TRD layer
   bool fIsInitialized;                        // flag is set upon initialization
   HLTTRDTrack *fTracks;                       // array of trd-updated tracks
+  int fNTracksMax;                            // allocated size of fTracks
+  HLTTRDTrack *fTracksTPC;                    // input TPC tracks taken directly from the merger
+  int *fTracksTPCLab;                         // MC labels of the input TPC tracks
+  int *fTracksTPCId;                          // merged track index of the input TPC tracks
+  int fNTracksTPCMax;                         // allocated size of the input TPC track arrays
   int fNCandidates;                           // max. track hypothesis per layer
   int fNTracks;                               // number of TPC tracks to be matched
   int fNEvents;                               // number of processed events
@@ -122,6 +140,12 @@ class AliHLTTRDTracker {
   float fChi2Penalty;                         // chi2 added to the track for no update
   float fZCorrCoefNRC;                        // tracklet z-position depends linearly on track dip angle
   int fNhypothesis;                           // number of track hypothesis per layer
+  bool fBatchedTrackletSearch;                // one propagation per chamber and batched chi2 of its tracklets (GM propagator only)
+  long long fNTracksProcessed;                // statistics: number of TPC tracks followed
+  long long fNTrackletPropagations;           // statistics: propagations in the tracklet search
+  long long fNTrackletChi2;                   // statistics: predicted chi2 of tracklets in the road
+  long long fNTracksFollowed[2];              // statistics: TPC tracks followed with the scalar [0] and the batched [1] tracklet search
+  double fFollowTime[2];                      // statistics: time in s for following these tracks (standalone and O2 builds only)
   unsigned short *fMaskedChambers;            // array with bad TRD chambers indices
   AliMCEvent* fMCEvent;                       //! externaly supplied optional MC event
   const AliHLTTPCGMMerger *fMerger;           // supplying parameters for AliHLTTPCGMPropagator
@@ -49,6 +49,8 @@
 #include "AliHLTTrackMCLabel.h"
 #include "AliHLTTRDTrackData.h"
 #include "AliGeomManager.h"
+#include "AliHLTTPCCAGlobalMergerComponent.h"
+#include "AliHLTTPCGMMerger.h"
 #include <map>
 #include <vector>
 #include <algorithm>
@@ -62,6 +64,10 @@ AliHLTTRDTrackerComponent::AliHLTTRDTrackerComponent() :
   fDebugTrackOutput(false),
   fVerboseDebugOutput(false),
   fRequireITStrack(false),
+  fUseMergerTracks(false),
+  fScalarTrackletSearch(false),
+  fTrackSelection(),
+  fTrackMergerLab(),
   fBenchmark("TRDTracker")
 {
 }
@@ -74,6 +80,10 @@ AliHLTTRDTrackerComponent::AliHLTTRDTrackerComponent( const AliHLTTRDTrackerComp
   fDebugTrackOutput(false),
   fVerboseDebugOutput(false),
   fRequireITStrack(false),
+  fUseMergerTracks(false),
+  fScalarTrackletSearch(false),
+  fTrackSelection(),
+  fTrackMergerLab(),
   fBenchmark("TRDTracker")
 {
   // see header file for class documentation
@@ -160,6 +170,18 @@ int AliHLTTRDTrackerComponent::ReadConfigurationString(  const char* arguments )
       continue;
     }
 
+    if ( argument.CompareTo("-useMergerTracks") == 0 ) {
+      fUseMergerTracks = true;
+      HLTInfo( "TPC tracks are taken directly from the global merger (requires the merger in the same process with -noclear and -nwaysouter)" );
+      continue;
+    }
+
+    if ( argument.CompareTo("-scalarTrackletSearch") == 0 ) {
+      fScalarTrackletSearch = true;
+      HLTInfo( "The track is propagated to every tracklet in the road search (no batched tracklet search)" );
+      continue;
+    }
+
     HLTError( "Unknown option \"%s\"", argument.Data() );
     iResult = -EINVAL;
 
@@ -208,6 +230,7 @@ int AliHLTTRDTrackerComponent::DoInit( int argc, const char** argv ) {
   if (fVerboseDebugOutput) {
     fTracker->EnableDebugOutput();
   }
+  fTracker->SetBatchedTrackletSearch(!fScalarTrackletSearch);
   fTracker->Init();
 
   return iResult;
@@ -218,6 +241,9 @@ int AliHLTTRDTrackerComponent::DoInit( int argc, const char** argv ) {
 // #################################################################################
 int AliHLTTRDTrackerComponent::DoDeinit() {
   // see header file for class documentation
+  if (fTracker) {
+    fTracker->PrintStatistics();
+  }
   delete fTracker;
   fTracker = 0x0;
   return 0;
@@ -287,7 +313,17 @@ int AliHLTTRDTrackerComponent::DoEvent
     }
   }
 
-  if (tpcData == NULL) {
+  // in-process path: the outer parameters of the merged tracks are read directly from the merger's memory
+  const AliHLTTPCGMMerger *merger = NULL;
+  if (fUseMergerTracks) {
+    merger = AliHLTTPCCAGlobalMergerComponent::GetCurrentMerger();
+    if (merger == NULL || !merger->SliceParam().GetNWaysOuter()) {
+      HLTWarning("TPC tracks not available from the global merger (not in the same process, or run without -noclear / -nwaysouter), using the track data block");
+      merger = NULL;
+    }
+  }
+
+  if (tpcData == NULL && merger == NULL) {
     HLTInfo("did not receive any TPC tracks. Skipping event");
     return 0;
   }
@@ -297,52 +333,79 @@ int AliHLTTRDTrackerComponent::DoEvent
     return 0;
   }
 
-  int nTPCtracks = tpcData->fCount;
-  std::vector<bool> itsAvail(nTPCtracks, false);
-  if (itsData) {
-    // look for ITS tracks with >= 2 hits
-    int nITStracks = itsData->fCount;
-    AliHLTExternalTrackParam *currITStrack = itsData->fTracklets;
-    for (int iTrkITS = 0; iTrkITS < nITStracks; iTrkITS++) {
-      if (currITStrack->fNPoints >= 2) {
-        itsAvail.at(currITStrack->fTrackID) = true;
+  if (merger) {
+    // selection and MC labels per merged track, the TPC track IDs of the ITS and MC blocks are the merged track indices
+    const int nMergedTracks = merger->NOutputTracks();
+    if (itsData) {
+      fTrackSelection.assign(nMergedTracks, 0);
+      int nITStracks = itsData->fCount;
+      AliHLTExternalTrackParam *currITStrack = itsData->fTracklets;
+      for (int iTrkITS = 0; iTrkITS < nITStracks; iTrkITS++) {
+        if (currITStrack->fNPoints >= 2 && currITStrack->fTrackID >= 0 && currITStrack->fTrackID < nMergedTracks) {
+          fTrackSelection[currITStrack->fTrackID] = 1;
+        }
+        unsigned int dSize = sizeof(AliHLTExternalTrackParam) + currITStrack->fNPoints * sizeof(unsigned int);
+        currITStrack = (AliHLTExternalTrackParam*) ( ((Byte_t*) currITStrack) + dSize);
       }
-      unsigned int dSize = sizeof(AliHLTExternalTrackParam) + currITStrack->fNPoints * sizeof(unsigned int);
-      currITStrack = (AliHLTExternalTrackParam*) ( ((Byte_t*) currITStrack) + dSize);
     }
-  }
-  std::map<int,int> mcLabels;
-  if (tpcDataMC) {
-    // look for TPC track MC labels
-    int nMCtracks = tpcDataMC->fCount;
-    for (int iMC = 0; iMC < nMCtracks; iMC++) {
-      AliHLTTrackMCLabel &lab = tpcDataMC->fLabels[iMC];
-      mcLabels[lab.fTrackID] = lab.fMCLabel;
+    if (tpcDataMC) {
+      fTrackMergerLab.assign(nMergedTracks, -1);
+      int nMCtracks = tpcDataMC->fCount;
+      for (int iMC = 0; iMC < nMCtracks; iMC++) {
+        AliHLTTrackMCLabel &lab = tpcDataMC->fLabels[iMC];
+        if (lab.fTrackID >= 0 && lab.fTrackID < nMergedTracks) {
+          fTrackMergerLab[lab.fTrackID] = lab.fMCLabel;
+        }
+      }
     }
   }
-  AliHLTExternalTrackParam *currOutTrackTPC = tpcData->fTracklets;
-  for (int iTrk = 0; iTrk < nTPCtracks; iTrk++) {
-    // store TPC tracks (if required only the ones with >=2 ITS hits)
-    if (itsData != NULL && !itsAvail.at(currOutTrackTPC->fTrackID)) {
-      continue;
+  else {
+    int nTPCtracks = tpcData->fCount;
+    std::vector<bool> itsAvail(nTPCtracks, false);
+    if (itsData) {
+      // look for ITS tracks with >= 2 hits
+      int nITStracks = itsData->fCount;
+      AliHLTExternalTrackParam *currITStrack = itsData->fTracklets;
+      for (int iTrkITS = 0; iTrkITS < nITStracks; iTrkITS++) {
+        if (currITStrack->fNPoints >= 2) {
+          itsAvail.at(currITStrack->fTrackID) = true;
+        }
+        unsigned int dSize = sizeof(AliHLTExternalTrackParam) + currITStrack->fNPoints * sizeof(unsigned int);
+        currITStrack = (AliHLTExternalTrackParam*) ( ((Byte_t*) currITStrack) + dSize);
+      }
     }
-    HLTTRDTrack t(*currOutTrackTPC);
-    int mcLabel = -1;
+    std::map<int,int> mcLabels;
     if (tpcDataMC) {
-      if (mcLabels.find(currOutTrackTPC->fTrackID) != mcLabels.end()) {
-        mcLabel = mcLabels[currOutTrackTPC->fTrackID];
+      // look for TPC track MC labels
+      int nMCtracks = tpcDataMC->fCount;
+      for (int iMC = 0; iMC < nMCtracks; iMC++) {
+        AliHLTTrackMCLabel &lab = tpcDataMC->fLabels[iMC];
+        mcLabels[lab.fTrackID] = lab.fMCLabel;
+      }
+    }
+    tracksTPC.reserve(nTPCtracks);
+    tracksTPCId.reserve(nTPCtracks);
+    tracksTPCLab.reserve(nTPCtracks);
+    AliHLTExternalTrackParam *currOutTrackTPC = tpcData->fTracklets;
+    for (int iTrk = 0; iTrk < nTPCtracks; iTrk++) {
+      AliHLTExternalTrackParam *nextOutTrackTPC = (AliHLTExternalTrackParam*) ( ((Byte_t*) currOutTrackTPC) + sizeof(AliHLTExternalTrackParam) + currOutTrackTPC->fNPoints * sizeof(unsigned int) );
+      // store TPC tracks (if required only the ones with >=2 ITS hits)
+      if (itsData == NULL || itsAvail.at(currOutTrackTPC->fTrackID)) {
+        HLTTRDTrack t(*currOutTrackTPC);
+        int mcLabel = -1;
+        if (tpcDataMC) {
+          if (mcLabels.find(currOutTrackTPC->fTrackID) != mcLabels.end()) {
+            mcLabel = mcLabels[currOutTrackTPC->fTrackID];
+          }
+        }
+        tracksTPC.push_back( t );
+        tracksTPCId.push_back( currOutTrackTPC->fTrackID );
+        tracksTPCLab.push_back( mcLabel );
       }
+      currOutTrackTPC = nextOutTrackTPC;
     }
-    tracksTPC.push_back( t );
-    tracksTPCId.push_back( currOutTrackTPC->fTrackID );
-    tracksTPCLab.push_back( mcLabel );
-    unsigned int dSize = sizeof(AliHLTExternalTrackParam) + currOutTrackTPC->fNPoints * sizeof(unsigned int);
-    currOutTrackTPC = (AliHLTExternalTrackParam*) + ( ((Byte_t*) currOutTrackTPC) + dSize );
   }
 
-
-
-
   if (fVerboseDebugOutput) {
     HLTInfo("TRDTrackerComponent received %i tracklets\n", nTrackletsTotal);
   }
@@ -356,7 +419,12 @@ int AliHLTTRDTrackerComponent::DoEvent
   }
 
   fBenchmark.Start(1);
-  fTracker->DoTracking(&(tracksTPC[0]), &(tracksTPCLab[0]), tracksTPC.size());
+  if (merger) {
+    fTracker->DoTracking(merger, itsData ? fTrackSelection.data() : 0x0, tpcDataMC ? fTrackMergerLab.data() : 0x0);
+  }
+  else {
+    fTracker->DoTracking(tracksTPC.data(), tracksTPCLab.data(), tracksTPC.size(), 0x0, 0x0, tracksTPCId.data());
+  }
   fBenchmark.Stop(1);
 
   HLTTRDTrack *trackArray = fTracker->Tracks();
@@ -18,6 +18,7 @@
 #include "AliHLTProcessor.h"
 #include "AliHLTComponentBenchmark.h"
 #include "AliHLTDataTypes.h"
+#include <vector>
 
 class TH1F;
 class TList;
@@ -129,6 +130,10 @@ private:
   bool fDebugTrackOutput; // output AliHLTTRDTracks instead AliHLTExternalTrackParam
   bool fVerboseDebugOutput; // more verbose information is printed
   bool fRequireITStrack;  // only TPC tracks with ITS match are used as seeds for tracking
+  bool fUseMergerTracks;  // take the TPC tracks directly from the global merger in the same process
+  bool fScalarTrackletSearch; // propagate to every tracklet instead of the batched tracklet search (GM propagator)
+  std::vector<char> fTrackSelection; // per merged track: seed selected (ITS match), reused for every event
+  std::vector<int> fTrackMergerLab;  // per merged track: MC label, reused for every event
   AliHLTComponentBenchmark fBenchmark; // benchmark
 
   ClassDef(AliHLTTRDTrackerComponent, 0)
@@ -0,0 +1,316 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+
+/// \file  IrregularSplineKnotOptimizer.cxx
+/// \brief Implementation of IrregularSplineKnotOptimizer class
+///
+/// \author  Sergey Gorbunov <sergey.gorbunov@cern.ch>
+
+
+#include "IrregularSplineKnotOptimizer.h"
+#include "IrregularSpline1D.h"
+#include "IrregularSpline2D3D.h"
+#include <cmath>
+
+namespace ali_tpc_common {
+namespace tpc_fast_transformation {
+
+
+IrregularSplineKnotOptimizer::IrregularSplineKnotOptimizer()
+  :
+  mMaxError( 0.01 ),
+  mNumberOfSamplesU( 100 ),
+  mNumberOfSamplesV( 100 ),
+  mMaxNumberOfKnotsU( 50 ),
+  mMaxNumberOfKnotsV( 50 ),
+  mDoKnotRemoval( true ),
+  mAxisBinsU( 0 ),
+  mAxisBinsV( 0 ),
+  mNumberOfFunctions( 1 ),
+  mSampleBinsU(),
+  mSampleBinsV(),
+  mSampleValues()
+{
+}
+
+
+void IrregularSplineKnotOptimizer::createSamples( int nSamples, int numberOfAxisBins, std::vector<int> &sampleBins )
+{
+  /// Creates sample positions [axis bins] for an axis. The positions are strictly increasing.
+
+  if( nSamples < 5 ) nSamples = 5;
+  if( nSamples > numberOfAxisBins + 1 ) nSamples = numberOfAxisBins + 1;
+  sampleBins.resize( nSamples );
+  for( int i=0; i<nSamples; i++ ){
+    sampleBins[i] = (int) round( i*( (double) numberOfAxisBins )/( nSamples-1 ) );
+  }
+}
+
+
+void IrregularSplineKnotOptimizer::createInitialKnots( int nSamples, std::vector<int> &knots )
+{
+  /// Creates 5 equidistant knots [sample indices]
+  knots.resize( 5 );
+  for( int i=0; i<5; i++ ){
+    knots[i] = (int) round( i*( nSamples-1 )/4. );
+  }
+}
+
+
+void IrregularSplineKnotOptimizer::getKnotPositions( const std::vector<int> &knots, const std::vector<int> &sampleBins, int numberOfAxisBins, std::vector<float> &u )
+{
+  /// Converts knot sample indices to U coordinates of the knots
+  u.resize( knots.size() );
+  for( size_t i=0; i<knots.size(); i++ ){
+    u[i] = sampleBins[ knots[i] ] / ( (double) numberOfAxisBins );
+  }
+}
+
+
+bool IrregularSplineKnotOptimizer::splitInterval( std::vector<int> &knots, const std::vector<float> &intervalErrors )
+{
+  /// Splits the worst splittable interval, returns false if nothing can be split
+
+  int worst = -1;
+  float worstError = 0.f;
+  for( size_t i=0; i+1<knots.size(); i++ ){
+    if( knots[i+1] - knots[i] < 2 ) continue; // no sample points in between
+    if( intervalErrors[i] > worstError ){
+      worst = i;
+      worstError = intervalErrors[i];
+    }
+  }
+  if( worst<0 ) return false;
+  knots.insert( knots.begin() + worst + 1, ( knots[worst] + knots[worst+1] )/2 );
+  return true;
+}
+
+
+float IrregularSplineKnotOptimizer::evaluate1D( const std::vector<int> &knots, std::vector<float> *intervalErrors )
+{
+  /// Evaluates 1D spline with the given knots at the sample points
+
+  std::vector<float> knotsU;
+  getKnotPositions( knots, mSampleBinsU, mAxisBinsU, knotsU );
+
+  IrregularSpline1D spline;
+  spline.construct( knotsU.size(), knotsU.data(), mAxisBinsU );
+
+  std::vector<float> data( knots.size() );
+  for( size_t i=0; i<knots.size(); i++ ) data[i] = mSampleValues[ knots[i] ];
+  spline.correctEdges( data.data() );
+
+  if( intervalErrors ) intervalErrors->assign( knots.size()-1, 0.f );
+
+  float maxError = 0.f;
+  for( int is=0, iInt=0; is<(int) mSampleBinsU.size(); is++ ){
+    while( iInt < (int) knots.size()-2 && is >= knots[iInt+1] ) iInt++;
+    float u = mSampleBinsU[is] / ( (double) mAxisBinsU );
+    float err = fabs( spline.getSpline( data.data(), u ) - mSampleValues[is] );
+    if( err > maxError ) maxError = err;
+    if( intervalErrors && err > (*intervalErrors)[iInt] ) (*intervalErrors)[iInt] = err;
+  }
+  return maxError;
+}
+
+
+float IrregularSplineKnotOptimizer::evaluate2D( const std::vector<int> &knotsU, const std::vector<int> &knotsV,
+						std::vector<float> *intervalErrorsU, std::vector<float> *intervalErrorsV )
+{
+  /// Evaluates 2D3D spline with the given knots at the sample points
+
+  std::vector<float> posU, posV;
+  getKnotPositions( knotsU, mSampleBinsU, mAxisBinsU, posU );
+  getKnotPositions( knotsV, mSampleBinsV, mAxisBinsV, posV );
+
+  IrregularSpline2D3D spline;
+  spline.construct( posU.size(), posU.data(), mAxisBinsU, posV.size(), posV.data(), mAxisBinsV );
+
+  int nu = knotsU.size();
+  int nv = knotsV.size();
+  int nSamplesU = mSampleBinsU.size();
+  int nSamplesV = mSampleBinsV.size();
+
+  if( intervalErrorsU ) intervalErrorsU->assign( nu-1, 0.f );
+  if( intervalErrorsV ) intervalErrorsV->assign( nv-1, 0.f );
+
+  std::vector<float> data( 3*nu*nv );
+  float maxError = 0.f;
+
+  for( int iFunc=0; iFunc<mNumberOfFunctions; iFunc++ ){
+    const float *samples = &mSampleValues[ 3*iFunc*nSamplesU*nSamplesV ];
+    for( int iv=0; iv<nv; iv++ ){
+      for( int iu=0; iu<nu; iu++ ){
+	const float *f = &samples[ 3*( knotsV[iv]*nSamplesU + knotsU[iu] ) ];
+	for( int idim=0; idim<3; idim++ ) data[ 3*(iv*nu + iu) + idim ] = f[idim];
+      }
+    }
+    spline.correctEdges( data.data() );
+
+    for( int isv=0, iIntV=0; isv<nSamplesV; isv++ ){
+      while( iIntV < nv-2 && isv >= knotsV[iIntV+1] ) iIntV++;
+      float v = mSampleBinsV[isv] / ( (double) mAxisBinsV );
+      for( int isu=0, iIntU=0; isu<nSamplesU; isu++ ){
+	while( iIntU < nu-2 && isu >= knotsU[iIntU+1] ) iIntU++;
+	float u = mSampleBinsU[isu] / ( (double) mAxisBinsU );
+	float x=0, y=0, z=0;
+	spline.getSpline( data.data(), u, v, x, y, z );
+	const float *f = &samples[ 3*( isv*nSamplesU + isu ) ];
+	float err = fmax( fabs( x - f[0] ), fmax( fabs( y - f[1] ), fabs( z - f[2] ) ) );
+	if( err > maxError ) maxError = err;
+	if( intervalErrorsU && err > (*intervalErrorsU)[iIntU] ) (*intervalErrorsU)[iIntU] = err;
+	if( intervalErrorsV && err > (*intervalErrorsV)[iIntV] ) (*intervalErrorsV)[iIntV] = err;
+      }
+    }
+  }
+  return maxError;
+}
+
+
+float IrregularSplineKnotOptimizer::optimize( IrregularSpline1D &spline, int numberOfAxisBins, const Function1D &f )
+{
+  /// Constructs a 1D spline with optimised knots. Returns the maximal deviation at the sample points.
+
+  if( numberOfAxisBins<4 ) numberOfAxisBins = 4;
+  mAxisBinsU = numberOfAxisBins;
+  createSamples( mNumberOfSamplesU, mAxisBinsU, mSampleBinsU );
+
+  int nSamples = mSampleBinsU.size();
+  mSampleValues.resize( nSamples );
+  for( int i=0; i<nSamples; i++ ){
+    mSampleValues[i] = f( mSampleBinsU[i] / ( (double) mAxisBinsU ) );
+  }
+
+  std::vector<int> knots;
+  createInitialKnots( nSamples, knots );
+
+  // insert knots
+
+  std::vector<float> intervalErrors;
+  float maxError = evaluate1D( knots, &intervalErrors );
+  while( maxError > mMaxError && (int) knots.size() < mMaxNumberOfKnotsU ){
+    if( !splitInterval( knots, intervalErrors ) ) break;
+    maxError = evaluate1D( knots, &intervalErrors );
+  }
+
+  // remove knots
+
+  if( mDoKnotRemoval ){
+    float threshold = fmax( mMaxError, maxError );
+    for( size_t i=1; i+1<knots.size() && knots.size()>5; ){
+      std::vector<int> tmp( knots );
+      tmp.erase( tmp.begin() + i );
+      float err = evaluate1D( tmp, nullptr );
+      if( err <= threshold ){
+	knots.swap( tmp );
+      } else {
+	i++;
+      }
+    }
+  }
+
+  std::vector<float> posU;
+  getKnotPositions( knots, mSampleBinsU, mAxisBinsU, posU );
+  spline.construct( posU.size(), posU.data(), mAxisBinsU );
+  return evaluate1D( knots, nullptr );
+}
+
+
+float IrregularSplineKnotOptimizer::optimize( IrregularSpline2D3D &spline, int numberOfAxisBinsU, int numberOfAxisBinsV, const Function2D3D &f )
+{
+  /// Constructs a 2D3D spline with optimised knots. Returns the maximal deviation at the sample points.
+
+  return optimize( spline, numberOfAxisBinsU, numberOfAxisBinsV, 1,
+		   [&f]( int, float u, float v, float &fx, float &fy, float &fz ){ f( u, v, fx, fy, fz ); } );
+}
+
+
+float IrregularSplineKnotOptimizer::optimize( IrregularSpline2D3D &spline, int numberOfAxisBinsU, int numberOfAxisBinsV, int numberOfFunctions, const FunctionSet2D3D &f )
+{
+  /// Constructs a 2D3D spline with knots which approximate all the functions of the set.
+  /// Returns the maximal deviation at the sample points over all functions.
+
+  if( numberOfAxisBinsU<4 ) numberOfAxisBinsU = 4;
+  if( numberOfAxisBinsV<4 ) numberOfAxisBinsV = 4;
+  if( numberOfFunctions<1 ) numberOfFunctions = 1;
+  mAxisBinsU = numberOfAxisBinsU;
+  mAxisBinsV = numberOfAxisBinsV;
+  mNumberOfFunctions = numberOfFunctions;
+  createSamples( mNumberOfSamplesU, mAxisBinsU, mSampleBinsU );
+  createSamples( mNumberOfSamplesV, mAxisBinsV, mSampleBinsV );
+
+  int nSamplesU = mSampleBinsU.size();
+  int nSamplesV = mSampleBinsV.size();
+  mSampleValues.resize( 3*mNumberOfFunctions*nSamplesU*nSamplesV );
+  for( int iFunc=0; iFunc<mNumberOfFunctions; iFunc++ ){
+    for( int iv=0; iv<nSamplesV; iv++ ){
+      float v = mSampleBinsV[iv] / ( (double) mAxisBinsV );
+      for( int iu=0; iu<nSamplesU; iu++ ){
+	float u = mSampleBinsU[iu] / ( (double) mAxisBinsU );
+	float *fv = &mSampleValues[ 3*( ( iFunc*nSamplesV + iv )*nSamplesU + iu ) ];
+	f( iFunc, u, v, fv[0], fv[1], fv[2] );
+      }
+    }
+  }
+
+  std::vector<int> knotsU, knotsV;
+  createInitialKnots( nSamplesU, knotsU );
+  createInitialKnots( nSamplesV, knotsV );
+
+  // insert knots, the axis with the worse interval goes first
+
+  std::vector<float> errorsU, errorsV;
+  float maxError = evaluate2D( knotsU, knotsV, &errorsU, &errorsV );
+  while( maxError > mMaxError ){
+    bool canU = ( (int) knotsU.size() < mMaxNumberOfKnotsU );
+    bool canV = ( (int) knotsV.size() < mMaxNumberOfKnotsV );
+    float maxU = 0.f, maxV = 0.f;
+    for( size_t i=0; i<errorsU.size(); i++ ) maxU = fmax( maxU, errorsU[i] );
+    for( size_t i=0; i<errorsV.size(); i++ ) maxV = fmax( maxV, errorsV[i] );
+    bool ok = false;
+    if( canU && ( maxU >= maxV || !canV ) ){
+      ok = splitInterval( knotsU, errorsU );
+      if( !ok && canV ) ok = splitInterval( knotsV, errorsV );
+    } else if( canV ){
+      ok = splitInterval( knotsV, errorsV );
+      if( !ok && canU ) ok = splitInterval( knotsU, errorsU );
+    }
+    if( !ok ) break;
+    maxError = evaluate2D( knotsU, knotsV, &errorsU, &errorsV );
+  }
+
+  // remove knots
+
+  if( mDoKnotRemoval ){
+    float threshold = fmax( mMaxError, maxError );
+    for( int axis=0; axis<2; axis++ ){
+      std::vector<int> &knots = ( axis==0 ) ?knotsU :knotsV;
+      for( size_t i=1; i+1<knots.size() && knots.size()>5; ){
+	std::vector<int> tmp( knots );
+	tmp.erase( tmp.begin() + i );
+	float err = ( axis==0 ) ?evaluate2D( tmp, knotsV, nullptr, nullptr ) :evaluate2D( knotsU, tmp, nullptr, nullptr );
+	if( err <= threshold ){
+	  knots.swap( tmp );
+	} else {
+	  i++;
+	}
+      }
+    }
+  }
+
+  std::vector<float> posU, posV;
+  getKnotPositions( knotsU, mSampleBinsU, mAxisBinsU, posU );
+  getKnotPositions( knotsV, mSampleBinsV, mAxisBinsV, posV );
+  spline.construct( posU.size(), posU.data(), mAxisBinsU, posV.size(), posV.data(), mAxisBinsV );
+  return evaluate2D( knotsU, knotsV, nullptr, nullptr );
+}
+
+}} // namespaces
@@ -0,0 +1,152 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file  IrregularSplineKnotOptimizer.h
+/// \brief Definition of IrregularSplineKnotOptimizer class
+///
+/// \author  Sergey Gorbunov <sergey.gorbunov@cern.ch>
+
+
+#ifndef ALICE_ALITPCOMMON_TPCFASTTRANSFORMATION_IRREGULARSPLINEKNOTOPTIMIZER_H
+#define ALICE_ALITPCOMMON_TPCFASTTRANSFORMATION_IRREGULARSPLINEKNOTOPTIMIZER_H
+
+#include "AliTPCCommonDef.h"
+#include <functional>
+#include <vector>
+
+namespace ali_tpc_common {
+namespace tpc_fast_transformation {
+
+class IrregularSpline1D;
+class IrregularSpline2D3D;
+
+///
+/// The IrregularSplineKnotOptimizer class finds knot positions for IrregularSpline1D and IrregularSpline2D3D splines
+/// which approximate a given function with a given maximal error.
+///
+/// The function is sampled once on a grid of nSamples points per axis.
+/// The sample points are rounded to the axis bins of the spline, and only they are used as knot candidates.
+/// Therefore the constructed spline has exactly the function values at its knots,
+/// and the usual (axis bin) -> (knot) map of the spline is used.
+///
+/// The optimisation is greedy:
+///  1. Start with 5 equidistant knots per axis.
+///  2. While the maximal deviation at the sample points is above the target,
+///     split the knot interval with the largest deviation. For 2D splines, the U and V axes are treated independently:
+///     the deviations are projected to the U and to the V knot intervals, the worse interval is split.
+///  3. Try to remove the knots one by one, as long as the maximal deviation stays below the target.
+///
+/// A 2D3D knot layout can also be optimised for a set of functions, f.e. for the same TPC row in all slices.
+/// Then the deviation is the maximum over all functions of the set.
+///
+/// The result is a constructed spline. The function values at the knots have to be set by the user as usual.
+///
+///  Example:
+///
+///  IrregularSplineKnotOptimizer opt;
+///  opt.setMaxError( 0.01 );
+///  IrregularSpline2D3D spline;
+///  float err = opt.optimize( spline, 100, 1000,
+///     []( float u, float v, float &fx, float &fy, float &fz ){ fx = sin(3*u); fy = v*v; fz = 0; } );
+///
+class IrregularSplineKnotOptimizer
+{
+ public:
+
+  /// Function to approximate with 1D spline: u -> f
+  typedef std::function< float ( float u ) > Function1D;
+
+  /// Function to approximate with 2D3D spline: (u,v) -> (fx,fy,fz)
+  typedef std::function< void ( float u, float v, float &fx, float &fy, float &fz ) > Function2D3D;
+
+  /// Set of functions to approximate with one 2D3D knot layout: (iFunction,u,v) -> (fx,fy,fz)
+  typedef std::function< void ( int iFunction, float u, float v, float &fx, float &fy, float &fz ) > FunctionSet2D3D;
+
+  /// _____________  Constructors / destructors __________________________
+
+  /// Default constructor
+  IrregularSplineKnotOptimizer();
+
+  /// Copy constructor: disabled
+  IrregularSplineKnotOptimizer(const IrregularSplineKnotOptimizer& ) CON_DELETE;
+
+  /// Assignment operator: disabled
+  IrregularSplineKnotOptimizer &operator=(const IrregularSplineKnotOptimizer &) CON_DELETE;
+
+  /// Destructor
+  ~IrregularSplineKnotOptimizer() CON_DEFAULT;
+
+  /// _______________  Settings  ________________________
+
+  /// Sets target maximal deviation of the spline from the function
+  void setMaxError( float v ) { mMaxError = v; }
+
+  /// Sets number of function samples per axis
+  void setNumberOfSamples( int nU, int nV ) { mNumberOfSamplesU = nU; mNumberOfSamplesV = nV; }
+
+  /// Sets maximal number of knots per axis
+  void setMaxNumberOfKnots( int nU, int nV ) { mMaxNumberOfKnotsU = nU; mMaxNumberOfKnotsV = nV; }
+
+  /// Switches the knot removal phase on/off
+  void setDoKnotRemoval( bool v ) { mDoKnotRemoval = v; }
+
+  /// _______________  Main functionality  ________________________
+
+  /// Constructs a 1D spline with optimised knots. Returns the maximal deviation at the sample points.
+  float optimize( IrregularSpline1D &spline, int numberOfAxisBins, const Function1D &f );
+
+  /// Constructs a 2D3D spline with optimised knots. Returns the maximal deviation at the sample points.
+  float optimize( IrregularSpline2D3D &spline, int numberOfAxisBinsU, int numberOfAxisBinsV, const Function2D3D &f );
+
+  /// Constructs a 2D3D spline with knots which approximate all the functions of the set, f.e. the same TPC row in all slices.
+  /// Returns the maximal deviation at the sample points over all functions.
+  float optimize( IrregularSpline2D3D &spline, int numberOfAxisBinsU, int numberOfAxisBinsV, int numberOfFunctions, const FunctionSet2D3D &f );
+
+ private:
+
+  /// Creates sample positions [axis bins] for an axis
+  static void createSamples( int nSamples, int numberOfAxisBins, std::vector<int> &sampleBins );
+
+  /// Creates initial equidistant knots [sample indices]
+  static void createInitialKnots( int nSamples, std::vector<int> &knots );
+
+  /// Splits the worst splittable interval, returns false if nothing can be split
+  static bool splitInterval( std::vector<int> &knots, const std::vector<float> &intervalErrors );
+
+  /// Evaluates 1D spline with the given knots at the sample points
+  float evaluate1D( const std::vector<int> &knots, std::vector<float> *intervalErrors );
+
+  /// Evaluates 2D3D spline with the given knots at the sample points
+  float evaluate2D( const std::vector<int> &knotsU, const std::vector<int> &knotsV,
+		    std::vector<float> *intervalErrorsU, std::vector<float> *intervalErrorsV );
+
+  /// Converts knot sample indices to U coordinates of the knots
+  static void getKnotPositions( const std::vector<int> &knots, const std::vector<int> &sampleBins, int numberOfAxisBins, std::vector<float> &u );
+
+  float mMaxError; ///< target maximal deviation
+  int mNumberOfSamplesU; ///< number of samples for U axis
+  int mNumberOfSamplesV; ///< number of samples for V axis
+  int mMaxNumberOfKnotsU; ///< max. number of knots for U axis
+  int mMaxNumberOfKnotsV; ///< max. number of knots for V axis
+  bool mDoKnotRemoval; ///< try to remove knots at the end
+
+  /// _______________  Temporary data of the current optimisation ________________________
+
+  int mAxisBinsU; ///< number of axis bins, U axis
+  int mAxisBinsV; ///< number of axis bins, V axis
+  int mNumberOfFunctions; ///< number of sampled functions
+  std::vector<int> mSampleBinsU;  ///< sample positions [axis bins], U axis
+  std::vector<int> mSampleBinsV;  ///< sample positions [axis bins], V axis
+  std::vector<float> mSampleValues; ///< function values at the samples, for 2D3D: [function][v sample][u sample][3]
+};
+
+}} // namespaces
+
+#endif
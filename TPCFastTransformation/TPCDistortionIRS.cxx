@@ -16,6 +16,7 @@
 
 
 #include "TPCDistortionIRS.h"
+#include <cmath>
 
 namespace ali_tpc_common {
 namespace tpc_fast_transformation {
@@ -38,6 +39,7 @@ TPCDistortionIRS::TPCDistortionIRS()
   mScaleSVtoVsideC( 0.f ),
   mTimeStamp( -1 ),
   mSplineData( nullptr ),
+  mSplineDataInverse( nullptr ),
   mSliceDataSizeBytes( 0 )
 {  
   // Default Constructor: creates an empty uninitialized object
@@ -60,6 +62,7 @@ void TPCDistortionIRS::destroy()
   mScaleSVtoVsideC = 0.f;
   mTimeStamp = -1;
   mSplineData = nullptr;
+  mSplineDataInverse = nullptr;
   mSliceDataSizeBytes = 0;
   FlatObject::destroy();
 }
@@ -76,6 +79,7 @@ void TPCDistortionIRS::relocateBufferPointers( const char* oldBuffer, char *newB
     sp.setActualBufferAddress( newSplineBuf );
   }
   mSplineData = relocatePointer( oldBuffer, newBuffer, mSplineData );
+  mSplineDataInverse = relocatePointer( oldBuffer, newBuffer, mSplineDataInverse );
 }
 
   
@@ -106,6 +110,11 @@ void TPCDistortionIRS::cloneFromObject( const TPCDistortionIRS &obj, char *newFl
 
   mSliceDataSizeBytes = obj.mSliceDataSizeBytes;
 
+  mRowInfoPtr = obj.mRowInfoPtr;
+  mScenarioPtr = obj.mScenarioPtr;
+  mSplineData = obj.mSplineData;
+  mSplineDataInverse = obj.mSplineDataInverse;
+
   relocateBufferPointers( oldFlatBufferPtr, mFlatBufferPtr );
 }
   
@@ -151,6 +160,7 @@ void TPCDistortionIRS::setFutureBufferAddress( char* futureFlatBufferPtr )
   }
   mScenarioPtr = relocatePointer( oldBuffer, newBuffer, mScenarioPtr );
   mSplineData = relocatePointer( oldBuffer, newBuffer, mSplineData );
+  mSplineDataInverse = relocatePointer( oldBuffer, newBuffer, mSplineDataInverse );
 
   FlatObject::setFutureBufferAddress( futureFlatBufferPtr );
 }
@@ -183,6 +193,7 @@ void TPCDistortionIRS::startConstruction( int numberOfRows, int numberOfScenario
   mScaleSVtoVsideA = 0.f;
   mScaleSVtoVsideC = 0.f;
   mSplineData = nullptr;
+  mSplineDataInverse = nullptr;
   mSliceDataSizeBytes = 0;
 }
   
@@ -268,7 +279,11 @@ void TPCDistortionIRS::finishConstruction()
     mSliceDataSizeBytes = alignSize( mSliceDataSizeBytes, IrregularSpline2D3D::getDataAlignmentBytes()  );
   }
 
-  FlatObject::finishConstruction( sliceDataOffset + mSliceDataSizeBytes*NumberOfSlices );
+  // the inverse map has the same layout as the forward map and follows it in the buffer
+
+  size_t sliceDataInverseOffset = sliceDataOffset + mSliceDataSizeBytes*NumberOfSlices;
+
+  FlatObject::finishConstruction( sliceDataInverseOffset + mSliceDataSizeBytes*NumberOfSlices );
 
   mRowInfoPtr = reinterpret_cast< RowInfo * > ( mFlatBufferPtr + rowsOffset );  
   for( int i=0; i<mNumberOfRows; i++ ){
@@ -285,6 +300,7 @@ void TPCDistortionIRS::finishConstruction()
   }
 
   mSplineData = reinterpret_cast< char* > ( mFlatBufferPtr + sliceDataOffset);
+  mSplineDataInverse = reinterpret_cast< char* > ( mFlatBufferPtr + sliceDataInverseOffset);
  
   mConstructionCounterRows = 0; 
   mConstructionCounterScenarios = 0;
@@ -299,8 +315,13 @@ void TPCDistortionIRS::finishConstruction()
     for( int row=0; row<mNumberOfRows; row++ ){
       const IrregularSpline2D3D& spline = getSpline( slice, row );
       float *data = getSplineDataNonConst(slice,row);
-      for( int i=0; i<3*spline.getNumberOfKnots(); i++ ) data[i] = 0.f;
+      float *dataInv = getSplineDataInverseNonConst(slice,row);
+      for( int i=0; i<3*spline.getNumberOfKnots(); i++ ){
+	data[i] = 0.f;
+	dataInv[i] = 0.f;
+      }
       spline.correctEdges(data);
+      spline.correctEdges(dataInv);
     }
   }  
 }
@@ -327,6 +348,73 @@ const float *TPCDistortionIRS::getSplineData( int slice, int row ) const
   return reinterpret_cast<float*>( mSplineData + mSliceDataSizeBytes*slice + rowInfo.dataOffsetBytes );
 }
 
+float *TPCDistortionIRS::getSplineDataInverseNonConst( int slice, int row )
+{
+  /// Gives pointer to the inverse spline data  
+  const RowInfo &rowInfo = mRowInfoPtr[ row ];
+  return reinterpret_cast<float*>( mSplineDataInverse + mSliceDataSizeBytes*slice + rowInfo.dataOffsetBytes );
+}
+
+const float *TPCDistortionIRS::getSplineDataInverse( int slice, int row ) const
+{
+  /// Gives pointer to the inverse spline data  
+  const RowInfo &rowInfo = mRowInfoPtr[ row ];
+  return reinterpret_cast<float*>( mSplineDataInverse + mSliceDataSizeBytes*slice + rowInfo.dataOffsetBytes );
+}
+
+
+float TPCDistortionIRS::initInverse( int maxIterations )
+{
+  /// Calculates the inverse distortion map from the current distortion map.
+  /// Returns the maximal residual of the iterative inversion [cm]
+
+  assert( isConstructed() );
+
+  const float tolerance = 1.e-4; // cm
+
+  float maxResidual = 0.f;
+
+  for( int slice=0; slice<NumberOfSlices; slice++){
+    for( int row=0; row<mNumberOfRows; row++ ){
+
+      const IrregularSpline2D3D& spline = getSpline( slice, row );
+      float *dataInv = getSplineDataInverseNonConst( slice, row );
+
+      for( int knot=0; knot<spline.getNumberOfKnots(); knot++ ){
+
+	// corrected u,v coordinates of the knot
+	float su=0, sv=0;
+	spline.getKnotUV( knot, su, sv );
+	float uc=0, vc=0;
+	convSUVtoUV( slice, row, su, sv, uc, vc );
+
+	// search for the nominal u,v:  (u,v) + distortion(u,v) == (uc,vc)
+	float u = uc, v = vc;
+	float dx=0, du=0, dv=0;
+	for( int iter=0; iter<maxIterations; iter++ ){
+	  getDistortion( slice, row, u, v, dx, du, dv );
+	  float un = uc - du;
+	  float vn = vc - dv;
+	  bool converged = ( fabs(un-u) < tolerance ) && ( fabs(vn-v) < tolerance );
+	  u = un;
+	  v = vn;
+	  if( converged ) break;
+	}
+	getDistortion( slice, row, u, v, dx, du, dv );
+	float residual = fmax( fabs( u + du - uc ), fabs( v + dv - vc ) );
+	if( residual > maxResidual ) maxResidual = residual;
+
+	dataInv[3*knot+0] = -dx;
+	dataInv[3*knot+1] = u - uc;
+	dataInv[3*knot+2] = v - vc;
+      } // knots
+
+      spline.correctEdges(dataInv);
+    } // row
+  } // slice
+  
+  return maxResidual;
+}
 
 
 }// namespace
@@ -121,6 +121,24 @@ class TPCDistortionIRS :public FlatObject
   /// Gives pointer to spline data  
   const float *getSplineData( int slice, int row ) const;
 
+  /// Gives pointer to the inverse spline data  
+  float *getSplineDataInverseNonConst( int slice, int row );
+
+  /// Gives pointer to the inverse spline data  
+  const float *getSplineDataInverse( int slice, int row ) const;
+
+  /// Calculates the inverse distortion map from the current distortion map
+  ///
+  /// Must be called after the distortion data have been set for all slices and rows.
+  /// For every knot (u',v') of the inverse map, the nominal position (u,v) with 
+  /// (u,v) + distortion(u,v) == (u',v') is found iteratively using the forward splines, 
+  /// and the difference (u,v) - (u',v') is stored as the inverse spline data.
+  /// The iteration is stopped when the change is below 1.e-4 cm or after maxIterations.
+  ///
+  /// \return maximal residual [cm] of the iterative inversion over all knots
+  ///
+  float initInverse( int maxIterations = 10 );
+
   
   /// Gives minimal alignment in bytes required for the class object
   static constexpr size_t getClassAlignmentBytes() {return 8;}
@@ -133,6 +151,14 @@ class TPCDistortionIRS :public FlatObject
   /// 
   int getDistortion( int slice, int row, float u, float v, float &dx, float &du, float &dv );
 
+  /// Inverse distortion: corrected (u,v) -> correction to the nominal (x,u,v)
+  ///
+  /// The inverse map uses the same spline scenarios as the forward map, so its accuracy 
+  /// at the knots is given by the tolerance of initInverse(), and between the knots 
+  /// it is limited by the spline approximation in the same way as the forward map.
+  ///
+  int getDistortionInverse( int slice, int row, float u, float v, float &dx, float &du, float &dv ) const;
+
 
   /// _______________  Utilities  _______________________________________________
  
@@ -192,6 +218,7 @@ class TPCDistortionIRS :public FlatObject
   long int mTimeStamp; ///< time stamp of the current calibration
 
   char * mSplineData; ///< pointer to the spline data in the flat buffer
+  char * mSplineDataInverse; ///< pointer to the inverse spline data in the flat buffer
   size_t mSliceDataSizeBytes;       ///< size of the data for one slice in the flat buffer
 
 };
@@ -230,6 +257,17 @@ inline int TPCDistortionIRS::getDistortion( int slice, int row, float u, float v
   return 0;
 }
 
+
+inline int TPCDistortionIRS::getDistortionInverse( int slice, int row, float u, float v, float &dx, float &du, float &dv ) const
+{
+  const IrregularSpline2D3D& spline = getSpline( slice, row );
+  const float *splineData = getSplineDataInverse( slice, row );
+  float su=0, sv=0;
+  convUVtoSUV( slice, row, u, v, su, sv );  
+  spline.getSplineVec( splineData, su, sv, dx, du, dv );
+  return 0;
+}
+
  
 
 }// namespace
@@ -0,0 +1,173 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+
+/// \file  TPCDistortionIRSBuilder.cxx
+/// \brief Implementation of TPCDistortionIRSBuilder class
+///
+/// \author  Sergey Gorbunov <sergey.gorbunov@cern.ch>
+
+
+#include "TPCDistortionIRSBuilder.h"
+#include "TPCDistortionIRS.h"
+#include "IrregularSplineKnotOptimizer.h"
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace ali_tpc_common {
+namespace tpc_fast_transformation {
+
+
+TPCDistortionIRSBuilder::TPCDistortionIRSBuilder()
+  :
+  mNumberOfThreads( 0 ),
+  mCalculateResiduals( true ),
+  mNumberOfRows( 0 ),
+  mResiduals()
+{
+}
+
+
+int TPCDistortionIRSBuilder::build( TPCDistortionIRS &distortion, const DistortionFunction &source )
+{
+  /// Fills the spline data of the constructed distortion object from the source
+
+  if( !distortion.isConstructed() ) return -1;
+  if( !source ) return -2;
+
+  int nSlices = distortion.getNumberOfSlices();
+  mNumberOfRows = distortion.getNumberOfRows();
+  int nRowsTotal = nSlices*mNumberOfRows;
+
+  RowResidual zero = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+  mResiduals.assign( nRowsTotal, zero );
+
+  int nThreads = 1;
+#ifdef _OPENMP
+  nThreads = ( mNumberOfThreads > 0 ) ?mNumberOfThreads :omp_get_max_threads();
+#endif
+
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic)
+  for( int i=0; i<nRowsTotal; i++ ){
+    int slice = i / mNumberOfRows;
+    int row = i % mNumberOfRows;
+    buildRow( distortion, source, slice, row );
+    if( mCalculateResiduals ) checkRow( distortion, source, slice, row );
+  }
+
+  distortion.initInverse();
+  return 0;
+}
+
+
+float TPCDistortionIRSBuilder::optimizeRowSplines( IrregularSplineKnotOptimizer &optimizer, const TPCDistortionIRS &distortion, const DistortionFunction &source, IrregularSpline2D3D rowSplines[] ) const
+{
+  /// Finds the knots of every TPC row: the spline of a row approximates the source in all slices.
+  /// The optimizer is not thread-safe, the rows are processed serially.
+
+  if( !distortion.isConstructed() || !source ) return -1.f;
+
+  int nSlices = distortion.getNumberOfSlices();
+  float maxError = 0.f;
+
+  for( int row=0; row<distortion.getNumberOfRows(); row++ ){
+    const IrregularSpline2D3D& spline = distortion.getSpline( 0, row );
+    auto rowSource = [&]( int slice, float su, float sv, float &dx, float &du, float &dv )
+    {
+      float u=0, v=0;
+      distortion.convSUVtoUV( slice, row, su, sv, u, v );
+      source( slice, row, u, v, dx, du, dv );
+    };
+    float err = optimizer.optimize( rowSplines[row], spline.getGridU().getNumberOfAxisBins(), spline.getGridV().getNumberOfAxisBins(), nSlices, rowSource );
+    if( err > maxError ) maxError = err;
+  }
+  return maxError;
+}
+
+
+void TPCDistortionIRSBuilder::buildRow( TPCDistortionIRS &distortion, const DistortionFunction &source, int slice, int row )
+{
+  /// Fills one TPC row: evaluates the source at the knots and corrects the edges
+
+  const IrregularSpline2D3D& spline = distortion.getSpline( slice, row );
+  float *data = distortion.getSplineDataNonConst( slice, row );
+
+  for( int knot=0; knot<spline.getNumberOfKnots(); knot++ ){
+    float su=0, sv=0;
+    spline.getKnotUV( knot, su, sv );
+    float u=0, v=0;
+    distortion.convSUVtoUV( slice, row, su, sv, u, v );
+    float dx=0, du=0, dv=0;
+    source( slice, row, u, v, dx, du, dv );
+    data[3*knot+0] = dx;
+    data[3*knot+1] = du;
+    data[3*knot+2] = dv;
+  }
+  spline.correctEdges( data );
+}
+
+
+void TPCDistortionIRSBuilder::checkRow( TPCDistortionIRS &distortion, const DistortionFunction &source, int slice, int row )
+{
+  /// Calculates approximation residuals for one TPC row at the middle points between the knots
+
+  const IrregularSpline2D3D& spline = distortion.getSpline( slice, row );
+  const IrregularSpline1D &gridU = spline.getGridU();
+  const IrregularSpline1D &gridV = spline.getGridV();
+
+  RowResidual &res = mResiduals[ slice*mNumberOfRows + row ];
+  double sumDx=0, sumDu=0, sumDv=0;
+  int n=0;
+
+  for( int iu=0; iu<gridU.getNumberOfKnots()-1; iu++ ){
+    float su = 0.5*( gridU.getKnot(iu).u + gridU.getKnot(iu+1).u );
+    for( int iv=0; iv<gridV.getNumberOfKnots()-1; iv++ ){
+      float sv = 0.5*( gridV.getKnot(iv).u + gridV.getKnot(iv+1).u );
+      float u=0, v=0;
+      distortion.convSUVtoUV( slice, row, su, sv, u, v );
+      float dx=0, du=0, dv=0;
+      source( slice, row, u, v, dx, du, dv );
+      float sx=0, sU=0, sV=0;
+      distortion.getDistortion( slice, row, u, v, sx, sU, sV );
+      float ex = fabs( sx - dx );
+      float eu = fabs( sU - du );
+      float ev = fabs( sV - dv );
+      if( ex > res.maxDx ) res.maxDx = ex;
+      if( eu > res.maxDu ) res.maxDu = eu;
+      if( ev > res.maxDv ) res.maxDv = ev;
+      sumDx += ex*ex;
+      sumDu += eu*eu;
+      sumDv += ev*ev;
+      n++;
+    }
+  }
+  if( n>0 ){
+    res.rmsDx = sqrt( sumDx/n );
+    res.rmsDu = sqrt( sumDu/n );
+    res.rmsDv = sqrt( sumDv/n );
+  }
+}
+
+
+float TPCDistortionIRSBuilder::getMaxResidual() const
+{
+  /// Gives maximal residual of the spline approximation over all TPC rows [cm]
+  float m = 0.f;
+  for( size_t i=0; i<mResiduals.size(); i++ ){
+    const RowResidual &r = mResiduals[i];
+    m = fmax( m, fmax( r.maxDx, fmax( r.maxDu, r.maxDv ) ) );
+  }
+  return m;
+}
+
+}} // namespaces
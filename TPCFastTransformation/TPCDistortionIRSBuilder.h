@@ -0,0 +1,134 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file  TPCDistortionIRSBuilder.h
+/// \brief Definition of TPCDistortionIRSBuilder class
+///
+/// \author  Sergey Gorbunov <sergey.gorbunov@cern.ch>
+
+
+#ifndef ALICE_ALITPCOMMON_TPCFASTTRANSFORMATION_TPCDISTORTIONIRSBUILDER_H
+#define ALICE_ALITPCOMMON_TPCFASTTRANSFORMATION_TPCDISTORTIONIRSBUILDER_H
+
+#include "AliTPCCommonDef.h"
+#include <functional>
+#include <vector>
+
+namespace ali_tpc_common {
+namespace tpc_fast_transformation {
+
+class TPCDistortionIRS;
+class IrregularSpline2D3D;
+class IrregularSplineKnotOptimizer;
+
+///
+/// The TPCDistortionIRSBuilder class fills the spline data of a constructed TPCDistortionIRS object
+/// from an arbitrary distortion source.
+///
+/// The source is any callable object with the signature
+///
+///   void f( int slice, int row, float u, float v, float &dx, float &du, float &dv )
+///
+/// which gives the distortion (dx,du,dv) of the nominal drift volume coordinates (u,v) at the given TPC row.
+///
+/// The spline data of all the rows are filled in parallel (OpenMP),
+/// therefore the source must be thread-safe when more than one thread is used.
+/// After filling, the edges of the spline data are corrected and the inverse map is recalculated.
+///
+/// Optionally, the quality of the spline approximation is checked at the middle points between the knots,
+/// the maximal and the RMS deviations from the source are stored per row.
+///
+/// Instead of a fixed knot layout, the knots of every row can be adapted to the source with optimizeRowSplines().
+/// The layouts are then used as one approximation scenario per row for a new distortion object.
+///
+///  Example:
+///
+///  TPCDistortionIRSBuilder builder;
+///  builder.build( distortion,
+///     []( int slice, int row, float u, float v, float &dx, float &du, float &dv ){ dx = 0.; du = 0.1*v; dv = 0.; } );
+///  float maxDev = builder.getMaxResidual();
+///
+class TPCDistortionIRSBuilder
+{
+ public:
+
+  /// Distortion source: (slice, row, u, v) -> (dx, du, dv)
+  typedef std::function< void ( int slice, int row, float u, float v, float &dx, float &du, float &dv ) > DistortionFunction;
+
+  ///
+  /// \brief Quality of the spline approximation for one TPC row
+  ///
+  struct RowResidual
+  {
+    float maxDx; ///< maximal deviation of dx [cm]
+    float maxDu; ///< maximal deviation of du [cm]
+    float maxDv; ///< maximal deviation of dv [cm]
+    float rmsDx; ///< RMS deviation of dx [cm]
+    float rmsDu; ///< RMS deviation of du [cm]
+    float rmsDv; ///< RMS deviation of dv [cm]
+  };
+
+  /// _____________  Constructors / destructors __________________________
+
+  /// Default constructor
+  TPCDistortionIRSBuilder();
+
+  /// Copy constructor: disabled
+  TPCDistortionIRSBuilder(const TPCDistortionIRSBuilder& ) CON_DELETE;
+
+  /// Assignment operator: disabled
+  TPCDistortionIRSBuilder &operator=(const TPCDistortionIRSBuilder &) CON_DELETE;
+
+  /// Destructor
+  ~TPCDistortionIRSBuilder() CON_DEFAULT;
+
+  /// _______________  Settings  ________________________
+
+  /// Sets number of threads. 0 means the OpenMP default. Use 1 for a non-thread-safe source.
+  void setNumberOfThreads( int n ) { mNumberOfThreads = n; }
+
+  /// Switches the calculation of the approximation residuals on/off
+  void setCalculateResiduals( bool v ) { mCalculateResiduals = v; }
+
+  /// _______________  Main functionality  ________________________
+
+  /// Fills the spline data of the constructed distortion object from the source
+  int build( TPCDistortionIRS &distortion, const DistortionFunction &source );
+
+  /// Finds the knots of every TPC row with the optimizer: the spline of a row approximates the source in all slices.
+  /// The constructed distortion object gives the row geometry and the number of axis bins.
+  /// rowSplines must have getNumberOfRows() elements. Returns the maximal deviation at the sample points over all rows.
+  float optimizeRowSplines( IrregularSplineKnotOptimizer &optimizer, const TPCDistortionIRS &distortion, const DistortionFunction &source, IrregularSpline2D3D rowSplines[] ) const;
+
+  /// _______________  Utilities   ________________________
+
+  /// Gives residuals of the spline approximation for a TPC row. Only available when setCalculateResiduals(true)
+  const RowResidual& getRowResidual( int slice, int row ) const { return mResiduals[ slice*mNumberOfRows + row ]; }
+
+  /// Gives maximal residual of the spline approximation over all TPC rows [cm]
+  float getMaxResidual() const;
+
+ private:
+
+  /// Fills one TPC row
+  void buildRow( TPCDistortionIRS &distortion, const DistortionFunction &source, int slice, int row );
+
+  /// Calculates approximation residuals for one TPC row
+  void checkRow( TPCDistortionIRS &distortion, const DistortionFunction &source, int slice, int row );
+
+  int mNumberOfThreads; ///< number of threads, 0 == OpenMP default
+  bool mCalculateResiduals; ///< calculate the approximation residuals
+  int mNumberOfRows;  ///< number of TPC rows in the last build
+  std::vector<RowResidual> mResiduals; ///< residuals for each slice and row
+};
+
+}} // namespaces
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+
+/// \file  TPCFastSpaceChargeExporter.cxx
+/// \brief Implementation of TPCFastSpaceChargeExporter class
+///
+/// \author  Sergey Gorbunov <sergey.gorbunov@cern.ch>
+
+
+#include "TPCFastSpaceChargeExporter.h"
+#include "TPCFastTransform.h"
+#include "TPCDistortionIRSBuilder.h"
+#include "AliTPCSpaceCharge3DCalc.h"
+
+namespace ali_tpc_common {
+namespace tpc_fast_transformation {
+
+
+TPCFastSpaceChargeExporter::TPCFastSpaceChargeExporter()
+  :
+  mError(),
+  mNumberOfThreads( 1 ),
+  mMaxResidual( 0.f )
+{
+}
+
+
+int TPCFastSpaceChargeExporter::exportCorrection( TPCFastTransform &fastTransform, AliTPCSpaceCharge3DCalc &spaceCharge )
+{
+  /// Fills the distortion map of the fast transformation with the space-charge correction
+
+  mMaxResidual = 0.f;
+
+  if( !fastTransform.isConstructed() ) return storeError( -1, "TPCFastSpaceChargeExporter::exportCorrection: TPCFastTransform is not constructed");
+
+  TPCDistortionIRS& distortion = fastTransform.getDistortionNonConst();
+
+  auto spaceChargeCorrection = [&]( int slice, int row, float u, float v, float &dx, float &du, float &dv )
+  {
+    // nominal local x,y,z coordinates of the knot
+    float x = fastTransform.getRowInfo( row ).x;
+    float y=0, z=0;
+    fastTransform.convUVtoYZ( slice, row, x, u, v, y, z );
+    
+    // rotate to the global coordinate system
+    const TPCFastTransform::SliceInfo &sliceInfo = fastTransform.getSliceInfo( slice );
+    float gx = x*sliceInfo.cosAlpha - y*sliceInfo.sinAlpha;
+    float gy = x*sliceInfo.sinAlpha + y*sliceInfo.cosAlpha;
+    
+    Float_t pos[3] = { gx, gy, z };
+    Float_t corr[3] = { 0.f, 0.f, 0.f };
+    spaceCharge.GetCorrection( pos, slice, corr );
+
+    // rotate the correction back to the local coordinate system, convert to u,v
+    float cx =  corr[0]*sliceInfo.cosAlpha + corr[1]*sliceInfo.sinAlpha;
+    float cy = -corr[0]*sliceInfo.sinAlpha + corr[1]*sliceInfo.cosAlpha;
+    float cu=0, cv=0, u0=0, v0=0;
+    fastTransform.convYZtoUV( slice, row, x, y, z, u0, v0 );
+    fastTransform.convYZtoUV( slice, row, x + cx, y + cy, z + corr[2], cu, cv );
+    dx = cx;
+    du = cu - u0;
+    dv = cv - v0;
+  };
+
+  TPCDistortionIRSBuilder builder;
+  builder.setNumberOfThreads( mNumberOfThreads );
+  builder.setCalculateResiduals( true );
+  int err = builder.build( distortion, spaceChargeCorrection );
+  if( err ) return storeError( -2, "TPCFastSpaceChargeExporter::exportCorrection: Can not build the distortion map");
+
+  mMaxResidual = builder.getMaxResidual();
+  return 0;
+}
+
+}} // namespaces
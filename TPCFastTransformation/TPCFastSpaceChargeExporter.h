@@ -0,0 +1,95 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file  TPCFastSpaceChargeExporter.h
+/// \brief Definition of TPCFastSpaceChargeExporter class
+///
+/// \author  Sergey Gorbunov <sergey.gorbunov@cern.ch>
+
+
+#ifndef ALICE_ALITPCOMMON_TPCFASTTRANSFORMATION_TPCFASTSPACECHARGEEXPORTER_H
+#define ALICE_ALITPCOMMON_TPCFASTTRANSFORMATION_TPCFASTSPACECHARGEEXPORTER_H
+
+#include "AliTPCCommonDef.h"
+#include "Rtypes.h"
+#include "TString.h"
+
+class AliTPCSpaceCharge3DCalc;
+
+namespace ali_tpc_common {
+namespace tpc_fast_transformation {
+class TPCFastTransform;
+
+///
+/// The TPCFastSpaceChargeExporter class fills the TPCDistortionIRS spline map of a TPCFastTransform object
+/// with the space-charge correction calculated by AliTPCSpaceCharge3DCalc.
+///
+/// The space-charge correction is sampled at the spline knots of each TPC row.
+/// The knot (u,v) coordinates are converted to the global (x,y,z) coordinates of the nominal cluster position,
+/// the correction is taken from AliTPCSpaceCharge3DCalc::GetCorrection() and converted back to (dx,du,dv).
+/// After that the map can be evaluated at the spline speed, without the 3D look-up tables.
+///
+/// The TPCFastTransform object must be constructed beforehand (geometry, drift calibration and the spline scenarios),
+/// i.e. by TPCFastTransformManager or manually. The existing content of the distortion map is replaced.
+///
+class TPCFastSpaceChargeExporter
+{
+ public:
+  /// _____________  Constructors / destructors __________________________
+ 
+  /// Default constructor
+  TPCFastSpaceChargeExporter();
+
+  /// Copy constructor: disabled
+  TPCFastSpaceChargeExporter(const TPCFastSpaceChargeExporter& ) CON_DELETE;
+ 
+  /// Assignment operator: disabled 
+  TPCFastSpaceChargeExporter &operator=(const TPCFastSpaceChargeExporter &) CON_DELETE;
+     
+  /// Destructor
+  ~TPCFastSpaceChargeExporter() CON_DEFAULT;
+
+  /// _______________  Settings  ________________________
+
+  /// Sets number of threads for sampling the space-charge map. Only use >1 when the look-up tables are already initialised.
+  void setNumberOfThreads( int n ) { mNumberOfThreads = n; }
+
+  /// _______________  Main functionality  ________________________
+
+  /// Fills the distortion map of the fast transformation with the space-charge correction
+  int exportCorrection( TPCFastTransform &fastTransform, AliTPCSpaceCharge3DCalc &spaceCharge );
+  
+  /// _______________  Utilities   ________________________
+
+  /// Gives maximal deviation of the spline map from the space-charge correction in the middle between the knots [cm]
+  float getMaxResidual() const { return mMaxResidual; }
+
+  ///  Gives error string
+  const char* getLastError() const { return mError.Data(); }
+
+ private:
+
+  /// Stores an error message
+  int storeError(Int_t code, const char *msg);
+
+  TString mError; ///< error string
+  int mNumberOfThreads; ///< number of threads
+  float mMaxResidual; ///< max. deviation of the spline approximation after the last export
+};
+
+inline int TPCFastSpaceChargeExporter::storeError(int code, const char *msg)
+{
+  mError = msg;
+  return code;
+}
+
+}} // namespaces
+
+#endif
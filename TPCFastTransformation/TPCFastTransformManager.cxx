@@ -22,6 +22,9 @@
 #include "AliTPCcalibDB.h"
 #include "AliHLTTPCGeometry.h"
 #include "TPCFastTransform.h"
+#include "TPCDistortionIRSBuilder.h"
+#include "IrregularSplineKnotOptimizer.h"
+#include <memory>
 
 namespace ali_tpc_common {
 namespace tpc_fast_transformation {
@@ -30,7 +33,9 @@ namespace tpc_fast_transformation {
 TPCFastTransformManager::TPCFastTransformManager()
   :
   mError(),
-  mOrigTransform(nullptr)
+  mOrigTransform(nullptr),
+  mOptimizeKnots(false),
+  mMaxDistortionError(0.01)
 {
 }
 
@@ -65,11 +70,52 @@ int  TPCFastTransformManager::create( TPCFastTransform &fastTransform, AliTPCTra
   
   fLastTimeBin = rec->GetLastBin();  
   
+  constructTransform( fastTransform, tpcParam, nullptr );
+
+  int err = updateCalibration( fastTransform, TimeStamp );
+  if( err || !mOptimizeKnots || TimeStamp<0 ) return err;
+
+  // adapt the knots of every row to the current distortions, at most as many knots as in the fixed layout
+
+  const IrregularSpline2D3D &fixedSpline = fastTransform.getDistortionNonConst().getSpline( 0, 0 );
+  int nKnotsU = fixedSpline.getGridU().getNumberOfKnots();
+  int nKnotsV = fixedSpline.getGridV().getNumberOfKnots();
+
+  IrregularSplineKnotOptimizer optimizer;
+  optimizer.setMaxError( mMaxDistortionError );
+  optimizer.setNumberOfSamples( 2*nKnotsU, 2*nKnotsV );
+  optimizer.setMaxNumberOfKnots( nKnotsU, nKnotsV );
+
+  AliTPCRecoParam *recoParam = mOrigTransform->GetCurrentRecoParamNonConst();
+  bool useTOFcorrection = recoParam->GetUseTOFCorrection();
+  recoParam->SetUseTOFCorrection( kFALSE );
+
+  std::unique_ptr<IrregularSpline2D3D[]> rowSplines( new IrregularSpline2D3D[ fastTransform.getNumberOfRows() ] );
+  TPCDistortionIRSBuilder builder;
+  float maxError = builder.optimizeRowSplines( optimizer, fastTransform.getDistortionNonConst(),
+    [&]( int slice, int row, float u, float v, float &dx, float &du, float &dv ){ getOriginalDistortion( fastTransform, slice, row, u, v, dx, du, dv ); },
+    rowSplines.get() );
+
+  recoParam->SetUseTOFCorrection( useTOFcorrection );
+
+  if( maxError<0 ) return storeError( -6, "TPCFastTransformManager::Init: Can not optimise the knots of the distortion map");
+
+  constructTransform( fastTransform, tpcParam, rowSplines.get() );
+
+  return updateCalibration( fastTransform, TimeStamp );
+}
+
+
+void TPCFastTransformManager::constructTransform( TPCFastTransform &fastTransform, AliTPCParam *tpcParam, const IrregularSpline2D3D *rowSplines )
+{
+  /// Constructs the transformation with the fixed knot layout (rowSplines==nullptr) or with one knot layout per row
+
   fastTransform.startConstruction( tpcParam->GetNRowLow()+ tpcParam->GetNRowUp() );
 
   TPCDistortionIRS& distortion = fastTransform.getDistortionNonConst();
   
-  distortion.startConstruction( tpcParam->GetNRowLow()+ tpcParam->GetNRowUp(), 1 );
+  int nRows = tpcParam->GetNRowLow()+ tpcParam->GetNRowUp();
+  distortion.startConstruction( nRows, rowSplines ?nRows :1 );
   
   float tpcZlengthSideA = tpcParam->GetZLength(0);
   float tpcZlengthSideC = tpcParam->GetZLength(TPCFastTransform::getNumberOfSlices()/2);
@@ -85,13 +131,13 @@ int  TPCFastTransformManager::create( TPCFastTransform &fastTransform, AliTPCTra
     float padWidth = tpcParam->GetInnerPadPitchWidth();
     if( iRow >= tpcParam->GetNRowLow() ) padWidth = tpcParam->GetOuterPadPitchWidth();
     fastTransform.setTPCrow( iRow, xRow, nPads, padWidth );
-    distortion.setTPCrow( iRow, xRow, nPads, padWidth, 0 );
+    distortion.setTPCrow( iRow, xRow, nPads, padWidth, rowSplines ?iRow :0 );
   }
 
   fastTransform.setCalibration( -1, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f );
 
   IrregularSpline2D3D spline;
-  {
+  if( !rowSplines ){
     int nKnotsU = 15;
     int nAxisTicksU = tpcParam->GetNPads(0, 10);    
     int nKnotsV = 20;
@@ -121,11 +167,13 @@ int  TPCFastTransformManager::create( TPCFastTransform &fastTransform, AliTPCTra
     spline.construct( nKnotsU, knotsU, nAxisTicksU,
 		      nKnotsV, knotsV, nAxisTicksV );
   }
-  distortion.setApproximationScenario( 0, spline );  
+  if( rowSplines ){
+    for( int iRow=0; iRow<nRows; iRow++ ) distortion.setApproximationScenario( iRow, rowSplines[iRow] );
+  } else {
+    distortion.setApproximationScenario( 0, spline );
+  }
   distortion.finishConstruction();
   fastTransform.finishConstruction();
-
-  return updateCalibration( fastTransform, TimeStamp );
 }
 
 
@@ -222,78 +270,62 @@ int TPCFastTransformManager::updateCalibration( TPCFastTransform &fastTransform,
   // switch TOF correction off for a while
 
   recoParam->SetUseTOFCorrection( kFALSE );
- 
-  for( int slice=0; slice<distortion.getNumberOfSlices(); slice++){      
-  
-    for( int row=0; row<distortion.getNumberOfRows(); row++ ){
-
-      const TPCFastTransform::RowInfo &rowInfo = fastTransform.getRowInfo( row );
-    
-      const IrregularSpline2D3D& spline = distortion.getSpline( slice, row );
 
-      float *data = distortion.getSplineDataNonConst(slice,row);
-
-      for( int knot=0; knot<spline.getNumberOfKnots(); knot++ ){
+  auto origDistortion = [&]( int slice, int row, float u, float v, float &dx, float &du, float &dv )
+  {
+    getOriginalDistortion( fastTransform, slice, row, u, v, dx, du, dv );
+  };
 
-	data[3*knot+0] = 0.f;
-	data[3*knot+1] = 0.f;
-	data[3*knot+2] = 0.f;
-	
-	// x cordinate of the knot
-	float x = rowInfo.x;
+  // AliTPCTransform is not thread-safe, fill the spline data serially
 
-	// spline (su,sv) cordinates of the knot (su,sv) in (0,1)x(0,1)
-	float su=0, sv=0;
-	spline.getKnotUV( knot, su, sv );
-	
-	// x, u, v cordinates of the knot (local cartesian coord. of slice towards central electrode )
-	float u=0, v=0;
-	distortion.convSUVtoUV( slice, row, su, sv, u, v );
+  TPCDistortionIRSBuilder builder;
+  builder.setNumberOfThreads( 1 );
+  builder.setCalculateResiduals( false );
+  int err = builder.build( distortion, origDistortion );
 
-	// row, pad, time coordinates of the knot 
-	float pad=0, time=0;
-	fastTransform.convUVtoPadTime( slice, row, u, v, pad, time );
-	
-	// nominal x,y,z coordinates of the knot (without distortions and time-of-flight correction)
-	float y=0, z=0;
-	fastTransform.convUVtoYZ( slice, row, x, u, v, y, z );
-	
-	// original TPC transformation (row,pad,time) -> (x,y,z) without time-of-flight correction
-	float ox=0, oy=0, oz=0;	
-	{
-	  int sector=0, secrow=0;
-	  AliHLTTPCGeometry::Slice2Sector( slice, row, sector, secrow );
-	  int is[]={sector};
-	  double xx[]={ static_cast<double>(secrow), pad, time };
-	  mOrigTransform->Transform(xx, is, 0, 1);
-	  ox = xx[0];
-	  oy = xx[1];
-	  oz = xx[2];
-	}
-	// convert to u,v
-	float ou=0, ov=0;
-	fastTransform.convYZtoUV( slice, row, ox, oy, oz, ou, ov );
-
-	// distortions in x,u,v:
-	float dx = ox-x;
-	float du = ou-u;
-	float dv = ov-v;
-	data[3*knot+0] = dx;
-	data[3*knot+1] = du;
-	data[3*knot+2] = dv;	
-      } // knots
-      
-      spline.correctEdges(data);
-    } // row
-  } // slice
-  
-  
   // set back the time-of-flight correction;
   
   recoParam->SetUseTOFCorrection( useTOFcorrection );
+
+  if( err ) return storeError( -6, "TPCFastTransformManager::SetCurrentTimeStamp: Can not build the distortion map");
   
   return 0;
 }
- 
+
+
+void TPCFastTransformManager::getOriginalDistortion( TPCFastTransform &fastTransform, int slice, int row, float u, float v, float &dx, float &du, float &dv )
+{
+  /// Gives the distortion of the original transformation at the nominal (u,v) coordinates of the fast transformation,
+  /// the time-of-flight correction of the original transformation has to be switched off by the caller
+
+  // x cordinate of the knot
+  float x = fastTransform.getRowInfo( row ).x;
+
+  // row, pad, time coordinates of the knot 
+  float pad=0, time=0;
+  fastTransform.convUVtoPadTime( slice, row, u, v, pad, time );
+	
+  // original TPC transformation (row,pad,time) -> (x,y,z) without time-of-flight correction
+  float ox=0, oy=0, oz=0;	
+  {
+    int sector=0, secrow=0;
+    AliHLTTPCGeometry::Slice2Sector( slice, row, sector, secrow );
+    int is[]={sector};
+    double xx[]={ static_cast<double>(secrow), pad, time };
+    mOrigTransform->Transform(xx, is, 0, 1);
+    ox = xx[0];
+    oy = xx[1];
+    oz = xx[2];
+  }
+  // convert to u,v
+  float ou=0, ov=0;
+  fastTransform.convYZtoUV( slice, row, ox, oy, oz, ou, ov );
+
+  // distortions in x,u,v:
+  dx = ox-x;
+  du = ou-u;
+  dv = ov-v;
+}
+
 
 }} // namespaces
@@ -24,9 +24,12 @@
 #include "TString.h"
 #include "AliTPCTransform.h"
 
+class AliTPCParam;
+
 namespace ali_tpc_common {
 namespace tpc_fast_transformation {
 class TPCFastTransform;
+class IrregularSpline2D3D;
 
 ///
 /// The TPCFastTransformManager class is to initialize TPCFastTransformation object
@@ -49,6 +52,13 @@ class TPCFastTransformManager
   /// Destructor
   ~TPCFastTransformManager() CON_DEFAULT;
 
+  /// _______________  Settings  ________________________
+
+  /// Switches on the adaptive knot layout of the distortion map: the knots of every row are optimised
+  /// with IrregularSplineKnotOptimizer to reach the target maximal error [cm], smooth rows get less knots.
+  /// The layout is found in create() for its time stamp, it is slower than the default fixed layout.
+  void setKnotOptimization( bool v, float maxError = 0.01 ) { mOptimizeKnots = v; mMaxDistortionError = maxError; }
+
   /// _______________  Main functionality  ________________________
 
   /// Initializes TPCFastTransform object
@@ -69,9 +79,17 @@ class TPCFastTransformManager
   /// Stores an error message
   int storeError(Int_t code, const char *msg);
 
+  /// Constructs the transformation with the fixed knot layout (rowSplines==nullptr) or with one knot layout per row
+  void constructTransform( TPCFastTransform &fastTransform, AliTPCParam *tpcParam, const IrregularSpline2D3D *rowSplines );
+
+  /// Gives the distortion of the original transformation at the nominal (u,v) coordinates of the fast transformation
+  void getOriginalDistortion( TPCFastTransform &fastTransform, int slice, int row, float u, float v, float &dx, float &du, float &dv );
+
   TString mError; ///< error string
   AliTPCTransform* mOrigTransform;    ///< transient
   int fLastTimeBin;                 ///< last calibrated time bin
+  bool mOptimizeKnots;              ///< optimise the knots of every row
+  float mMaxDistortionError;        ///< target maximal error of the distortion map with optimised knots [cm]
 };
 
 inline int TPCFastTransformManager::storeError(int code, const char *msg)
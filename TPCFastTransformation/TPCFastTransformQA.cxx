@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 namespace ali_tpc_common {
 namespace tpc_fast_transformation {
@@ -37,6 +38,28 @@ namespace tpc_fast_transformation {
 using namespace std;
 
 
+static int inverseTransformIterative( TPCFastTransform &fastTransform, int slice, int row, float y, float z, float &pad, float &time, int nIterations )
+{
+  // reference inversion of the fast transformation: iterate the forward transformation
+
+  float x = fastTransform.getRowInfo( row ).x;
+  float u0=0, v0=0;
+  int err = fastTransform.convYZtoUV( slice, row, x, y, z, u0, v0 );
+  if( err ) return err;
+  float u = u0, v = v0;
+  for( int iter=0; iter<nIterations; iter++ ){
+    fastTransform.convUVtoPadTime( slice, row, u, v, pad, time );
+    float fx=0, fy=0, fz=0;
+    fastTransform.Transform( slice, row, pad, time, fx, fy, fz );
+    float fu=0, fv=0;
+    fastTransform.convYZtoUV( slice, row, fx, fy, fz, fu, fv );
+    u += u0 - fu;
+    v += v0 - fv;
+  }
+  return fastTransform.convUVtoPadTime( slice, row, u, v, pad, time );
+}
+
+
 TPCFastTransformQA::TPCFastTransformQA()
 {
 }
@@ -129,6 +152,66 @@ int TPCFastTransformQA::doQA( Long_t TimeStamp )
     cout<<"ignore this "<<sum1<<" "<<sum2<<endl;
   }
 
+  // measure execution time and accuracy of the inverse transformation
+  {
+    const int nIterations = 5;
+
+    struct Point { int slice, row; float pad, time, y, z; };
+    std::vector<Point> points;
+
+    for( Int_t iSec=0; iSec<1; iSec++ ){
+      int nRows = tpcParam->GetNRow(iSec);
+      for( int iRow=0; iRow<nRows; iRow++){	
+	Int_t nPads = tpcParam->GetNPads(iSec,iRow);     
+	int slice=0, slicerow=0;
+	AliHLTTPCGeometry::Sector2Slice( slice, slicerow, iSec, iRow);
+	for( float pad=0.5; pad<nPads; pad+=1.){
+	  for( float time =0; time < lastTimeBin; time+=10 ){
+	    Point p = { slice, slicerow, pad, time, 0.f, 0.f };
+	    float x=0;
+	    fastTransform.Transform( slice, slicerow, pad, time, x, p.y, p.z );
+	    points.push_back( p );
+	  }
+	}
+      }
+    }
+    
+    double nCalls = points.size();
+    std::vector<float> padInv( points.size() ), timeInv( points.size() ), padIter( points.size() ), timeIter( points.size() );
+
+    cout<<"Measure inverse transformation time for TPC sector 0 .."<<endl;
+    TStopwatch timer1;
+    for( size_t i=0; i<points.size(); i++ ){
+      const Point &p = points[i];
+      fastTransform.InverseTransform( p.slice, p.row, p.y, p.z, padInv[i], timeInv[i] );
+    }
+    timer1.Stop();
+
+    cout<<"Measure iterative inverse transformation time for TPC sector 0 .."<<endl;
+    TStopwatch timer2;
+    for( size_t i=0; i<points.size(); i++ ){
+      const Point &p = points[i];
+      inverseTransformIterative( fastTransform, p.slice, p.row, p.y, p.z, padIter[i], timeIter[i], nIterations );
+    }
+    timer2.Stop();
+
+    double maxDevPadInv=0, maxDevTimeInv=0, maxDevPadIter=0, maxDevTimeIter=0;
+    for( size_t i=0; i<points.size(); i++ ){
+      const Point &p = points[i];
+      maxDevPadInv = TMath::Max( maxDevPadInv, (double) fabs(padInv[i] - p.pad) );
+      maxDevTimeInv = TMath::Max( maxDevTimeInv, (double) fabs(timeInv[i] - p.time) );
+      maxDevPadIter = TMath::Max( maxDevPadIter, (double) fabs(padIter[i] - p.pad) );
+      maxDevTimeIter = TMath::Max( maxDevTimeIter, (double) fabs(timeIter[i] - p.time) );
+    }
+
+    cout<<"nCalls = "<<nCalls<<endl;
+    cout<<"Inverse transformation, spline map   : "<< timer1.RealTime()*1.e9/nCalls<<" ns / call, max deviation: "
+	<<maxDevPadInv<<" pads, "<<maxDevTimeInv<<" time bins"<<endl;
+    cout<<"Inverse transformation, "<<nIterations<<" iterations: "<< timer2.RealTime()*1.e9/nCalls<<" ns / call, max deviation: "
+	<<maxDevPadIter<<" pads, "<<maxDevTimeIter<<" time bins"<<endl;
+    cout<<"Inverse transformation speedup: "<< timer2.RealTime()/timer1.RealTime()<<endl;
+  }
+
 
   if(1){ 
     TFile *file = new TFile(fileName,"RECREATE");
@@ -0,0 +1,165 @@
+#define BOOST_TEST_MODULE Test TPC Fast Transformation
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <memory>
+#include "TPCFastTransform.h"
+#include "TPCDistortionIRSBuilder.h"
+#include "IrregularSplineKnotOptimizer.h"
+
+using namespace ali_tpc_common::tpc_fast_transformation;
+
+/// @brief Fill the distortion map from an analytic distortion and check the approximation and the inverse transformation
+BOOST_AUTO_TEST_CASE(TPCDistortionIRSBuilder_test1)
+{
+  const int nRows = 10;
+
+  TPCFastTransform transform;
+  transform.startConstruction( nRows );
+  TPCDistortionIRS& distortion = transform.getDistortionNonConst();
+  distortion.startConstruction( nRows, 1 );
+  transform.setTPCgeometry( 250., 250. );
+  distortion.setTPCgeometry( 250., 250. );
+  for( int iRow=0; iRow<nRows; iRow++ ){
+    transform.setTPCrow( iRow, 85.+iRow, 60+iRow, 0.4 );
+    distortion.setTPCrow( iRow, 85.+iRow, 60+iRow, 0.4, 0 );
+  }
+  transform.setCalibration( 0, 0.f, 2.5f, 0.f, 0.f, 0.f, 0.f, 0.f );
+
+  IrregularSpline2D3D spline;
+  const int nKnotsU = 10, nKnotsV = 20;
+  float knotsU[nKnotsU], knotsV[nKnotsV];
+  for( int i=0; i<nKnotsU; i++ ) knotsU[i] = 1./(nKnotsU-1)*i;
+  for( int i=0; i<nKnotsV; i++ ) knotsV[i] = 1./(nKnotsV-1)*i;
+  spline.construct( nKnotsU, knotsU, 60, nKnotsV, knotsV, 100 );
+  distortion.setApproximationScenario( 0, spline );
+  distortion.finishConstruction();
+  transform.finishConstruction();
+
+  TPCDistortionIRSBuilder builder;
+  int err = builder.build( transform.getDistortionNonConst(),
+    []( int slice, int row, float u, float v, float &dx, float &du, float &dv ){
+      dx = 0.1*sin(u/10.);
+      du = 0.5*sin(v/40.) + 0.005*u;
+      dv = 0.3*cos(u/8.) + 0.002*v;
+    } );
+  BOOST_CHECK_EQUAL( err, 0 );
+  BOOST_CHECK( builder.getMaxResidual() < 0.01 );
+
+  for( int slice=0; slice<TPCFastTransform::getNumberOfSlices(); slice+=5 ){
+    for( int row=0; row<nRows; row++ ){
+      for( float pad=2.f; pad<55.f; pad+=5.f ){
+        for( float time=5.f; time<90.f; time+=10.f ){
+          float x=0, y=0, z=0, pad1=0, time1=0;
+          transform.Transform( slice, row, pad, time, x, y, z );
+          transform.InverseTransform( slice, row, y, z, pad1, time1 );
+          BOOST_CHECK_SMALL( pad1 - pad, 0.01f );
+          BOOST_CHECK_SMALL( time1 - time, 0.01f );
+        }
+      }
+    }
+  }
+}
+
+/// @brief Optimise knots for a function which is smooth in u and steep in v, check the target accuracy
+BOOST_AUTO_TEST_CASE(IrregularSplineKnotOptimizer_test1)
+{
+  IrregularSplineKnotOptimizer optimizer;
+  optimizer.setMaxError( 0.001 );
+  optimizer.setNumberOfSamples( 50, 200 );
+
+  IrregularSpline2D3D spline;
+  auto f = []( float u, float v, float &fx, float &fy, float &fz ){
+    fx = 0.1*u;
+    fy = 0.2*u*u;
+    fz = 0.1*exp( -20.*v );
+  };
+  float err = optimizer.optimize( spline, 100, 1000, f );
+  BOOST_CHECK( err <= 0.001 );
+  BOOST_CHECK( spline.getGridU().getNumberOfKnots() < spline.getGridV().getNumberOfKnots() );
+
+  IrregularSpline1D spline1D;
+  float err1D = optimizer.optimize( spline1D, 1000, []( float u ){ return (float) sin( 10.*u ); } );
+  BOOST_CHECK( err1D <= 0.001 );
+}
+
+/// @brief Adapt the knots of every row to the distortion as TPCFastTransformManager does, check the map against the target max error
+BOOST_AUTO_TEST_CASE(TPCDistortionIRSBuilder_optimizedKnots)
+{
+  const int nRows = 10;
+  const int nAxisBinsU = 60, nAxisBinsV = 100;
+  const float maxError = 0.005;
+
+  // smooth in the inner rows, steep near the readout in the outer rows
+  TPCDistortionIRSBuilder::DistortionFunction source = []( int slice, int row, float u, float v, float &dx, float &du, float &dv ){
+    dx = 0.01*row*sin(u/10.);
+    du = 0.002*u + ( row<5 ?0.001*v :0.5*exp(-v/20.) );
+    dv = 0.1*cos(u/20.) + 0.001*slice;
+  };
+
+  auto construct = [&]( TPCFastTransform &transform, const IrregularSpline2D3D *rowSplines ){
+    transform.startConstruction( nRows );
+    TPCDistortionIRS& distortion = transform.getDistortionNonConst();
+    distortion.startConstruction( nRows, rowSplines ?nRows :1 );
+    transform.setTPCgeometry( 250., 250. );
+    distortion.setTPCgeometry( 250., 250. );
+    for( int iRow=0; iRow<nRows; iRow++ ){
+      transform.setTPCrow( iRow, 85.+iRow, 60, 0.4 );
+      distortion.setTPCrow( iRow, 85.+iRow, 60, 0.4, rowSplines ?iRow :0 );
+    }
+    transform.setCalibration( 0, 0.f, 2.5f, 0.f, 0.f, 0.f, 0.f, 0.f );
+    if( rowSplines ){
+      for( int iRow=0; iRow<nRows; iRow++ ) distortion.setApproximationScenario( iRow, rowSplines[iRow] );
+    } else {
+      IrregularSpline2D3D spline;
+      const int nKnotsU = 15, nKnotsV = 20;
+      float knotsU[nKnotsU], knotsV[nKnotsV];
+      for( int i=0; i<nKnotsU; i++ ) knotsU[i] = 1./(nKnotsU-1)*i;
+      for( int i=0; i<nKnotsV; i++ ) knotsV[i] = 1./(nKnotsV-1)*i;
+      spline.construct( nKnotsU, knotsU, nAxisBinsU, nKnotsV, knotsV, nAxisBinsV );
+      distortion.setApproximationScenario( 0, spline );
+    }
+    distortion.finishConstruction();
+    transform.finishConstruction();
+  };
+
+  TPCFastTransform fixed;
+  construct( fixed, nullptr );
+
+  // sample every axis bin, so that the target holds on the whole bin grid
+  IrregularSplineKnotOptimizer optimizer;
+  optimizer.setMaxError( maxError );
+  optimizer.setNumberOfSamples( nAxisBinsU+1, nAxisBinsV+1 );
+  optimizer.setMaxNumberOfKnots( 15, 20 );
+
+  TPCDistortionIRSBuilder builder;
+  std::unique_ptr<IrregularSpline2D3D[]> rowSplines( new IrregularSpline2D3D[nRows] );
+  float err = builder.optimizeRowSplines( optimizer, fixed.getDistortionNonConst(), source, rowSplines.get() );
+  BOOST_CHECK( err >= 0.f && err <= maxError );
+
+  TPCFastTransform optimized;
+  construct( optimized, rowSplines.get() );
+  BOOST_CHECK_EQUAL( builder.build( optimized.getDistortionNonConst(), source ), 0 );
+  BOOST_CHECK( optimized.getDistortionNonConst().getFlatBufferSize() < fixed.getDistortionNonConst().getFlatBufferSize() );
+  BOOST_CHECK( rowSplines[0].getNumberOfKnots() < rowSplines[nRows-1].getNumberOfKnots() );
+
+  TPCDistortionIRS &distortion = optimized.getDistortionNonConst();
+  float maxDev = 0.f;
+  for( int slice=0; slice<TPCFastTransform::getNumberOfSlices(); slice++ ){
+    for( int row=0; row<nRows; row++ ){
+      for( int iu=0; iu<=nAxisBinsU; iu++ ){
+        for( int iv=0; iv<=nAxisBinsV; iv++ ){
+          float u=0, v=0;
+          distortion.convSUVtoUV( slice, row, iu/(float) nAxisBinsU, iv/(float) nAxisBinsV, u, v );
+          float dx=0, du=0, dv=0, sx=0, su=0, sv=0;
+          source( slice, row, u, v, dx, du, dv );
+          distortion.getDistortion( slice, row, u, v, sx, su, sv );
+          maxDev = fmax( maxDev, fmax( fabs( sx-dx ), fmax( fabs( su-du ), fabs( sv-dv ) ) ) );
+        }
+      }
+    }
+  }
+  BOOST_CHECK_SMALL( maxDev, 1.01f*maxError );
+}
@@ -43,10 +43,24 @@ const Double_t AliTPCPoissonSolver::fgke0 = 8.854187817e-12;                 ///
 Double_t AliTPCPoissonSolver::fgExactErr = 1e-4;
 Double_t AliTPCPoissonSolver::fgConvergenceError = 1e-3;
 
+/// Grid hierarchy for the batched solver, [level][right-hand side]
+/// The finest level of arrayV, charge and chargeFMG is provided by the caller
+struct AliTPCPoissonSolver::BatchWorkspace {
+  Int_t nRRow; ///< number of nRRow at the finest grid
+  Int_t nZColumn; ///< number of nZColumn at the finest grid
+  Int_t phiSlice; ///< number of phi slices
+  Int_t nLoop; ///< number of grid levels
+  std::vector<std::vector<TMatrixD **> > arrayV; ///< potential <--> error
+  std::vector<std::vector<TMatrixD **> > charge; ///< charge <--> residue
+  std::vector<std::vector<TMatrixD **> > chargeFMG; ///< charge is restricted in full multiGrid
+  std::vector<std::vector<TMatrixD **> > residue; ///< residue calculation
+  std::vector<std::vector<TMatrixD **> > prevArrayV; ///< error calculation
+};
+
 /// constructor
 ///
 AliTPCPoissonSolver::AliTPCPoissonSolver()
-  : TNamed("poisson solver", "solver"), fStrategy(kRelaxation) {
+  : TNamed("poisson solver", "solver"), fStrategy(kRelaxation), fBatchWorkspace(NULL) {
 
   // default strategy
   fStrategy = kMultiGrid;
@@ -62,7 +76,7 @@ AliTPCPoissonSolver::AliTPCPoissonSolver()
 /// \param name name of the object
 /// \param title title of the object
 AliTPCPoissonSolver::AliTPCPoissonSolver(const char *name, const char *title)
-  : TNamed(name, title) {
+  : TNamed(name, title), fBatchWorkspace(NULL) {
   fExactPresent = kFALSE;
   fErrorConvergenceNorm2 = new TVectorD(fMgParameters.nMGCycle);
   fErrorConvergenceNormInf = new TVectorD(fMgParameters.nMGCycle);
@@ -76,6 +90,7 @@ AliTPCPoissonSolver::~AliTPCPoissonSolver() {
   delete fErrorConvergenceNorm2;
   delete fErrorConvergenceNormInf;
   delete fError;
+  ClearBatchWorkspace();
 }
 
 /// Provides poisson solver in 2D
@@ -136,6 +151,221 @@ void AliTPCPoissonSolver::PoissonSolver3D(TMatrixD **matricesV, TMatrixD **matri
 
 }
 
+/// Solves Poisson's equation in Cylindrical 3D for a batch of charge densities on the same grid
+///
+/// All right-hand sides share the grid size, the symmetry and the solver settings. They are solved
+/// with the semi coarsening multi grid (the default strategy) where:
+/// * the coarse grid hierarchy and the scratch matrices are allocated once and kept between calls,
+///   as long as the grid size does not change (see ClearBatchWorkspace())
+/// * each smoothing sweep updates all the right-hand sides at a grid point before moving to the next one,
+///   so the stencil coefficients and the index arithmetic are shared
+/// * each right-hand side leaves the multi grid iteration as soon as it is converged
+///
+/// The numerical result for each right-hand side is the same as from PoissonSolver3D().
+/// For other strategies the right-hand sides are solved one by one with PoissonSolver3D().
+///
+/// \param matricesV std::vector<TMatrixD**> potential in 3D matrix for each right-hand side
+/// \param matricesCharge std::vector<TMatrixD**> charge density in 3D matrix for each right-hand side (side effect)
+/// \param nRRow Int_t number of nRRow in the r direction of TPC
+/// \param nZColumn Int_t number of nZColumn in z direction of TPC
+/// \param phiSlice Int_t number of phiSlice in phi direction of TPC
+/// \param maxIteration Int_t maximum iteration for relaxation method
+/// \param symmetry Int_t symmetry or not
+/// \param convergence std::vector<BatchConvergence> convergence information for each right-hand side (output)
+///
+/// \pre Charge density distributions are known and boundary values for each **matricesV** are set
+/// \post Numerical solution for each potential distribution is calculated and stored in **matricesV**
+void AliTPCPoissonSolver::PoissonSolver3DBatch(std::vector<TMatrixD **> &matricesV,
+                                               std::vector<TMatrixD **> &matricesCharge, Int_t nRRow,
+                                               Int_t nZColumn, Int_t phiSlice, Int_t maxIteration, Int_t symmetry,
+                                               std::vector<BatchConvergence> &convergence) {
+
+  const Int_t nRHS = matricesV.size();
+  convergence.resize(nRHS);
+  for (Int_t b = 0; b < nRHS; b++) {
+    convergence[b].nIterations = 0;
+    convergence[b].convergenceError = -1.0;
+    convergence[b].converged = kFALSE;
+  }
+
+  if ((Int_t) matricesCharge.size() != nRHS) {
+    Error("PoissonSolver3DBatch", "Number of potentials and charge densities differ");
+    return;
+  }
+  if (nRHS == 0) return;
+
+  if (fStrategy != kMultiGrid || fMgParameters.isFull3D ||
+      (fMgParameters.cycleType != kFCycle && fMgParameters.cycleType != kVCycle)) {
+    // no batched version, solve one by one
+    for (Int_t b = 0; b < nRHS; b++) {
+      fIterations = (fStrategy == kMultiGrid) ? fMgParameters.nMGCycle : maxIteration;
+      PoissonSolver3D(matricesV[b], matricesCharge[b], nRRow, nZColumn, phiSlice, maxIteration, symmetry);
+      convergence[b].nIterations = fIterations;
+    }
+    return;
+  }
+
+  // Check that the number of nRRow and nZColumn is suitable for a binary expansion
+  if (!IsPowerOfTwo((nRRow - 1))) {
+    Error("PoissonSolver3DBatch","Poisson3DMultiGrid - Error in the number of nRRow. Must be 2**M + 1");
+    return;
+  }
+  if (!IsPowerOfTwo((nZColumn - 1))) {
+    Error("PoissonSolver3DBatch","Poisson3DMultiGrid - Error in the number of nZColumn. Must be 2**N - 1");
+    return;
+  }
+  if (phiSlice <= 3) {
+    Error("PoissonSolver3DBatch","Poisson3DMultiGrid - Error in the number of phiSlice. Must be larger than 3");
+    return;
+  }
+  if (phiSlice > 1000) {
+    Error("PoissonSolver3DBatch","Poisson3D  phiSlice > 1000 is not allowed (nor wise) ");
+    return;
+  }
+
+  const Float_t gridSizeR =
+    (AliTPCPoissonSolver::fgkOFCRadius - AliTPCPoissonSolver::fgkIFCRadius) / (nRRow - 1); // h_{r}
+  const Float_t gridSizePhi = TMath::TwoPi() / phiSlice;  // h_{phi}
+  const Float_t gridSizeZ = AliTPCPoissonSolver::fgkTPCZ0 / (nZColumn - 1); // h_{z}
+  const Float_t ratioPhi =
+    gridSizeR * gridSizeR / (gridSizePhi * gridSizePhi);  // ratio_{phi} = gridSize_{r} / gridSize_{phi}
+  const Float_t ratioZ = gridSizeR * gridSizeR / (gridSizeZ * gridSizeZ); // ratio_{Z} = gridSize_{r} / gridSize_{z}
+
+  Int_t nGridRow = 0; // number grid
+  Int_t nGridCol = 0; // number grid
+  Int_t nnRow = nRRow;
+  while (nnRow >>= 1) nGridRow++;
+  Int_t nnCol = nZColumn;
+  while (nnCol >>= 1) nGridCol++;
+
+  Int_t nLoop = TMath::Max(nGridRow, nGridCol);      // Calculate the number of nLoop for the binary expansion
+  nLoop = (nLoop > fMgParameters.maxLoop) ? fMgParameters.maxLoop : nLoop;
+
+  // 1) Get the grid hierarchy, the finest level is from parameters
+  AllocateBatchWorkspace(nRRow, nZColumn, phiSlice, nLoop, nRHS);
+  BatchWorkspace &ws = *fBatchWorkspace;
+
+  for (Int_t b = 0; b < nRHS; b++) {
+    ws.arrayV[0][b] = matricesV[b];
+    ws.charge[0][b] = matricesCharge[b];
+    ws.chargeFMG[0][b] = matricesCharge[b];
+  }
+
+  // 2) Restrict charge and boundary to coarser grids
+  Int_t iOne = 1, jOne = 1, tnRRow, tnZColumn;
+  for (Int_t count = 2; count <= nLoop; count++) {
+    iOne = 2 * iOne;
+    jOne = 2 * jOne;
+    tnRRow = nRRow / iOne + 1;
+    tnZColumn = nZColumn / jOne + 1;
+    for (Int_t b = 0; b < nRHS; b++) {
+      for (Int_t k = 0; k < phiSlice; k++) ws.arrayV[count - 1][b][k]->Zero();
+      Restrict3D(ws.chargeFMG[count - 1][b], ws.chargeFMG[count - 2][b], tnRRow, tnZColumn, phiSlice, phiSlice);
+      RestrictBoundary3D(ws.arrayV[count - 1][b], ws.arrayV[count - 2][b], tnRRow, tnZColumn, phiSlice, phiSlice);
+    }
+  }
+
+  Float_t h2, tempRatioZ;
+  std::vector<float> coefficient1(nRRow);
+  std::vector<float> coefficient2(nRRow);
+  std::vector<float> coefficient3(nRRow);
+  std::vector<float> coefficient4(nRRow);
+  std::vector<float> inverseCoefficient4(nRRow);
+
+  std::vector<Int_t> all(nRHS);
+  for (Int_t b = 0; b < nRHS; b++) all[b] = b;
+
+  // 3) Full multi grid: relax on the coarsest grid, then go to finer grids with V cycles
+  // V multi grid: V cycles on the finest grid only
+  Int_t countStart = 0;
+  if (fMgParameters.cycleType == kFCycle) {
+    countStart = nLoop - 2;
+    tnRRow = iOne == 1 ? nRRow : nRRow / iOne + 1;
+    Coefficients3D2D(tnRRow, iOne, jOne, gridSizeR, ratioZ, ratioPhi, h2, tempRatioZ, coefficient1, coefficient2,
+                     coefficient3, coefficient4, inverseCoefficient4);
+    tnZColumn = jOne == 1 ? nZColumn : nZColumn / jOne + 1;
+    Relax3DBatch(ws.arrayV[nLoop - 1], ws.chargeFMG[nLoop - 1], all, tnRRow, tnZColumn, phiSlice, symmetry, h2,
+                 tempRatioZ, coefficient1, coefficient2, coefficient3, coefficient4);
+  }
+
+  std::vector<Int_t> active;
+  fIterations = 0;
+
+  for (Int_t count = countStart; count >= 0; count--) {
+    iOne = 1 << count;
+    jOne = 1 << count;
+    tnRRow = iOne == 1 ? nRRow : nRRow / iOne + 1;
+    tnZColumn = jOne == 1 ? nZColumn : nZColumn / jOne + 1;
+
+    if (fMgParameters.cycleType == kFCycle) {
+      // Interpolate potential coarse -> fine, copy the restricted charge
+      for (Int_t b = 0; b < nRHS; b++) {
+        Interp3D(ws.arrayV[count][b], ws.arrayV[count + 1][b], tnRRow, tnZColumn, phiSlice, phiSlice);
+        if (count > 0) {
+          for (Int_t m = 0; m < phiSlice; m++) *ws.charge[count][b][m] = *ws.chargeFMG[count][b][m];
+        }
+      }
+    }
+
+    // V cycles until every right-hand side is converged
+    active = all;
+    for (Int_t mgCycle = 0; mgCycle < fMgParameters.nMGCycle && !active.empty(); mgCycle++) {
+      for (size_t a = 0; a < active.size(); a++) {
+        for (Int_t m = 0; m < phiSlice; m++) *ws.prevArrayV[count][active[a]][m] = *ws.arrayV[count][active[a]][m];
+      }
+
+      VCycle3D2DBatch(nRRow, nZColumn, phiSlice, symmetry, count + 1, nLoop, fMgParameters.nPre, fMgParameters.nPost,
+                      gridSizeR, ratioZ, ratioPhi, active, coefficient1, coefficient2, coefficient3, coefficient4,
+                      inverseCoefficient4);
+
+      size_t nActive = 0;
+      for (size_t a = 0; a < active.size(); a++) {
+        Int_t b = active[a];
+        Double_t convergenceError = GetConvergenceError(ws.arrayV[count][b], ws.prevArrayV[count][b], phiSlice);
+        Bool_t converged = (convergenceError <= fgConvergenceError);
+        if (count == 0) {
+          convergence[b].nIterations = mgCycle + 1;
+          convergence[b].convergenceError = convergenceError;
+          convergence[b].converged = converged;
+          if (mgCycle + 1 > fIterations) fIterations = mgCycle + 1;
+        }
+        if (!converged) active[nActive++] = b;
+      }
+      active.resize(nActive);
+    }
+  }
+}
+
+///
+/// Deletes the grid hierarchy kept for batched solves
+///
+void AliTPCPoissonSolver::ClearBatchWorkspace() {
+  if (!fBatchWorkspace) return;
+  BatchWorkspace &ws = *fBatchWorkspace;
+  for (Int_t count = 0; count < ws.nLoop; count++) {
+    for (size_t b = 0; b < ws.residue[count].size(); b++) {
+      for (Int_t k = 0; k < ws.phiSlice; k++) {
+        delete ws.residue[count][b][k];
+        delete ws.prevArrayV[count][b][k];
+        if (count > 0) {
+          delete ws.arrayV[count][b][k];
+          delete ws.charge[count][b][k];
+          delete ws.chargeFMG[count][b][k];
+        }
+      }
+      delete[] ws.residue[count][b];
+      delete[] ws.prevArrayV[count][b];
+      if (count > 0) {
+        delete[] ws.arrayV[count][b];
+        delete[] ws.charge[count][b];
+        delete[] ws.chargeFMG[count][b];
+      }
+    }
+  }
+  delete fBatchWorkspace;
+  fBatchWorkspace = NULL;
+}
+
 /// Solve Poisson's Equation by Relaxation Technique in 2D (assuming cylindrical symmetry)
 ///
 /// Solve Poisson's equation in a cylindrical coordinate system. The matrixV matrix must be filled with the
@@ -3008,3 +3238,305 @@ AliTPCPoissonSolver::VCycle3D2DGPU(
     } // end post smoothing
   }
 }
+
+///////////////////// batched solver ///////////////////
+
+/// Allocates the grid hierarchy for batched solves, reuses the existing one when the grid is the same
+///
+/// \param nRRow const Int_t number of nRRow in the r direction of TPC
+/// \param nZColumn const Int_t number of nZColumn in z direction of TPC
+/// \param phiSlice const Int_t number of phiSlice in phi direction of TPC
+/// \param nLoop const Int_t number of multi grid levels
+/// \param nRHS const Int_t number of right-hand sides
+///
+void AliTPCPoissonSolver::AllocateBatchWorkspace(const Int_t nRRow, const Int_t nZColumn, const Int_t phiSlice,
+                                                 const Int_t nLoop, const Int_t nRHS) {
+  if (fBatchWorkspace && (fBatchWorkspace->nRRow != nRRow || fBatchWorkspace->nZColumn != nZColumn ||
+                          fBatchWorkspace->phiSlice != phiSlice || fBatchWorkspace->nLoop != nLoop)) {
+    ClearBatchWorkspace();
+  }
+  if (!fBatchWorkspace) {
+    fBatchWorkspace = new BatchWorkspace;
+    fBatchWorkspace->nRRow = nRRow;
+    fBatchWorkspace->nZColumn = nZColumn;
+    fBatchWorkspace->phiSlice = phiSlice;
+    fBatchWorkspace->nLoop = nLoop;
+    fBatchWorkspace->arrayV.resize(nLoop);
+    fBatchWorkspace->charge.resize(nLoop);
+    fBatchWorkspace->chargeFMG.resize(nLoop);
+    fBatchWorkspace->residue.resize(nLoop);
+    fBatchWorkspace->prevArrayV.resize(nLoop);
+  }
+  BatchWorkspace &ws = *fBatchWorkspace;
+
+  Int_t iOne = 1; // index i in gridSize r (original)
+  Int_t jOne = 1; // index j in gridSize z (original)
+  for (Int_t count = 1; count <= nLoop; count++) {
+    Int_t tnRRow = iOne == 1 ? nRRow : nRRow / iOne + 1;
+    Int_t tnZColumn = jOne == 1 ? nZColumn : nZColumn / jOne + 1;
+    for (Int_t b = ws.residue[count - 1].size(); b < nRHS; b++) {
+      TMatrixD **residue = new TMatrixD *[phiSlice];
+      TMatrixD **prevArrayV = new TMatrixD *[phiSlice];
+      for (Int_t k = 0; k < phiSlice; k++) {
+        residue[k] = new TMatrixD(tnRRow, tnZColumn);
+        prevArrayV[k] = new TMatrixD(tnRRow, tnZColumn);
+      }
+      ws.residue[count - 1].push_back(residue);
+      ws.prevArrayV[count - 1].push_back(prevArrayV);
+
+      // memory for the finest grid is from parameters
+      if (count == 1) {
+        ws.arrayV[count - 1].push_back(NULL);
+        ws.charge[count - 1].push_back(NULL);
+        ws.chargeFMG[count - 1].push_back(NULL);
+      } else {
+        TMatrixD **arrayV = new TMatrixD *[phiSlice];
+        TMatrixD **charge = new TMatrixD *[phiSlice];
+        TMatrixD **chargeFMG = new TMatrixD *[phiSlice];
+        for (Int_t k = 0; k < phiSlice; k++) {
+          arrayV[k] = new TMatrixD(tnRRow, tnZColumn);
+          charge[k] = new TMatrixD(tnRRow, tnZColumn);
+          chargeFMG[k] = new TMatrixD(tnRRow, tnZColumn);
+        }
+        ws.arrayV[count - 1].push_back(arrayV);
+        ws.charge[count - 1].push_back(charge);
+        ws.chargeFMG[count - 1].push_back(chargeFMG);
+      }
+    }
+    iOne = 2 * iOne; // doubling
+    jOne = 2 * jOne; // doubling
+  }
+}
+
+/// Calculates the smoother coefficients for a grid level of the semi coarsening multi grid
+///
+/// \param tnRRow const Int_t number of nRRow at this level
+/// \param iOne const Int_t grid step in r direction relative to the finest grid
+/// \param jOne const Int_t grid step in z direction relative to the finest grid
+/// \param gridSizeR const Float_t grid size in r direction at the finest grid
+/// \param ratioZ const Float_t ratio between square of grid r and grid z at the finest grid
+/// \param ratioPhi const Float_t ratio between square of grid r and grid phi at the finest grid
+/// \param h2 Float_t& \f$  h_{r}^{2} \f$ (output)
+/// \param tempRatioZ Float_t& ratio between square of grid r and grid z at this level (output)
+///
+void AliTPCPoissonSolver::Coefficients3D2D(const Int_t tnRRow, const Int_t iOne, const Int_t jOne,
+                                           const Float_t gridSizeR, const Float_t ratioZ, const Float_t ratioPhi,
+                                           Float_t &h2, Float_t &tempRatioZ, std::vector<float> &coefficient1,
+                                           std::vector<float> &coefficient2, std::vector<float> &coefficient3,
+                                           std::vector<float> &coefficient4,
+                                           std::vector<float> &inverseCoefficient4) {
+  Float_t h = gridSizeR * iOne;
+  h2 = h * h;
+  Float_t tempRatioPhi = ratioPhi * iOne * iOne;
+  tempRatioZ = ratioZ * iOne * iOne / (jOne * jOne);
+
+  for (Int_t i = 1; i < tnRRow - 1; i++) {
+    Float_t radius = AliTPCPoissonSolver::fgkIFCRadius + i * h;
+    coefficient1[i] = 1.0 + h / (2 * radius);
+    coefficient2[i] = 1.0 - h / (2 * radius);
+    coefficient3[i] = tempRatioPhi / (radius * radius);
+    coefficient4[i] = 0.5 / (1.0 + tempRatioZ + coefficient3[i]);
+    inverseCoefficient4[i] = 1.0 / coefficient4[i];
+  }
+}
+
+/// Relax3DBatch
+///
+///    Relaxation operation of Relax3D() for several right-hand sides at once.
+///    At each grid point all the active right-hand sides are updated,
+///    the point ordering is the same as in Relax3D().
+///
+/// \param matricesV std::vector<TMatrixD**> potential in 3D for each right-hand side
+/// \param matricesCharge std::vector<TMatrixD**> charge in 3D for each right-hand side
+/// \param active const std::vector<Int_t>& indices of the right-hand sides to relax
+/// \param tnRRow const Int_t number of nRRow in the r direction of TPC
+/// \param tnZColumn const Int_t number of nZColumn in z direction of TPC
+/// \param phiSlice const Int_t number of phiSlice in phi direction of TPC
+/// \param symmetry const Int_t is the cylinder has symmetry
+/// \param h2 const Float_t \f$  h_{r}^{2} \f$
+/// \param tempRatioZ const Float_t ration between grid size in z-direction and r-direction
+/// \param coefficient1 std::vector<float> coefficient for \f$  V_{x+1,y,z} \f$
+/// \param coefficient2 std::vector<float> coefficient for \f$  V_{x-1,y,z} \f$
+/// \param coefficient3 std::vector<float> coefficient for z
+/// \param coefficient4 std::vector<float> coefficient for f(r,\phi,z)
+///
+void AliTPCPoissonSolver::Relax3DBatch(std::vector<TMatrixD **> &matricesV, std::vector<TMatrixD **> &matricesCharge,
+                                       const std::vector<Int_t> &active, const Int_t tnRRow, const Int_t tnZColumn,
+                                       const Int_t phiSlice, const Int_t symmetry, const Float_t h2,
+                                       const Float_t tempRatioZ, std::vector<float> &coefficient1,
+                                       std::vector<float> &coefficient2, std::vector<float> &coefficient3,
+                                       std::vector<float> &coefficient4) {
+
+  Int_t nPass, iStep;
+  if (fMgParameters.relaxType == kGaussSeidel) {
+    nPass = 2;
+    iStep = 2;
+  } else if (fMgParameters.relaxType == kJacobi) {
+    nPass = 1;
+    iStep = 1;
+  } else {
+    // Case weighted Jacobi
+    // TODO
+    return;
+  }
+
+  const Int_t nActive = active.size();
+  std::vector<Double_t *> arrayV(nActive), arrayVP(nActive), arrayVM(nActive), arrayCharge(nActive);
+  Int_t mPlus, mMinus, signPlus, signMinus;
+  Int_t isw, jsw, msw;
+  msw = 1;
+  for (Int_t iPass = 1; iPass <= nPass; iPass++, msw = 3 - msw) {
+    jsw = msw;
+    for (Int_t m = 0; m < phiSlice; m++, jsw = 3 - jsw) {
+      mPlus = m + 1;
+      signPlus = 1;
+      mMinus = m - 1;
+      signMinus = 1;
+      // Reflection symmetry in phi (e.g. symmetry at sector boundaries, or half sectors, etc.)
+      if (symmetry == 1) {
+        if (mPlus > phiSlice - 1) mPlus = phiSlice - 2;
+        if (mMinus < 0) mMinus = 1;
+      }
+        // Anti-symmetry in phi
+      else if (symmetry == -1) {
+        if (mPlus > phiSlice - 1) {
+          mPlus = phiSlice - 2;
+          signPlus = -1;
+        }
+        if (mMinus < 0) {
+          mMinus = 1;
+          signMinus = -1;
+        }
+      } else { // No Symmetries in phi, no boundaries, the calculation is continuous across all phi
+        if (mPlus > phiSlice - 1) mPlus = m + 1 - phiSlice;
+        if (mMinus < 0) mMinus = m - 1 + phiSlice;
+      }
+
+      for (Int_t a = 0; a < nActive; a++) {
+        arrayV[a] = matricesV[active[a]][m]->GetMatrixArray();
+        arrayVP[a] = matricesV[active[a]][mPlus]->GetMatrixArray(); // slice
+        arrayVM[a] = matricesV[active[a]][mMinus]->GetMatrixArray(); // slice
+        arrayCharge[a] = matricesCharge[active[a]][m]->GetMatrixArray();
+      }
+
+      isw = (iStep == 2) ? jsw : 1;
+      for (Int_t j = 1; j < tnZColumn - 1; j++, isw = (iStep == 2) ? 3 - isw : 1) {
+        for (Int_t i = isw; i < tnRRow - 1; i += iStep) {
+          const Int_t index = i * tnZColumn + j;
+          const float c1 = coefficient1[i];
+          const float c2 = coefficient2[i];
+          const float c3 = coefficient3[i];
+          const float c4 = coefficient4[i];
+          for (Int_t a = 0; a < nActive; a++) {
+            Double_t *v = arrayV[a];
+            v[index] = (c2 * v[index - tnZColumn]
+                        + tempRatioZ * (v[index - 1] + v[index + 1])
+                        + c1 * v[index + tnZColumn]
+                        + c3 * (signPlus * arrayVP[a][index] + signMinus * arrayVM[a][index])
+                        + (h2 * arrayCharge[a][index])
+                       ) * c4;
+          }
+        } // end cols
+      }  // end nRRow
+    } // end phi
+  } // end sweep
+}
+
+/// VCycle 3D2D for several right-hand sides, see VCycle3D2D()
+///
+/// The grid hierarchy is taken from the batch workspace, only the active right-hand sides are processed.
+///
+/// \param nRRow Int_t number of grid in nRRow (in r-direction) at the finest grid
+/// \param nZColumn Int_t number of grid in nZColumn (in z-direction) at the finest grid
+/// \param phiSlice Int_t number of phiSlice in phi direction of TPC
+/// \param symmetry Int_t symmetry or not
+/// \param gridFrom const Int_t finest level of grid
+/// \param gridTo const Int_t coarsest level of grid
+/// \param nPre const Int_t number of smoothing before coarsening
+/// \param nPost const Int_t number of smoothing after coarsening
+/// \param gridSizeR const Float_t grid size in r direction
+/// \param ratioZ const Float_t ratio between square of grid r and grid z
+/// \param ratioPhi const Float_t ratio between square of grid r and grid phi
+/// \param active const std::vector<Int_t>& indices of the right-hand sides to process
+///
+void AliTPCPoissonSolver::VCycle3D2DBatch(const Int_t nRRow, const Int_t nZColumn, const Int_t phiSlice,
+                                          const Int_t symmetry, const Int_t gridFrom, const Int_t gridTo,
+                                          const Int_t nPre, const Int_t nPost, const Float_t gridSizeR,
+                                          const Float_t ratioZ, const Float_t ratioPhi,
+                                          const std::vector<Int_t> &active, std::vector<float> &coefficient1,
+                                          std::vector<float> &coefficient2, std::vector<float> &coefficient3,
+                                          std::vector<float> &coefficient4,
+                                          std::vector<float> &inverseCoefficient4) {
+
+  BatchWorkspace &ws = *fBatchWorkspace;
+  Float_t h2, ih2, tempRatioZ;
+  Int_t iOne, jOne, tnRRow, tnZColumn, count;
+
+  iOne = 1 << (gridFrom - 1);
+  jOne = 1 << (gridFrom - 1);
+
+  tnRRow = iOne == 1 ? nRRow : nRRow / iOne + 1;
+  tnZColumn = jOne == 1 ? nZColumn : nZColumn / jOne + 1;
+
+  for (count = gridFrom; count <= gridTo - 1; count++) {
+    Coefficients3D2D(tnRRow, iOne, jOne, gridSizeR, ratioZ, ratioPhi, h2, tempRatioZ, coefficient1, coefficient2,
+                     coefficient3, coefficient4, inverseCoefficient4);
+    ih2 = 1.0 / h2;
+
+    // 1) Pre-Smoothing: Gauss-Seidel Relaxation or Jacobi
+    for (Int_t jPre = 1; jPre <= nPre; jPre++) {
+      Relax3DBatch(ws.arrayV[count - 1], ws.charge[count - 1], active, tnRRow, tnZColumn, phiSlice, symmetry, h2,
+                   tempRatioZ, coefficient1, coefficient2, coefficient3, coefficient4);
+    } // end pre smoothing
+
+    // 2) Residue calculation
+    for (size_t a = 0; a < active.size(); a++) {
+      Residue3D(ws.residue[count - 1][active[a]], ws.arrayV[count - 1][active[a]], ws.charge[count - 1][active[a]],
+                tnRRow, tnZColumn, phiSlice, symmetry, ih2, tempRatioZ, coefficient1, coefficient2, coefficient3,
+                inverseCoefficient4);
+    }
+
+    iOne = 2 * iOne;
+    jOne = 2 * jOne;
+    tnRRow = iOne == 1 ? nRRow : nRRow / iOne + 1;
+    tnZColumn = jOne == 1 ? nZColumn : nZColumn / jOne + 1;
+
+    for (size_t a = 0; a < active.size(); a++) {
+      //3) Restriction
+      Restrict3D(ws.charge[count][active[a]], ws.residue[count - 1][active[a]], tnRRow, tnZColumn, phiSlice,
+                 phiSlice);
+      //4) Zeroing coarser V
+      for (Int_t m = 0; m < phiSlice; m++) ws.arrayV[count][active[a]][m]->Zero();
+    }
+  }
+
+  // 3) Relax on the coarsest grid
+  Coefficients3D2D(tnRRow, iOne, jOne, gridSizeR, ratioZ, ratioPhi, h2, tempRatioZ, coefficient1, coefficient2,
+                   coefficient3, coefficient4, inverseCoefficient4);
+  Relax3DBatch(ws.arrayV[gridTo - 1], ws.charge[gridTo - 1], active, tnRRow, tnZColumn, phiSlice, symmetry, h2,
+               tempRatioZ, coefficient1, coefficient2, coefficient3, coefficient4);
+
+  // back to fine
+  for (count = gridTo - 1; count >= gridFrom; count--) {
+    iOne = iOne / 2;
+    jOne = jOne / 2;
+
+    tnRRow = iOne == 1 ? nRRow : nRRow / iOne + 1;
+    tnZColumn = jOne == 1 ? nZColumn : nZColumn / jOne + 1;
+
+    // 4) Interpolation/Prolongation
+    for (size_t a = 0; a < active.size(); a++) {
+      AddInterp3D(ws.arrayV[count - 1][active[a]], ws.arrayV[count][active[a]], tnRRow, tnZColumn, phiSlice,
+                  phiSlice);
+    }
+
+    Coefficients3D2D(tnRRow, iOne, jOne, gridSizeR, ratioZ, ratioPhi, h2, tempRatioZ, coefficient1, coefficient2,
+                     coefficient3, coefficient4, inverseCoefficient4);
+
+    // 5) Post-Smoothing: Gauss-Seidel Relaxation
+    for (Int_t jPost = 1; jPost <= nPost; jPost++) {
+      Relax3DBatch(ws.arrayV[count - 1], ws.charge[count - 1], active, tnRRow, tnZColumn, phiSlice, symmetry, h2,
+                   tempRatioZ, coefficient1, coefficient2, coefficient3, coefficient4);
+    } // end post smoothing
+  }
+}
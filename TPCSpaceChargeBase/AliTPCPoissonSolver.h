@@ -16,6 +16,7 @@
 #include <TNamed.h>
 #include "TMatrixD.h"
 #include "TVectorD.h"
+#include <vector>
 
 class AliTPCPoissonSolver : public TNamed {
 public:
@@ -80,6 +81,13 @@ public:
     }
   };
 
+  ///< Convergence information for one right-hand side of a batched solve
+  struct BatchConvergence {
+    Int_t nIterations;  ///< number of multi grid cycles done on the finest grid
+    Double_t convergenceError; ///< convergence error after the last cycle, -1 if not monitored
+    Bool_t converged; ///< TRUE if the convergence error went below fgConvergenceError
+  };
+
   AliTPCPoissonSolver();
   AliTPCPoissonSolver(const char *name, const char *title);
   virtual ~AliTPCPoissonSolver();
@@ -87,6 +95,10 @@ public:
   void PoissonSolver2D(TMatrixD &matrixV, TMatrixD &chargeDensity, Int_t nRRow, Int_t nZColumn, Int_t maxIterations);
   void PoissonSolver3D(TMatrixD **matricesV, TMatrixD **matricesChargeDensities, Int_t nRRow, Int_t nZColumn,
                        Int_t phiSlice, Int_t maxIterations, Int_t symmetry);
+  void PoissonSolver3DBatch(std::vector<TMatrixD **> &matricesV, std::vector<TMatrixD **> &matricesChargeDensities,
+                            Int_t nRRow, Int_t nZColumn, Int_t phiSlice, Int_t maxIterations, Int_t symmetry,
+                            std::vector<BatchConvergence> &convergence);
+  void ClearBatchWorkspace();
 
   void SetStrategy(StrategyType strategy) { fStrategy = strategy; }
   StrategyType GetStrategy() { return fStrategy; }
@@ -118,6 +130,8 @@ private:
   TVectorD *fErrorConvergenceNorm2; ///< for storing convergence error  norm2
   TVectorD *fErrorConvergenceNormInf; ///< for storing convergence error normInf
   TVectorD *fError; ///< for storing error
+  struct BatchWorkspace;
+  BatchWorkspace *fBatchWorkspace; ///<! grid hierarchy kept between batched solves
   Double_t GetMaxExact() { return fMaxExact; };
 
   void PoissonRelaxation2D(TMatrixD &matrixV, TMatrixD &chargeDensity, Int_t nRRow, Int_t nZColumn,
@@ -194,12 +208,30 @@ private:
                      std::vector<float> &vectorCoefficient2,
                      std::vector<float> &vectorCoefficient3, std::vector<float> &vectorCoefficient4,
                      std::vector<float> &vectorInverseCoefficient4);
+  void AllocateBatchWorkspace(const Int_t nRRow, const Int_t nZColumn, const Int_t phiSlice, const Int_t nLoop,
+                              const Int_t nRHS);
+  void Coefficients3D2D(const Int_t tnRRow, const Int_t iOne, const Int_t jOne, const Float_t gridSizeR,
+                        const Float_t ratioZ, const Float_t ratioPhi, Float_t &h2, Float_t &tempRatioZ,
+                        std::vector<float> &coefficient1, std::vector<float> &coefficient2,
+                        std::vector<float> &coefficient3, std::vector<float> &coefficient4,
+                        std::vector<float> &inverseCoefficient4);
+  void Relax3DBatch(std::vector<TMatrixD **> &matricesV, std::vector<TMatrixD **> &matricesCharge,
+                    const std::vector<Int_t> &active, const Int_t tnRRow, const Int_t tnZColumn,
+                    const Int_t phiSlice, const Int_t symmetry, const Float_t h2, const Float_t tempRatioZ,
+                    std::vector<float> &coefficient1, std::vector<float> &coefficient2,
+                    std::vector<float> &coefficient3, std::vector<float> &coefficient4);
+  void VCycle3D2DBatch(const Int_t nRRow, const Int_t nZColumn, const Int_t phiSlice, const Int_t symmetry,
+                       const Int_t gridFrom, const Int_t gridTo, const Int_t nPre, const Int_t nPost,
+                       const Float_t gridSizeR, const Float_t ratioZ, const Float_t ratioPhi,
+                       const std::vector<Int_t> &active, std::vector<float> &coefficient1,
+                       std::vector<float> &coefficient2, std::vector<float> &coefficient3,
+                       std::vector<float> &coefficient4, std::vector<float> &inverseCoefficient4);
   Double_t GetExactError(TMatrixD **currentMatricesV, TMatrixD **tempArrayV, const Int_t phiSlice);
   Double_t GetConvergenceError(TMatrixD **currentMatricesV, TMatrixD **prevArrayV, const Int_t phiSlice);
   Double_t fMaxExact;
   Bool_t fExactPresent;
 /// \cond CLASSIMP
-  ClassDef(AliTPCPoissonSolver,5);
+  ClassDef(AliTPCPoissonSolver,6);
 /// \endcond
 };
 